@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+// Dialogue graph, state, conditions and traversal in plain C++. Depends on Core only, so tools,
+// servers and worker threads can run dialogue logic without UObjects or a world.
+public class DialogueCore : ModuleRules
+{
+	public DialogueCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
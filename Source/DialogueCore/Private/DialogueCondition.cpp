@@ -0,0 +1,328 @@
+#include "DialogueCondition.h"
+
+namespace
+{
+    // Hand-written scanner for the condition grammar:
+    //   Condition  := AndGroup ( "||" AndGroup )*
+    //   AndGroup   := Comparison ( "&&" Comparison )*
+    //   Comparison := Word [ ("==" | "!=" | ">=" | "<=" | ">" | "<") Operand ]
+    //   Operand    := Word | "\"" text "\""
+    class FConditionParser
+    {
+    public:
+        explicit FConditionParser(const FString& InSource)
+            : Source(InSource)
+        {
+        }
+
+        bool Parse(TArray<FDialogueConditionOp>& OutOps, FString& OutError)
+        {
+            int32 GroupStart = 0;
+            while (true)
+            {
+                FDialogueConditionOp Op;
+                if (!ParseComparison(Op, OutError)) return false;
+                OutOps.Add(MoveTemp(Op));
+
+                SkipWhitespace();
+                if (AtEnd()) break;
+
+                if (Match(TEXT("&&"))) continue;
+
+                if (Match(TEXT("||")))
+                {
+                    PatchSkips(OutOps, GroupStart);
+                    FDialogueConditionOp OrOp;
+                    OrOp.Code = EDialogueConditionOpCode::Or;
+                    OutOps.Add(OrOp);
+                    GroupStart = OutOps.Num();
+                    continue;
+                }
+
+                OutError = FString::Printf(TEXT("unexpected '%c' at column %d"), Source[Pos], Pos + 1);
+                return false;
+            }
+
+            PatchSkips(OutOps, GroupStart);
+            return true;
+        }
+
+    private:
+        const FString& Source;
+        int32 Pos = 0;
+
+        bool AtEnd() const { return Pos >= Source.Len(); }
+
+        void SkipWhitespace()
+        {
+            while (!AtEnd() && FChar::IsWhitespace(Source[Pos])) ++Pos;
+        }
+
+        bool Match(const TCHAR* Token)
+        {
+            const int32 Len = FCString::Strlen(Token);
+            if (Pos + Len > Source.Len()) return false;
+            if (FCString::Strncmp(*Source + Pos, Token, Len) != 0) return false;
+            Pos += Len;
+            return true;
+        }
+
+        static bool IsWordChar(TCHAR C)
+        {
+            return !FChar::IsWhitespace(C) && C != TEXT('"') && C != TEXT('=') && C != TEXT('!')
+                && C != TEXT('<') && C != TEXT('>') && C != TEXT('&') && C != TEXT('|');
+        }
+
+        // Reads a bare word or a quoted string. Returns false if there is no operand here.
+        bool ReadOperand(FString& OutText, bool& bOutQuoted, FString& OutError)
+        {
+            SkipWhitespace();
+            bOutQuoted = false;
+            if (AtEnd()) return false;
+
+            if (Source[Pos] == TEXT('"'))
+            {
+                const int32 Start = ++Pos;
+                while (!AtEnd() && Source[Pos] != TEXT('"')) ++Pos;
+                if (AtEnd())
+                {
+                    OutError = FString::Printf(TEXT("unterminated string starting at column %d"), Start);
+                    return false;
+                }
+                OutText = Source.Mid(Start, Pos - Start);
+                ++Pos;
+                bOutQuoted = true;
+                return true;
+            }
+
+            const int32 Start = Pos;
+            while (!AtEnd() && IsWordChar(Source[Pos])) ++Pos;
+            if (Pos == Start) return false;
+            OutText = Source.Mid(Start, Pos - Start);
+            return true;
+        }
+
+        bool ReadComparator(EDialogueConditionCompare& OutCompare)
+        {
+            SkipWhitespace();
+            if (Match(TEXT("=="))) { OutCompare = EDialogueConditionCompare::Equal; return true; }
+            if (Match(TEXT("!="))) { OutCompare = EDialogueConditionCompare::NotEqual; return true; }
+            if (Match(TEXT(">="))) { OutCompare = EDialogueConditionCompare::GreaterEqual; return true; }
+            if (Match(TEXT("<="))) { OutCompare = EDialogueConditionCompare::LessEqual; return true; }
+            if (Match(TEXT(">"))) { OutCompare = EDialogueConditionCompare::Greater; return true; }
+            if (Match(TEXT("<"))) { OutCompare = EDialogueConditionCompare::Less; return true; }
+            return false;
+        }
+
+        static bool IsBoolLiteral(const FString& Text, bool& bOutValue)
+        {
+            if (Text.Equals(TEXT("true"), ESearchCase::IgnoreCase)) { bOutValue = true; return true; }
+            if (Text.Equals(TEXT("false"), ESearchCase::IgnoreCase)) { bOutValue = false; return true; }
+            return false;
+        }
+
+        static bool IsEquality(EDialogueConditionCompare Compare)
+        {
+            return Compare == EDialogueConditionCompare::Equal || Compare == EDialogueConditionCompare::NotEqual;
+        }
+
+        bool ParseComparison(FDialogueConditionOp& Op, FString& OutError)
+        {
+            const int32 Column = Pos + 1;
+
+            FString Left;
+            bool bLeftQuoted = false;
+            if (!ReadOperand(Left, bLeftQuoted, OutError))
+            {
+                if (OutError.IsEmpty()) OutError = FString::Printf(TEXT("missing expression at column %d"), Column);
+                return false;
+            }
+
+            bool bLeftLiteral = false;
+            if (bLeftQuoted || IsBoolLiteral(Left, bLeftLiteral))
+            {
+                // Only a bare true / false is allowed as a literal on the left
+                EDialogueConditionCompare Unused;
+                if (!bLeftQuoted && !ReadComparator(Unused))
+                {
+                    Op.Literal = FDialogueValue::MakeBool(bLeftLiteral);
+                    return true;
+                }
+                OutError = FString::Printf(TEXT("left side must be an attribute, got \"%s\""), *Left);
+                return false;
+            }
+
+            FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+            const FName Name(*Left);
+            const EDialogueValueType Existing = Registry.FindType(Name);
+
+            EDialogueConditionCompare Compare;
+            if (!ReadComparator(Compare))
+            {
+                // Bare attribute: bool check
+                Op.Slot = Registry.FindOrAdd(Name, EDialogueValueType::Bool);
+                if (Op.Slot == INDEX_NONE)
+                {
+                    OutError = Existing == EDialogueValueType::None
+                        ? Registry.DescribeRejection(Name, EDialogueValueType::Bool)
+                        : FString::Printf(TEXT("'%s' is a %s attribute and needs a comparison"), *Left, FDialogueValue::TypeToString(Existing));
+                    return false;
+                }
+                return true;
+            }
+            Op.Compare = Compare;
+
+            FString Right;
+            bool bRightQuoted = false;
+            if (!ReadOperand(Right, bRightQuoted, OutError))
+            {
+                if (OutError.IsEmpty()) OutError = FString::Printf(TEXT("missing right side after '%s'"), *Left);
+                return false;
+            }
+
+            // A new attribute takes its type from the first literal it is compared against
+            EDialogueValueType Type = Existing;
+            if (Type == EDialogueValueType::None)
+            {
+                Type = Left.StartsWith(TEXT("skill."), ESearchCase::IgnoreCase)
+                    ? EDialogueValueType::Int
+                    : FDialogueValue::InferType(Right, bRightQuoted);
+            }
+
+            EDialogueValueType LiteralType = Type;
+            if (Type == EDialogueValueType::Int || Type == EDialogueValueType::Float)
+            {
+                if (bRightQuoted || !FCString::IsNumeric(*Right))
+                {
+                    OutError = FString::Printf(TEXT("'%s' compares against a number, got \"%s\""), *Left, *Right);
+                    return false;
+                }
+                // A decimal literal makes the comparison a float one, so "trust > 2.5" is not "trust > 2"
+                if (Right.Contains(TEXT("."))) LiteralType = EDialogueValueType::Float;
+            }
+            else if (!IsEquality(Compare))
+            {
+                OutError = FString::Printf(TEXT("'%s' only supports == and !="), *Left);
+                return false;
+            }
+
+            if ((Type == EDialogueValueType::Bool && bRightQuoted) || !FDialogueValue::Parse(Right, LiteralType, Op.Literal))
+            {
+                OutError = FString::Printf(TEXT("'%s' compares against a %s, got \"%s\""), *Left, FDialogueValue::TypeToString(Type), *Right);
+                return false;
+            }
+
+            Op.Slot = Registry.FindOrAdd(Name, Type);
+            if (Op.Slot == INDEX_NONE)
+            {
+                OutError = Registry.DescribeRejection(Name, Type);
+                return false;
+            }
+            return true;
+        }
+
+        // Point every comparison of the AND group starting at GroupStart past the group
+        static void PatchSkips(TArray<FDialogueConditionOp>& Ops, int32 GroupStart)
+        {
+            const int32 GroupEnd = Ops.Num();
+            for (int32 Index = GroupStart; Index < GroupEnd; ++Index)
+            {
+                Ops[Index].SkipTo = GroupEnd;
+            }
+        }
+    };
+}
+
+bool FDialogueCondition::Compile(const FString& Source, FString& OutError)
+{
+    Ops.Reset();
+    bCompiled = true;
+    bValid = false;
+    OutError.Reset();
+
+    FConditionParser Parser(Source);
+    if (!Parser.Parse(Ops, OutError))
+    {
+        Ops.Empty();
+        return false;
+    }
+
+    Ops.Shrink();
+    bValid = true;
+    return true;
+}
+
+template <typename T>
+static bool CompareNumbers(T Left, EDialogueConditionCompare Compare, T Right)
+{
+    switch (Compare)
+    {
+    case EDialogueConditionCompare::Equal:        return Left == Right;
+    case EDialogueConditionCompare::NotEqual:     return Left != Right;
+    case EDialogueConditionCompare::GreaterEqual: return Left >= Right;
+    case EDialogueConditionCompare::LessEqual:    return Left <= Right;
+    case EDialogueConditionCompare::Greater:      return Left > Right;
+    case EDialogueConditionCompare::Less:         return Left < Right;
+    default:                                      return false;
+    }
+}
+
+static bool EvaluateOp(const FDialogueConditionOp& Op, const FDialogueState& State)
+{
+    if (Op.Compare == EDialogueConditionCompare::IsTrue)
+    {
+        return Op.Slot == INDEX_NONE ? Op.Literal.Int != 0 : State.GetBool(Op.Slot);
+    }
+
+    bool bEqual = false;
+    switch (Op.Literal.Type)
+    {
+    case EDialogueValueType::Int:
+        return CompareNumbers(State.GetInt(Op.Slot), Op.Compare, Op.Literal.Int);
+    case EDialogueValueType::Float:
+        return CompareNumbers(State.GetFloat(Op.Slot), Op.Compare, Op.Literal.Float);
+    case EDialogueValueType::Bool:
+        bEqual = State.GetBool(Op.Slot) == (Op.Literal.Int != 0);
+        break;
+    case EDialogueValueType::Name:
+        bEqual = State.GetName(Op.Slot) == Op.Literal.Name;
+        break;
+    default:
+        return false;
+    }
+    return Op.Compare == EDialogueConditionCompare::NotEqual ? !bEqual : bEqual;
+}
+
+bool FDialogueCondition::Evaluate(const FDialogueState& State) const
+{
+    return bValid && EvaluateOps(Ops, State);
+}
+
+bool FDialogueCondition::EvaluateOps(TConstArrayView<FDialogueConditionOp> Program, const FDialogueState& State)
+{
+    bool bGroupTrue = true;
+    int32 Index = 0;
+    while (Index < Program.Num())
+    {
+        const FDialogueConditionOp& Op = Program[Index];
+        if (Op.Code == EDialogueConditionOpCode::Or)
+        {
+            // One OR branch succeeded
+            if (bGroupTrue) return true;
+            bGroupTrue = true;
+            ++Index;
+        }
+        else if (EvaluateOp(Op, State))
+        {
+            ++Index;
+        }
+        else
+        {
+            // Skip the rest of this AND group
+            bGroupTrue = false;
+            Index = Op.SkipTo;
+        }
+    }
+
+    return bGroupTrue;
+}
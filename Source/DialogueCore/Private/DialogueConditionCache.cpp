@@ -0,0 +1,53 @@
+#include "DialogueConditionCache.h"
+#include "DialogueGraph.h"
+
+bool FDialogueConditionCache::Evaluate(const FDialogueGraph& InGraph, int32 ConditionIndex, const FDialogueState& State)
+{
+    if (GraphId != InGraph.GetId() || StateId != State.GetId())
+    {
+        GraphId = InGraph.GetId();
+        StateId = State.GetId();
+        Entries.Reset();
+        Entries.SetNum(InGraph.Conditions.Num());
+    }
+
+    FEntry& Entry = Entries[ConditionIndex];
+    if (Entry.Version != 0)
+    {
+        // Nothing changed at all since the result was computed
+        bool bFresh = Entry.Version == State.GetVersion();
+        if (!bFresh)
+        {
+            bFresh = true;
+            const FDialogueRange& Reads = InGraph.Conditions[ConditionIndex].Reads;
+            for (int32 Index = Reads.First; Index < Reads.End(); ++Index)
+            {
+                if (State.GetSlotVersion(InGraph.ConditionReads[Index]) > Entry.Version)
+                {
+                    bFresh = false;
+                    break;
+                }
+            }
+        }
+
+        if (bFresh)
+        {
+            // Skip the read check next time if the state stays put
+            Entry.Version = State.GetVersion();
+            ++NumHits;
+            return Entry.bResult;
+        }
+    }
+
+    Entry.bResult = InGraph.EvaluateCondition(ConditionIndex, State);
+    Entry.Version = State.GetVersion();
+    ++NumMisses;
+    return Entry.bResult;
+}
+
+void FDialogueConditionCache::Reset()
+{
+    GraphId = 0;
+    StateId = 0;
+    Entries.Reset();
+}
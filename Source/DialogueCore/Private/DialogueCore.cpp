@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreGlobals.h"
+#include "Modules/ModuleManager.h"
+#include "DialogueState.h"
+
+class FDialogueCoreModule : public FDefaultModuleImpl
+{
+public:
+    virtual void StartupModule() override
+    {
+        // Before any dialogue data is compiled, so declared types don't depend on load order
+        FDialogueAttributeRegistry::Get().LoadDeclarations(GGameIni);
+    }
+};
+
+IMPLEMENT_MODULE( FDialogueCoreModule, DialogueCore );
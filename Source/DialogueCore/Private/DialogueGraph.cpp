@@ -0,0 +1,659 @@
+#include "DialogueGraph.h"
+#include "DialogueConditionCache.h"
+#include "DialogueStats.h"
+#include "Misc/Paths.h"
+#include <atomic>
+#include "Misc/StringBuilder.h"
+
+namespace
+{
+    // The pool must not merge strings that differ only in case, unlike a default FString map
+    struct FCaseSensitiveStringKeyFuncs : BaseKeyFuncs<TPair<FString, int32>, FString, false>
+    {
+        static const FString& GetSetKey(const TPair<FString, int32>& Element) { return Element.Key; }
+        static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+        static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+    };
+
+    // A line text with braces in it and the first node that uses it, for compiling once every node is known
+    struct FTemplateSource
+    {
+        FString Text;
+        FString NodeID;
+    };
+
+    void AppendValue(const FDialogueValue* Value, int32 Slot, FStringBuilderBase& Out)
+    {
+        // An unset slot shows as its type's default
+        const FDialogueValue Unset;
+        if (!Value) Value = &Unset;
+        const EDialogueValueType Type = Value->Type != EDialogueValueType::None ? Value->Type : FDialogueAttributeRegistry::Get().GetType(Slot);
+
+        switch (Type)
+        {
+        case EDialogueValueType::Int:   Out << Value->Int; break;
+        case EDialogueValueType::Float: Out.Appendf(TEXT("%g"), Value->Float); break;
+        case EDialogueValueType::Bool:  Out << (Value->Int != 0 ? TEXT("true") : TEXT("false")); break;
+        case EDialogueValueType::Name:  if (!Value->Name.IsNone()) Value->Name.AppendString(Out); break;
+        default:                        break;
+        }
+    }
+}
+
+int32 FDialogueGraph::Build(const FDialogueGraphBuilder& Source)
+{
+    const TConstArrayView<FDialogueGraphBuilder::FNode> AuthoredNodes = Source.GetNodes();
+    INC_DWORD_STAT_BY(STAT_DialogueNodesLoaded, AuthoredNodes.Num());
+    CSV_CUSTOM_STAT(Dialogue, NodesLoaded, AuthoredNodes.Num(), ECsvCustomStatOp::Accumulate);
+
+    static std::atomic<uint32> NextId { 1 };
+    Id = NextId.fetch_add(1, std::memory_order_relaxed);
+
+    Nodes.Reset(AuthoredNodes.Num());
+    Choices.Reset();
+    Lines.Reset();
+    Conditions.Reset();
+    ConditionOps.Reset();
+    ConditionReads.Reset();
+    Effects.Reset();
+    NodeMedia.Reset();
+    TextSegments.Reset();
+    ExternalLinks.Reset();
+    StringData.Reset();
+    StringOffsets.Reset();
+    StringTemplates.Reset();
+    NodeIndexById.Reset();
+
+    int32 NumErrors = 0;
+
+    TMap<FString, int32, FDefaultSetAllocator, FCaseSensitiveStringKeyFuncs> StringIndices;
+    auto AddString = [this, &StringIndices](const FString& Text) -> int32
+    {
+        if (const int32* Found = StringIndices.Find(Text)) return *Found;
+
+        const int32 Index = StringOffsets.Add(StringData.Num());
+        StringData.Append(*Text, Text.Len());
+        StringData.Add(TEXT('\0'));
+        StringIndices.Add(Text, Index);
+        return Index;
+    };
+
+    // String 0 is the empty string, so default-initialized fields are valid
+    AddString(FString());
+
+    // Text shown to the player; anything with braces may be a template
+    TMap<int32, FTemplateSource> TemplateSources;
+    auto AddText = [&AddString, &TemplateSources](const FString& Text, const FString& NodeID) -> int32
+    {
+        const int32 Index = AddString(Text);
+        if (Text.Contains(TEXT("{")) || Text.Contains(TEXT("}")))
+        {
+            TemplateSources.FindOrAdd(Index, { Text, NodeID });
+        }
+        return Index;
+    };
+
+    FDialogueCondition Scratch;
+    FString Error;
+    auto AddCondition = [this, &Scratch, &Error, &NumErrors](const FString& Source, const FString& NodeID) -> int32
+    {
+        FDialogueGraphCondition& Condition = Conditions.AddDefaulted_GetRef();
+        if (!Scratch.Compile(Source, Error))
+        {
+            UE_LOG(LogDialogue, Error, TEXT("%s, node '%s': bad condition \"%s\": %s"), *SourcePath, *NodeID, *Source, *Error);
+            ++NumErrors;
+            return Conditions.Num() - 1;
+        }
+        Condition.First = ConditionOps.Num();
+        Condition.Num = Scratch.Ops.Num();
+        ConditionOps.Append(Scratch.Ops);
+
+        Condition.Reads.First = ConditionReads.Num();
+        for (const FDialogueConditionOp& Op : Scratch.Ops)
+        {
+            if (Op.Slot == INDEX_NONE) continue;
+            if (!MakeArrayView(ConditionReads).Slice(Condition.Reads.First, ConditionReads.Num() - Condition.Reads.First).Contains(Op.Slot))
+            {
+                ConditionReads.Add(Op.Slot);
+            }
+        }
+        Condition.Reads.Num = ConditionReads.Num() - Condition.Reads.First;
+        return Conditions.Num() - 1;
+    };
+
+    // Alt lines, append lines and alt texts. Lines without a condition can never show and
+    // a malformed condition never passes, so both are dropped.
+    auto AddLines = [this, &AddText, &AddCondition](const auto& Authored, const FString& NodeID)
+    {
+        FDialogueRange Range{ Lines.Num(), 0 };
+        for (const auto& Alt : Authored)
+        {
+            if (Alt.Condition.IsEmpty()) continue;
+            const int32 Condition = AddCondition(Alt.Condition, NodeID);
+            if (Conditions[Condition].First == INDEX_NONE)
+            {
+                Conditions.Pop(false);
+                continue;
+            }
+            Lines.Add({ Condition, AddText(Alt.Text, NodeID) });
+        }
+        Range.Num = Lines.Num() - Range.First;
+        return Range;
+    };
+
+    // Ids are resolved in a second pass, once every node has its index
+    for (int32 Index = 0; Index < AuthoredNodes.Num(); ++Index)
+    {
+        NodeIndexById.Add(AuthoredNodes[Index].ID, Index);
+    }
+
+    auto ResolveLink = [this, &AddString, &NumErrors](const FString& TargetID, const FString& NodeID) -> int32
+    {
+        if (TargetID.IsEmpty()) return INDEX_NONE;
+        const int32 Target = FindNodeIndex(TargetID);
+        if (Target != INDEX_NONE) return Target;
+
+        // "file:node" leads into another file; the file's extension may be left out
+        int32 Colon;
+        if (TargetID.FindLastChar(TEXT(':'), Colon) && Colon > 0 && Colon < TargetID.Len() - 1)
+        {
+            FString File = TargetID.Left(Colon);
+            if (FPaths::GetExtension(File).IsEmpty())
+            {
+                File += TEXT(".json");
+            }
+            const FString TargetNodeID = TargetID.Mid(Colon + 1);
+            if (File != SourcePath)
+            {
+                ExternalLinks.Add({ AddString(File), AddString(TargetNodeID) });
+                return INDEX_NONE - ExternalLinks.Num();
+            }
+            if (const int32 Local = FindNodeIndex(TargetNodeID); Local != INDEX_NONE)
+            {
+                return Local;
+            }
+        }
+
+        UE_LOG(LogDialogue, Warning, TEXT("%s, node '%s': link to missing node '%s' will end the dialogue"), *SourcePath, *NodeID, *TargetID);
+        ++NumErrors;
+        return INDEX_NONE;
+    };
+
+    for (const FDialogueGraphBuilder::FNode& Authored : AuthoredNodes)
+    {
+        FDialogueGraphNode Node;
+        Node.Id = AddString(Authored.ID);
+        Node.Speaker = AddString(Authored.Speaker);
+        Node.BaseLine = AddText(Authored.BaseLine, Authored.ID);
+        Node.AltLines = AddLines(Authored.AltLines, Authored.ID);
+        Node.AppendLines = AddLines(Authored.AppendLines, Authored.ID);
+        Node.Next = ResolveLink(Authored.NextNodeID, Authored.ID);
+        if (!Authored.VoiceOver.IsEmpty() || !Authored.Portrait.IsEmpty() || !Authored.Montage.IsEmpty())
+        {
+            Node.Media = NodeMedia.Add({ AddString(Authored.VoiceOver), AddString(Authored.Portrait), AddString(Authored.Montage) });
+        }
+
+        Node.Choices.First = Choices.Num();
+        for (const FDialogueGraphBuilder::FChoice& AuthoredChoice : Authored.Choices)
+        {
+            FDialogueGraphChoice Choice;
+            Choice.Text = AddText(AuthoredChoice.Text, Authored.ID);
+
+            Choice.AltTexts = AddLines(AuthoredChoice.AltTexts, Authored.ID);
+
+            // Empty requirements always pass; malformed ones are kept so the choice stays locked
+            Choice.Requirements.First = Conditions.Num();
+            for (const FString& Requirement : AuthoredChoice.Requirements)
+            {
+                if (!Requirement.IsEmpty()) AddCondition(Requirement, Authored.ID);
+            }
+            Choice.Requirements.Num = Conditions.Num() - Choice.Requirements.First;
+
+            Choice.Effects.First = Effects.Num();
+            for (const FDialogueGraphBuilder::FEffect& AuthoredEffect : AuthoredChoice.Effects)
+            {
+                FDialogueCompiledEffect Effect;
+                if (Effect.Compile(AuthoredEffect.Attribute, AuthoredEffect.Op, AuthoredEffect.Value, Error))
+                {
+                    Effects.Add(Effect);
+                }
+                else
+                {
+                    UE_LOG(LogDialogue, Error, TEXT("%s, node '%s': bad effect on '%s': %s"), *SourcePath, *Authored.ID, *AuthoredEffect.Attribute, *Error);
+                    ++NumErrors;
+                }
+            }
+            Choice.Effects.Num = Effects.Num() - Choice.Effects.First;
+
+            Choice.Next = ResolveLink(AuthoredChoice.NextNodeID, Authored.ID);
+            Choice.Failure = ResolveLink(AuthoredChoice.FailureNodeID, Authored.ID);
+            Choices.Add(Choice);
+        }
+        Node.Choices.Num = Choices.Num() - Node.Choices.First;
+
+        Nodes.Add(Node);
+    }
+
+    // Split templates into literal and field segments. Done last, so attributes first written by a
+    // later node's effects are registered by now.
+    auto CompileTemplate = [this, &AddString, &AddCondition, &NumErrors](const FString& Text, const FString& NodeID)
+    {
+        FDialogueRange Range{ TextSegments.Num(), 0 };
+        FString Literal;
+        auto FlushLiteral = [this, &AddString, &Literal]()
+        {
+            if (Literal.IsEmpty()) return;
+            TextSegments.AddDefaulted_GetRef().Text = AddString(Literal);
+            Literal.Reset();
+        };
+
+        for (int32 Pos = 0; Pos < Text.Len();)
+        {
+            const TCHAR Char = Text[Pos];
+            if ((Char == TEXT('{') || Char == TEXT('}')) && Pos + 1 < Text.Len() && Text[Pos + 1] == Char)
+            {
+                Literal.AppendChar(Char);
+                Pos += 2;
+                continue;
+            }
+
+            const int32 Close = Char == TEXT('{') ? Text.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Pos + 1) : INDEX_NONE;
+            if (Close == INDEX_NONE)
+            {
+                if (Char == TEXT('{'))
+                {
+                    UE_LOG(LogDialogue, Warning, TEXT("%s, node '%s': unclosed '{' in \"%s\" is shown as is"), *SourcePath, *NodeID, *Text);
+                    ++NumErrors;
+                }
+                Literal.AppendChar(Char);
+                ++Pos;
+                continue;
+            }
+
+            const FString Field = Text.Mid(Pos + 1, Close - Pos - 1);
+            Pos = Close + 1;
+            FlushLiteral();
+
+            FDialogueTextSegment Segment;
+            int32 Question;
+            if (Field.TrimStartAndEnd().Equals(TEXT("speaker"), ESearchCase::IgnoreCase))
+            {
+                Segment.Kind = EDialogueTextSegment::Speaker;
+            }
+            else if (Field.FindChar(TEXT('?'), Question))
+            {
+                // A malformed condition never passes, so the second text shows
+                FString Shown = Field.Mid(Question + 1);
+                FString Otherwise;
+                Field.Mid(Question + 1).Split(TEXT(":"), &Shown, &Otherwise);
+                Segment.Kind = EDialogueTextSegment::Select;
+                Segment.Index = AddCondition(Field.Left(Question).TrimStartAndEnd(), NodeID);
+                Segment.Text = AddString(Shown);
+                Segment.AltText = AddString(Otherwise);
+            }
+            else
+            {
+                const FString Name = Field.TrimStartAndEnd();
+                FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+                const FName AttributeName(*Name);
+                const EDialogueValueType Type = Registry.FindType(AttributeName);
+                Segment.Kind = EDialogueTextSegment::Value;
+                if (Type != EDialogueValueType::None)
+                {
+                    Segment.Index = Registry.FindOrAdd(AttributeName, Type);
+                }
+                else if (Registry.HasDeclarations())
+                {
+                    UE_LOG(LogDialogue, Error, TEXT("%s, node '%s': \"{%s}\": %s"), *SourcePath, *NodeID, *Name, *Registry.DescribeRejection(AttributeName, Type));
+                    ++NumErrors;
+                    continue;
+                }
+                else
+                {
+                    // Nothing has given the attribute a type yet; a file loaded later may, so look it up when shown
+                    Segment.Index = INDEX_NONE;
+                    Segment.Text = AddString(Name);
+                }
+            }
+            TextSegments.Add(Segment);
+        }
+        FlushLiteral();
+
+        Range.Num = TextSegments.Num() - Range.First;
+        return Range;
+    };
+
+    TArray<TPair<int32, FDialogueRange>> Templates;
+    for (const TPair<int32, FTemplateSource>& Pair : TemplateSources)
+    {
+        Templates.Emplace(Pair.Key, CompileTemplate(Pair.Value.Text, Pair.Value.NodeID));
+    }
+
+    // Literal segments add strings, so the table is sized once they are all in
+    StringTemplates.SetNum(StringOffsets.Num());
+    for (const TPair<int32, FDialogueRange>& Template : Templates)
+    {
+        StringTemplates[Template.Key] = Template.Value;
+    }
+
+    StringOffsets.Add(StringData.Num());
+
+    Choices.Shrink();
+    Lines.Shrink();
+    Conditions.Shrink();
+    ConditionOps.Shrink();
+    ConditionReads.Shrink();
+    Effects.Shrink();
+    NodeMedia.Shrink();
+    TextSegments.Shrink();
+    ExternalLinks.Shrink();
+    StringData.Shrink();
+    StringOffsets.Shrink();
+
+    if (NumErrors > 0)
+    {
+        UE_LOG(LogDialogue, Error, TEXT("%d dialogue conditions, effects, links or text fields in %s are broken and will be ignored"), NumErrors, *SourcePath);
+    }
+    return NumErrors;
+}
+
+int32 FDialogueGraph::FindNodeIndex(const FString& NodeID) const
+{
+    const int32* Found = NodeIndexById.Find(NodeID);
+    return Found ? *Found : INDEX_NONE;
+}
+
+FString FDialogueGraph::GetLinkId(int32 Link) const
+{
+    if (IsExternalLink(Link))
+    {
+        const FDialogueExternalLink& External = GetExternalLink(Link);
+        const FStringView File = GetString(External.File);
+        const FStringView Node = GetString(External.Node);
+        FString Id;
+        Id.Reserve(File.Len() + Node.Len() + 1);
+        Id.Append(File.GetData(), File.Len());
+        Id.AppendChar(TEXT(':'));
+        Id.Append(Node.GetData(), Node.Len());
+        return Id;
+    }
+    return Link == INDEX_NONE ? FString() : FString(GetNodeId(Link));
+}
+
+bool FDialogueGraph::EvaluateCondition(int32 ConditionIndex, const FDialogueState& State, FDialogueConditionCache* Cache) const
+{
+    if (Cache)
+    {
+        return Cache->Evaluate(*this, ConditionIndex, State);
+    }
+
+    // Too fine-grained for a trace scope of its own; the cycle stat is enough
+    SCOPE_CYCLE_COUNTER(STAT_DialogueConditions);
+    INC_DWORD_STAT(STAT_DialogueConditionsEvaluated);
+
+    const FDialogueGraphCondition& Condition = Conditions[ConditionIndex];
+    if (Condition.First == INDEX_NONE) return false;
+    return FDialogueCondition::EvaluateOps(TConstArrayView<FDialogueConditionOp>(ConditionOps.GetData() + Condition.First, Condition.Num), State);
+}
+
+bool FDialogueGraph::IsChoiceUnlocked(const FDialogueGraphChoice& Choice, const FDialogueState& State, FDialogueConditionCache* Cache) const
+{
+    for (int32 Index = Choice.Requirements.First; Index < Choice.Requirements.End(); ++Index)
+    {
+        if (!EvaluateCondition(Index, State, Cache)) return false;
+    }
+    return true;
+}
+
+FString FDialogueGraph::ResolveLine(const FDialogueGraphNode& Node, const FDialogueState& State, FDialogueConditionCache* Cache) const
+{
+    TStringBuilder<512> Builder;
+    AppendLine(Node, State, Builder, Cache);
+    return FString(Builder.Len(), Builder.GetData());
+}
+
+void FDialogueGraph::AppendLine(const FDialogueGraphNode& Node, const FDialogueState& State, FStringBuilderBase& Out, FDialogueConditionCache* Cache) const
+{
+    DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueResolveLine);
+
+    // First passing alt line replaces the base line
+    int32 Base = Node.BaseLine;
+    for (int32 Index = Node.AltLines.First; Index < Node.AltLines.End(); ++Index)
+    {
+        if (EvaluateCondition(Lines[Index].Condition, State, Cache))
+        {
+            Base = Lines[Index].Text;
+            break;
+        }
+    }
+
+    AppendText(Base, Node.Speaker, State, Out, Cache);
+    for (int32 Index = Node.AppendLines.First; Index < Node.AppendLines.End(); ++Index)
+    {
+        if (EvaluateCondition(Lines[Index].Condition, State, Cache))
+        {
+            Out.AppendChar(TEXT(' '));
+            AppendText(Lines[Index].Text, Node.Speaker, State, Out, Cache);
+        }
+    }
+}
+
+void FDialogueGraph::AppendText(int32 StringIndex, int32 Speaker, const FDialogueState& State, FStringBuilderBase& Out, FDialogueConditionCache* Cache) const
+{
+    const FDialogueRange& Template = StringTemplates[StringIndex];
+    if (Template.Num == 0)
+    {
+        Out << GetString(StringIndex);
+        return;
+    }
+
+    for (int32 Index = Template.First; Index < Template.End(); ++Index)
+    {
+        const FDialogueTextSegment& Segment = TextSegments[Index];
+        switch (Segment.Kind)
+        {
+        case EDialogueTextSegment::Literal:
+            Out << GetString(Segment.Text);
+            break;
+        case EDialogueTextSegment::Value:
+        {
+            int32 Slot = Segment.Index;
+            if (Slot == INDEX_NONE)
+            {
+                const FStringView Name = GetString(Segment.Text);
+                Slot = FDialogueAttributeRegistry::Get().Find(FName(Name.Len(), Name.GetData(), FNAME_Find));
+            }
+            AppendValue(State.GetValue(Slot), Slot, Out);
+            break;
+        }
+        case EDialogueTextSegment::Select:
+            Out << GetString(EvaluateCondition(Segment.Index, State, Cache) ? Segment.Text : Segment.AltText);
+            break;
+        case EDialogueTextSegment::Speaker:
+            Out << GetString(Speaker);
+            break;
+        }
+    }
+}
+
+int32 FDialogueGraph::ResolveChoiceText(const FDialogueGraphChoice& Choice, const FDialogueState& State, FDialogueConditionCache* Cache) const
+{
+    for (int32 Index = Choice.AltTexts.First; Index < Choice.AltTexts.End(); ++Index)
+    {
+        if (EvaluateCondition(Lines[Index].Condition, State, Cache))
+        {
+            return Lines[Index].Text;
+        }
+    }
+    return Choice.Text;
+}
+
+void FDialogueGraph::ResolveChoices(const FDialogueGraphNode& Node, const FDialogueState& State, bool bIncludeLocked,
+    TArray<FDialogueResolvedChoice>& Out, FDialogueConditionCache* Cache) const
+{
+    DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueResolveChoices);
+
+    Out.Reset(Node.Choices.Num);
+    for (int32 Index = 0; Index < Node.Choices.Num; ++Index)
+    {
+        const FDialogueGraphChoice& Choice = Choices[Node.Choices.First + Index];
+        const bool bLocked = !IsChoiceUnlocked(Choice, State, Cache);
+        if (bLocked && !bIncludeLocked) continue;
+
+        FDialogueResolvedChoice& Resolved = Out.AddDefaulted_GetRef();
+        Resolved.ChoiceIndex = Index;
+        Resolved.Text = ResolveChoiceText(Choice, State, Cache);
+        Resolved.bLocked = bLocked;
+    }
+}
+
+void FDialogueGraph::ApplyEffects(const FDialogueGraphChoice& Choice, FDialogueState& State) const
+{
+    for (int32 Index = Choice.Effects.First; Index < Choice.Effects.End(); ++Index)
+    {
+        State.ApplyEffect(Effects[Index]);
+    }
+}
+
+uint32 FDialogueGraph::HashNode(int32 NodeIndex) const
+{
+    // Pooled strings are null-terminated; case matters for text
+    auto HashString = [this](int32 StringIndex) { return FCrc::StrCrc32(GetString(StringIndex).GetData()); };
+    auto HashLink = [&](int32 Target)
+    {
+        if (IsExternalLink(Target))
+        {
+            const FDialogueExternalLink& External = GetExternalLink(Target);
+            return HashCombine(HashString(External.File), HashString(External.Node));
+        }
+        return Target == INDEX_NONE ? 0u : HashString(Nodes[Target].Id);
+    };
+    auto HashValue = [](const FDialogueValue& Value)
+    {
+        uint32 Hash = HashCombine(GetTypeHash(static_cast<uint8>(Value.Type)), GetTypeHash(Value.Int));
+        Hash = HashCombine(Hash, GetTypeHash(Value.Float));
+        return HashCombine(Hash, GetTypeHash(Value.Name));
+    };
+    auto HashCondition = [&](int32 ConditionIndex)
+    {
+        const FDialogueGraphCondition& Condition = Conditions[ConditionIndex];
+        uint32 Hash = GetTypeHash(Condition.First == INDEX_NONE);
+        for (int32 Index = FMath::Max(Condition.First, 0); Index < Condition.First + Condition.Num; ++Index)
+        {
+            const FDialogueConditionOp& Op = ConditionOps[Index];
+            Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Op.Code)));
+            Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Op.Compare)));
+            Hash = HashCombine(Hash, GetTypeHash(Op.SkipTo));
+            Hash = HashCombine(Hash, GetTypeHash(Op.Slot));
+            Hash = HashCombine(Hash, HashValue(Op.Literal));
+        }
+        return Hash;
+    };
+    auto HashLines = [&](const FDialogueRange& Range)
+    {
+        uint32 Hash = GetTypeHash(Range.Num);
+        for (int32 Index = Range.First; Index < Range.End(); ++Index)
+        {
+            Hash = HashCombine(Hash, HashCombine(HashCondition(Lines[Index].Condition), HashString(Lines[Index].Text)));
+        }
+        return Hash;
+    };
+
+    const FDialogueGraphNode& Node = Nodes[NodeIndex];
+    uint32 Hash = HashCombine(HashString(Node.Speaker), HashString(Node.BaseLine));
+    Hash = HashCombine(Hash, HashLines(Node.AltLines));
+    Hash = HashCombine(Hash, HashLines(Node.AppendLines));
+    Hash = HashCombine(Hash, HashLink(Node.Next));
+
+    if (const FDialogueGraphMedia* Media = GetNodeMedia(NodeIndex))
+    {
+        Hash = HashCombine(Hash, HashString(Media->VoiceOver));
+        Hash = HashCombine(Hash, HashString(Media->Portrait));
+        Hash = HashCombine(Hash, HashString(Media->Montage));
+    }
+
+    Hash = HashCombine(Hash, GetTypeHash(Node.Choices.Num));
+    for (int32 ChoiceIndex = Node.Choices.First; ChoiceIndex < Node.Choices.End(); ++ChoiceIndex)
+    {
+        const FDialogueGraphChoice& Choice = Choices[ChoiceIndex];
+        Hash = HashCombine(Hash, HashString(Choice.Text));
+        Hash = HashCombine(Hash, HashLines(Choice.AltTexts));
+        Hash = HashCombine(Hash, GetTypeHash(Choice.Requirements.Num));
+        for (int32 Index = Choice.Requirements.First; Index < Choice.Requirements.End(); ++Index)
+        {
+            Hash = HashCombine(Hash, HashCondition(Index));
+        }
+        Hash = HashCombine(Hash, GetTypeHash(Choice.Effects.Num));
+        for (int32 Index = Choice.Effects.First; Index < Choice.Effects.End(); ++Index)
+        {
+            const FDialogueCompiledEffect& Effect = Effects[Index];
+            Hash = HashCombine(Hash, HashCombine(GetTypeHash(Effect.Slot), GetTypeHash(static_cast<uint8>(Effect.Op))));
+            Hash = HashCombine(Hash, HashValue(Effect.Value));
+        }
+        Hash = HashCombine(Hash, HashLink(Choice.Next));
+        Hash = HashCombine(Hash, HashLink(Choice.Failure));
+    }
+    return Hash;
+}
+
+SIZE_T FDialogueGraph::GetAllocatedSize() const
+{
+    SIZE_T Size = Nodes.GetAllocatedSize() + Choices.GetAllocatedSize() + Lines.GetAllocatedSize()
+        + Conditions.GetAllocatedSize() + ConditionOps.GetAllocatedSize() + ConditionReads.GetAllocatedSize() + Effects.GetAllocatedSize()
+        + NodeMedia.GetAllocatedSize() + TextSegments.GetAllocatedSize() + StringTemplates.GetAllocatedSize() + ExternalLinks.GetAllocatedSize()
+        + StringData.GetAllocatedSize() + StringOffsets.GetAllocatedSize() + NodeIndexById.GetAllocatedSize();
+    for (const TPair<FString, int32>& Pair : NodeIndexById)
+    {
+        Size += Pair.Key.GetAllocatedSize();
+    }
+    return Size;
+}
+
+uint32 FDialogueGraph::GetContentHash() const
+{
+    // Slots and FName indices differ between processes; names are hashed by their lowercase spelling
+    const FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    auto HashName = [](FName Name) { return FCrc::StrCrc32(*Name.ToString().ToLower()); };
+    auto HashSlot = [&](int32 Slot) { return Slot == INDEX_NONE ? 0u : HashName(Registry.GetName(Slot)); };
+    auto HashValue = [&](const FDialogueValue& Value)
+    {
+        switch (Value.Type)
+        {
+        case EDialogueValueType::Int:
+        case EDialogueValueType::Bool:  return HashCombine(1, GetTypeHash(Value.Int));
+        case EDialogueValueType::Float: return HashCombine(2, GetTypeHash(Value.Float));
+        case EDialogueValueType::Name:  return HashCombine(3, HashName(Value.Name));
+        default:                        return 0u;
+        }
+    };
+
+    // TCHAR is 2 bytes on Windows and 4 elsewhere; StrCrc32 hashes characters the same on both
+    uint32 Hash = 0;
+    for (int32 StringIndex = 0; StringIndex + 1 < StringOffsets.Num(); ++StringIndex)
+    {
+        Hash = FCrc::StrCrc32(StringData.GetData() + StringOffsets[StringIndex], Hash);
+    }
+
+    // The flat arrays hold nothing but indices into each other and the string pool
+    Hash = FCrc::MemCrc32(Nodes.GetData(), Nodes.Num() * sizeof(FDialogueGraphNode), Hash);
+    Hash = FCrc::MemCrc32(Choices.GetData(), Choices.Num() * sizeof(FDialogueGraphChoice), Hash);
+    Hash = FCrc::MemCrc32(Lines.GetData(), Lines.Num() * sizeof(FDialogueGraphLine), Hash);
+    Hash = FCrc::MemCrc32(Conditions.GetData(), Conditions.Num() * sizeof(FDialogueGraphCondition), Hash);
+    Hash = FCrc::MemCrc32(ExternalLinks.GetData(), ExternalLinks.Num() * sizeof(FDialogueExternalLink), Hash);
+
+    for (const FDialogueConditionOp& Op : ConditionOps)
+    {
+        Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Op.Code)));
+        Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Op.Compare)));
+        Hash = HashCombine(Hash, GetTypeHash(Op.SkipTo));
+        Hash = HashCombine(Hash, HashSlot(Op.Slot));
+        Hash = HashCombine(Hash, HashValue(Op.Literal));
+    }
+    for (const FDialogueCompiledEffect& Effect : Effects)
+    {
+        Hash = HashCombine(Hash, HashSlot(Effect.Slot));
+        Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Effect.Op)));
+        Hash = HashCombine(Hash, HashValue(Effect.Value));
+    }
+    return Hash;
+}
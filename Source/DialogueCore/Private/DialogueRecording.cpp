@@ -0,0 +1,187 @@
+#include "DialogueRecording.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    constexpr uint32 RecordingMagic = 0x43455244; // "DREC"
+    constexpr uint32 RecordingVersion = 1;
+
+    uint32 HashName(FName Name)
+    {
+        return FCrc::StrCrc32(*Name.ToString().ToLower());
+    }
+
+    // Zigzag, so small negative numbers pack into a byte as well
+    void SerializeSigned(FArchive& Ar, int32& Value)
+    {
+        uint32 Packed = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+        Ar.SerializeIntPacked(Packed);
+        Value = static_cast<int32>((Packed >> 1) ^ (0u - (Packed & 1u)));
+    }
+
+    void SerializeName(FArchive& Ar, FName& Name)
+    {
+        FString Text = Ar.IsLoading() ? FString() : Name.ToString();
+        Ar << Text;
+        if (Ar.IsLoading())
+        {
+            Name = FName(*Text);
+        }
+    }
+
+    // Smallest an attribute (empty name, untyped value) and a step (advance with one-byte node index)
+    // take in the file, to sanity-check counts read from it
+    constexpr int64 MinAttributeBytes = sizeof(int32) + 1;
+    constexpr int64 MinStepBytes = 1 + 1 + 2 * sizeof(uint32);
+
+    // False if the rest of a file being loaded can't hold Num entries of MinBytes each
+    bool IsPlausibleCount(FArchive& Ar, uint32 Num, int64 MinBytes)
+    {
+        return !Ar.IsLoading() || Num <= static_cast<uint64>(FMath::Max<int64>(Ar.TotalSize() - Ar.Tell(), 0)) / MinBytes;
+    }
+
+    void SerializeValue(FArchive& Ar, FDialogueValue& Value)
+    {
+        uint8 Type = static_cast<uint8>(Value.Type);
+        Ar << Type;
+        if (Ar.IsLoading())
+        {
+            Value = FDialogueValue();
+            Value.Type = static_cast<EDialogueValueType>(Type);
+        }
+
+        switch (Value.Type)
+        {
+        case EDialogueValueType::Int:
+        case EDialogueValueType::Bool:  SerializeSigned(Ar, Value.Int); break;
+        case EDialogueValueType::Float: Ar << Value.Float; break;
+        case EDialogueValueType::Name:  SerializeName(Ar, Value.Name); break;
+        default:                        break;
+        }
+    }
+}
+
+void FDialogueRecording::SetInitialState(const FDialogueState& State)
+{
+    const FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const TArray<FDialogueValue>& Values = State.GetValues();
+
+    InitialState.Reset();
+    for (int32 Slot = 0; Slot < Values.Num(); ++Slot)
+    {
+        if (Values[Slot].Type != EDialogueValueType::None)
+        {
+            InitialState.Emplace(Registry.GetName(Slot), Values[Slot]);
+        }
+    }
+}
+
+FDialogueState FDialogueRecording::MakeInitialState() const
+{
+    FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+
+    FDialogueState State;
+    for (const TPair<FName, FDialogueValue>& Attribute : InitialState)
+    {
+        State.Set(Registry.FindOrAdd(Attribute.Key, Attribute.Value.Type), Attribute.Value);
+    }
+    return State;
+}
+
+uint32 FDialogueRecording::HashState(const FDialogueState& State)
+{
+    const FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const TArray<FDialogueValue>& Values = State.GetValues();
+
+    // Slots are numbered in load order, which differs between processes; summing makes the order irrelevant
+    uint32 Hash = 0;
+    for (int32 Slot = 0; Slot < Values.Num(); ++Slot)
+    {
+        const FDialogueValue& Value = Values[Slot];
+        uint32 ValueHash = 0;
+        switch (Value.Type)
+        {
+        case EDialogueValueType::Int:
+        case EDialogueValueType::Bool:  ValueHash = HashCombine(1, GetTypeHash(Value.Int)); break;
+        case EDialogueValueType::Float: ValueHash = HashCombine(2, GetTypeHash(Value.Float)); break;
+        case EDialogueValueType::Name:  ValueHash = HashCombine(3, HashName(Value.Name)); break;
+        default:                        continue;
+        }
+        Hash += HashCombine(HashName(Registry.GetName(Slot)), ValueHash);
+    }
+    return Hash;
+}
+
+bool FDialogueRecording::Serialize(FArchive& Ar)
+{
+    uint32 Magic = RecordingMagic;
+    uint32 Version = RecordingVersion;
+    Ar << Magic;
+    Ar.SerializeIntPacked(Version);
+    if (Ar.IsError() || Magic != RecordingMagic || Version > RecordingVersion)
+    {
+        return false;
+    }
+
+    uint8 bLocked = bShowLockedChoices ? 1 : 0;
+    Ar << GraphPath << GraphHash << StartNodeID << bLocked;
+    bShowLockedChoices = bLocked != 0;
+    if (Ar.IsError()) return false;
+
+    uint32 NumAttributes = InitialState.Num();
+    Ar.SerializeIntPacked(NumAttributes);
+    if (Ar.IsError() || !IsPlausibleCount(Ar, NumAttributes, MinAttributeBytes)) return false;
+    if (Ar.IsLoading())
+    {
+        InitialState.SetNum(NumAttributes);
+    }
+    for (TPair<FName, FDialogueValue>& Attribute : InitialState)
+    {
+        SerializeName(Ar, Attribute.Key);
+        SerializeValue(Ar, Attribute.Value);
+        if (Ar.IsError()) return false;
+    }
+
+    uint32 NumSteps = Steps.Num();
+    Ar.SerializeIntPacked(NumSteps);
+    if (Ar.IsError() || !IsPlausibleCount(Ar, NumSteps, MinStepBytes)) return false;
+    if (Ar.IsLoading())
+    {
+        Steps.SetNum(NumSteps);
+    }
+    for (FDialogueRecordedStep& Step : Steps)
+    {
+        uint8 Input = static_cast<uint8>(Step.Input);
+        Ar << Input;
+        Step.Input = static_cast<EDialogueRecordedInput>(Input);
+        if (Step.Input == EDialogueRecordedInput::SelectChoice)
+        {
+            SerializeSigned(Ar, Step.ChoiceIndex);
+        }
+        SerializeSigned(Ar, Step.NodeIndex);
+        Ar << Step.LineHash << Step.StateHash;
+        if (Ar.IsError()) return false;
+    }
+    return !Ar.IsError();
+}
+
+bool FDialogueRecording::SaveToFile(const FString& FilePath) const
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+
+    // Serialize only reads from the recording when saving
+    const_cast<FDialogueRecording*>(this)->Serialize(Writer);
+    return FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+}
+
+bool FDialogueRecording::LoadFromFile(const FString& FilePath)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *FilePath)) return false;
+
+    FMemoryReader Reader(Bytes);
+    return Serialize(Reader);
+}
@@ -0,0 +1,166 @@
+#include "DialogueSession.h"
+#include "DialogueSpeculation.h"
+#include "DialogueStats.h"
+
+void FDialogueSession::SetGraph(FDialogueGraphRef InGraph)
+{
+    Graph = MoveTemp(InGraph);
+    NodeIndex = INDEX_NONE;
+    bActive = false;
+    ResetResolved();
+}
+
+void FDialogueSession::SetState(const FDialogueState& InState)
+{
+    // The new state's versions say nothing about results computed against the old one
+    State = InState;
+    ResetResolved();
+}
+
+void FDialogueSession::ResetResolved()
+{
+    ConditionCache.Reset();
+    ResolvedLine.Reset();
+    ResolvedLineKey = FResolvedKey();
+    ResolvedChoices.Reset();
+    ResolvedChoicesKey = FResolvedKey();
+}
+
+bool FDialogueSession::Start(const FString& NodeID)
+{
+    EnterNode(Graph ? Graph->FindNodeIndex(NodeID) : INDEX_NONE);
+    return bActive;
+}
+
+void FDialogueSession::EnterNode(int32 InNodeIndex)
+{
+    NodeIndex = InNodeIndex;
+    bActive = GetNode() != nullptr;
+}
+
+FString FDialogueSession::GetSpeaker() const
+{
+    const FDialogueGraphNode* Node = GetNode();
+    return Node ? FString(Graph->GetString(Node->Speaker)) : FString();
+}
+
+const FString& FDialogueSession::GetLine() const
+{
+    const FDialogueGraphNode* Node = GetNode();
+    if (!Node)
+    {
+        static const FString Empty;
+        return Empty;
+    }
+
+    const FResolvedKey Key{ Graph->GetId(), NodeIndex, State.GetId(), State.GetVersion(), false };
+    if (!(Key == ResolvedLineKey))
+    {
+        const int32 MissesBefore = ConditionCache.GetNumMisses();
+        ResolvedLine = Graph->ResolveLine(*Node, State, &ConditionCache);
+        ResolvedLineKey = Key;
+        CSV_CUSTOM_STAT(Dialogue, ConditionsPerStep, ConditionCache.GetNumMisses() - MissesBefore, ECsvCustomStatOp::Accumulate);
+    }
+    return ResolvedLine;
+}
+
+TConstArrayView<FDialogueResolvedChoice> FDialogueSession::GetChoices(bool bIncludeLocked) const
+{
+    const FDialogueGraphNode* Node = GetNode();
+    if (!Node) return {};
+
+    const FResolvedKey Key{ Graph->GetId(), NodeIndex, State.GetId(), State.GetVersion(), bIncludeLocked };
+    if (!(Key == ResolvedChoicesKey))
+    {
+        const int32 MissesBefore = ConditionCache.GetNumMisses();
+        Graph->ResolveChoices(*Node, State, bIncludeLocked, ResolvedChoices, &ConditionCache);
+        ResolvedChoicesKey = Key;
+        CSV_CUSTOM_STAT(Dialogue, ConditionsPerStep, ConditionCache.GetNumMisses() - MissesBefore, ECsvCustomStatOp::Accumulate);
+    }
+    return ResolvedChoices;
+}
+
+const FDialogueGraphChoice& FDialogueSession::GetAuthoredChoice(const FDialogueResolvedChoice& Choice) const
+{
+    return Graph->Choices[GetNode()->Choices.First + Choice.ChoiceIndex];
+}
+
+void FDialogueSession::AppendChoiceText(const FDialogueResolvedChoice& Choice, FStringBuilderBase& Out) const
+{
+    Graph->AppendText(Choice.Text, GetNode()->Speaker, State, Out, &ConditionCache);
+}
+
+int32 FDialogueSession::TakeChoice(const FDialogueResolvedChoice& Choice)
+{
+    const FDialogueGraphChoice& Authored = GetAuthoredChoice(Choice);
+    if (Choice.bLocked)
+    {
+        return Authored.Failure;
+    }
+
+    Graph->ApplyEffects(Authored, State);
+    return Authored.Next;
+}
+
+bool FDialogueSession::Follow(int32 Link)
+{
+    if (FDialogueGraph::IsExternalLink(Link)) return false;
+
+    if (Link == INDEX_NONE)
+    {
+        End();
+    }
+    else
+    {
+        EnterNode(Link);
+    }
+    return true;
+}
+
+bool FDialogueSession::SelectChoice(int32 ChoiceIndex, bool bIncludeLocked)
+{
+    const TConstArrayView<FDialogueResolvedChoice> Choices = GetChoices(bIncludeLocked);
+    if (!Choices.IsValidIndex(ChoiceIndex)) return false;
+
+    const FDialogueResolvedChoice& Choice = Choices[ChoiceIndex];
+    const int32 Link = TakeChoice(Choice);
+    if (Choice.bLocked && Link == INDEX_NONE)
+    {
+        UE_LOG(LogDialogue, Verbose, TEXT("%s: choice %d of node '%s' is locked and has no failure branch"),
+            *Graph->SourcePath, ChoiceIndex, *FString(Graph->GetNodeId(NodeIndex)));
+        return false;
+    }
+
+    return Follow(Link);
+}
+
+bool FDialogueSession::Advance()
+{
+    const FDialogueGraphNode* Node = GetNode();
+    if (!bActive || !Node || Node->Choices.Num > 0) return false;
+
+    return Follow(Node->Next);
+}
+
+int32 FDialogueSession::AdoptSpeculated(FDialogueSpeculation& Speculation, int32 ChoiceIndex, bool bFailure, bool bIncludeLocked)
+{
+    const FDialogueGraphNode* Node = GetNode();
+    if (!Node || !Speculation.Matches(Graph.Get(), NodeIndex, State, bIncludeLocked)) return INDEX_NONE;
+
+    FDialogueSpeculativeBranch* Branch = Speculation.FindBranch(ChoiceIndex, bFailure);
+    if (!Branch) return INDEX_NONE;
+
+    // The branch started from a copy of this very state, and only the effects of an unlocked choice
+    // were applied to it. Applying them to our own state gives the same values, so its line and
+    // choices hold here too, while the state (and the condition results cached against it) stay ours.
+    if (ChoiceIndex != INDEX_NONE && !bFailure)
+    {
+        Graph->ApplyEffects(Graph->Choices[Node->Choices.First + ChoiceIndex], State);
+    }
+
+    ResolvedLine = MoveTemp(Branch->Line);
+    ResolvedLineKey = { Graph->GetId(), Branch->NodeIndex, State.GetId(), State.GetVersion(), false };
+    ResolvedChoices = MoveTemp(Branch->Choices);
+    ResolvedChoicesKey = { Graph->GetId(), Branch->NodeIndex, State.GetId(), State.GetVersion(), bIncludeLocked };
+    return Branch->NodeIndex;
+}
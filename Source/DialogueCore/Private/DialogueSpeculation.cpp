@@ -0,0 +1,88 @@
+#include "DialogueSpeculation.h"
+#include "Async/Async.h"
+
+TSharedRef<FDialogueSpeculation, ESPMode::ThreadSafe> FDialogueSpeculation::Launch(FDialogueGraphRef InGraph, int32 InNodeIndex,
+    const FDialogueState& State, bool bInIncludeLocked)
+{
+    TSharedRef<FDialogueSpeculation, ESPMode::ThreadSafe> Speculation = MakeShareable(new FDialogueSpeculation());
+    Speculation->Graph = MoveTemp(InGraph);
+    Speculation->NodeIndex = InNodeIndex;
+    Speculation->BaseState = State;
+    Speculation->SourceStateId = State.GetId();
+    Speculation->SourceStateVersion = State.GetVersion();
+    Speculation->bIncludeLocked = bInIncludeLocked;
+
+    Async(EAsyncExecution::ThreadPool, [Speculation]()
+    {
+        Speculation->Run();
+    });
+    return Speculation;
+}
+
+bool FDialogueSpeculation::Matches(const FDialogueGraph* InGraph, int32 InNodeIndex, const FDialogueState& State, bool bInIncludeLocked) const
+{
+    // A version only says something about the state it came from: a replaced or copied state can
+    // carry the same number with different contents, but never the same id
+    return Graph.Get() == InGraph && NodeIndex == InNodeIndex && bIncludeLocked == bInIncludeLocked
+        && SourceStateId == State.GetId() && SourceStateVersion == State.GetVersion();
+}
+
+FDialogueSpeculativeBranch* FDialogueSpeculation::FindBranch(int32 ChoiceIndex, bool bFailure)
+{
+    if (!IsReady()) return nullptr;
+
+    return Branches.FindByPredicate([ChoiceIndex, bFailure](const FDialogueSpeculativeBranch& Branch)
+    {
+        return Branch.ChoiceIndex == ChoiceIndex && Branch.bFailure == bFailure;
+    });
+}
+
+void FDialogueSpeculation::Run()
+{
+    const FDialogueGraphNode* Node = Graph ? Graph->GetNode(NodeIndex) : nullptr;
+    if (!Node)
+    {
+        bReady.store(true, std::memory_order_release);
+        return;
+    }
+
+    // Same decisions SelectChoice / AdvanceDialogue would make on the base state.
+    // Links that end the dialogue or lead into another file have nothing to resolve here.
+    auto AddBranch = [this](int32 ChoiceIndex, bool bFailure, int32 Target, const FDialogueGraphChoice* Effects)
+    {
+        if (Target < 0 || bCancelled.load(std::memory_order_relaxed)) return;
+
+        FDialogueSpeculativeBranch& Branch = Branches.AddDefaulted_GetRef();
+        Branch.ChoiceIndex = ChoiceIndex;
+        Branch.bFailure = bFailure;
+        Branch.NodeIndex = Target;
+        Branch.State = BaseState;
+        if (Effects)
+        {
+            Graph->ApplyEffects(*Effects, Branch.State);
+        }
+
+        const FDialogueGraphNode& TargetNode = Graph->Nodes[Target];
+        Branch.Line = Graph->ResolveLine(TargetNode, Branch.State);
+        Graph->ResolveChoices(TargetNode, Branch.State, bIncludeLocked, Branch.Choices);
+    };
+
+    if (Node->Choices.Num == 0)
+    {
+        AddBranch(INDEX_NONE, false, Node->Next, nullptr);
+    }
+    for (int32 Index = 0; Index < Node->Choices.Num; ++Index)
+    {
+        const FDialogueGraphChoice& Choice = Graph->Choices[Node->Choices.First + Index];
+        if (Graph->IsChoiceUnlocked(Choice, BaseState))
+        {
+            AddBranch(Index, false, Choice.Next, &Choice);
+        }
+        else if (bIncludeLocked)
+        {
+            AddBranch(Index, true, Choice.Failure, nullptr);
+        }
+    }
+
+    bReady.store(true, std::memory_order_release);
+}
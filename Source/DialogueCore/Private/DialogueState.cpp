@@ -0,0 +1,464 @@
+#include "DialogueState.h"
+#include "DialogueStats.h"
+#include "Misc/ConfigCacheIni.h"
+#include <atomic>
+
+FDialogueValue FDialogueValue::MakeInt(int32 Value)
+{
+    FDialogueValue Result;
+    Result.Type = EDialogueValueType::Int;
+    Result.Int = Value;
+    return Result;
+}
+
+FDialogueValue FDialogueValue::MakeFloat(float Value)
+{
+    FDialogueValue Result;
+    Result.Type = EDialogueValueType::Float;
+    Result.Float = Value;
+    return Result;
+}
+
+FDialogueValue FDialogueValue::MakeBool(bool bValue)
+{
+    FDialogueValue Result;
+    Result.Type = EDialogueValueType::Bool;
+    Result.Int = bValue ? 1 : 0;
+    return Result;
+}
+
+FDialogueValue FDialogueValue::MakeName(FName Value)
+{
+    FDialogueValue Result;
+    Result.Type = EDialogueValueType::Name;
+    Result.Name = Value;
+    return Result;
+}
+
+bool FDialogueValue::operator==(const FDialogueValue& Other) const
+{
+    if (Type != Other.Type) return false;
+    switch (Type)
+    {
+    case EDialogueValueType::Int:
+    case EDialogueValueType::Bool:  return Int == Other.Int;
+    case EDialogueValueType::Float: return Float == Other.Float;
+    case EDialogueValueType::Name:  return Name == Other.Name;
+    default:                        return true;
+    }
+}
+
+FString FDialogueValue::ToString() const
+{
+    switch (Type)
+    {
+    case EDialogueValueType::Int:   return FString::FromInt(Int);
+    case EDialogueValueType::Float: return FString::SanitizeFloat(Float);
+    case EDialogueValueType::Bool:  return Int != 0 ? TEXT("true") : TEXT("false");
+    case EDialogueValueType::Name:  return Name.ToString();
+    default:                        return TEXT("<unset>");
+    }
+}
+
+bool FDialogueValue::Parse(const FString& Text, EDialogueValueType InType, FDialogueValue& OutValue)
+{
+    switch (InType)
+    {
+    case EDialogueValueType::Int:
+        // "2.5" is not an int; truncating it would silently change what the data says
+        if (!FCString::IsNumeric(*Text) || Text.Contains(TEXT("."))) return false;
+        OutValue = MakeInt(FCString::Atoi(*Text));
+        return true;
+
+    case EDialogueValueType::Float:
+        if (!FCString::IsNumeric(*Text)) return false;
+        OutValue = MakeFloat(FCString::Atof(*Text));
+        return true;
+
+    case EDialogueValueType::Bool:
+        if (Text.Equals(TEXT("true"), ESearchCase::IgnoreCase)) { OutValue = MakeBool(true); return true; }
+        if (Text.Equals(TEXT("false"), ESearchCase::IgnoreCase)) { OutValue = MakeBool(false); return true; }
+        return false;
+
+    case EDialogueValueType::Name:
+        OutValue = MakeName(FName(*Text));
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+EDialogueValueType FDialogueValue::InferType(const FString& Text, bool bQuoted)
+{
+    if (bQuoted) return EDialogueValueType::Name;
+    if (Text.Equals(TEXT("true"), ESearchCase::IgnoreCase) || Text.Equals(TEXT("false"), ESearchCase::IgnoreCase))
+    {
+        return EDialogueValueType::Bool;
+    }
+    if (FCString::IsNumeric(*Text))
+    {
+        return Text.Contains(TEXT(".")) ? EDialogueValueType::Float : EDialogueValueType::Int;
+    }
+    return EDialogueValueType::Name;
+}
+
+const TCHAR* FDialogueValue::TypeToString(EDialogueValueType InType)
+{
+    switch (InType)
+    {
+    case EDialogueValueType::Int:   return TEXT("int");
+    case EDialogueValueType::Float: return TEXT("float");
+    case EDialogueValueType::Bool:  return TEXT("bool");
+    case EDialogueValueType::Name:  return TEXT("name");
+    default:                        return TEXT("none");
+    }
+}
+
+static bool IsNumericType(EDialogueValueType Type)
+{
+    return Type == EDialogueValueType::Int || Type == EDialogueValueType::Float;
+}
+
+FDialogueAttributeRegistry& FDialogueAttributeRegistry::Get()
+{
+    static FDialogueAttributeRegistry Registry;
+    return Registry;
+}
+
+FDialogueAttributeRegistry::FDialogueAttributeRegistry()
+{
+    // Attributes the original hard-coded state knew about, so their types don't depend on data order
+    FindOrAdd(TEXT("trust"), EDialogueValueType::Int);
+    FindOrAdd(TEXT("last_topic"), EDialogueValueType::Name);
+}
+
+bool FDialogueAttributeRegistry::Declare(const FString& Name, EDialogueValueType Type)
+{
+    if (Name.IsEmpty() || Type == EDialogueValueType::None) return false;
+
+    FWriteScopeLock WriteLock(Lock);
+    bDeclared = true;
+
+    if (Name.EndsWith(TEXT("*")))
+    {
+        const FString Prefix = Name.LeftChop(1);
+        for (const TPair<FString, EDialogueValueType>& Declared : DeclaredPrefixes)
+        {
+            if (Declared.Key.Equals(Prefix, ESearchCase::IgnoreCase)) return Declared.Value == Type;
+        }
+        DeclaredPrefixes.Emplace(Prefix, Type);
+        return true;
+    }
+
+    const FName AttributeName(*Name);
+    if (const int32* Found = SlotsByName.Find(AttributeName))
+    {
+        return Types[*Found] == Type;
+    }
+
+    const int32 Slot = Names.Add(AttributeName);
+    Types.Add(Type);
+    SlotsByName.Add(AttributeName, Slot);
+    return true;
+}
+
+void FDialogueAttributeRegistry::LoadDeclarations(const FString& ConfigFile)
+{
+    TArray<FString> Entries;
+    if (!GConfig || !GConfig->GetArray(TEXT("DialogueAttributes"), TEXT("Attributes"), Entries, ConfigFile)) return;
+
+    for (const FString& Entry : Entries)
+    {
+        FString Name, TypeText;
+        EDialogueValueType Type = EDialogueValueType::None;
+        if (Entry.Split(TEXT(":"), &Name, &TypeText))
+        {
+            Name.TrimStartAndEndInline();
+            TypeText.TrimStartAndEndInline();
+            for (const EDialogueValueType Candidate : { EDialogueValueType::Int, EDialogueValueType::Float, EDialogueValueType::Bool, EDialogueValueType::Name })
+            {
+                if (TypeText.Equals(FDialogueValue::TypeToString(Candidate), ESearchCase::IgnoreCase)) Type = Candidate;
+            }
+        }
+
+        if (Type == EDialogueValueType::None)
+        {
+            UE_LOG(LogDialogue, Error, TEXT("[DialogueAttributes] \"%s\" should be name:type with type int, float, bool or name"), *Entry);
+        }
+        else if (!Declare(Name, Type))
+        {
+            UE_LOG(LogDialogue, Error, TEXT("[DialogueAttributes] \"%s\" conflicts with an earlier declaration of '%s'"), *Entry, *Name);
+        }
+    }
+}
+
+bool FDialogueAttributeRegistry::HasDeclarations() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return bDeclared;
+}
+
+EDialogueValueType FDialogueAttributeRegistry::FindPrefixType(FName Name) const
+{
+    if (DeclaredPrefixes.IsEmpty()) return EDialogueValueType::None;
+
+    // Longest prefix wins, so "skill.combat.*" can refine "skill.*"
+    const FString NameString = Name.ToString();
+    int32 BestLength = -1;
+    EDialogueValueType BestType = EDialogueValueType::None;
+    for (const TPair<FString, EDialogueValueType>& Declared : DeclaredPrefixes)
+    {
+        if (Declared.Key.Len() > BestLength && NameString.StartsWith(Declared.Key, ESearchCase::IgnoreCase))
+        {
+            BestLength = Declared.Key.Len();
+            BestType = Declared.Value;
+        }
+    }
+    return BestType;
+}
+
+int32 FDialogueAttributeRegistry::FindOrAdd(FName Name, EDialogueValueType Type)
+{
+    FWriteScopeLock WriteLock(Lock);
+
+    if (const int32* Found = SlotsByName.Find(Name))
+    {
+        const EDialogueValueType Existing = Types[*Found];
+        const bool bCompatible = Existing == Type || (IsNumericType(Existing) && IsNumericType(Type));
+        return bCompatible ? *Found : INDEX_NONE;
+    }
+
+    // With declarations, a new name must fall under a declared prefix and takes its type from it
+    EDialogueValueType SlotType = Type;
+    if (bDeclared)
+    {
+        SlotType = FindPrefixType(Name);
+        const bool bCompatible = SlotType == Type || (IsNumericType(SlotType) && IsNumericType(Type));
+        if (SlotType == EDialogueValueType::None || !bCompatible) return INDEX_NONE;
+    }
+
+    const int32 Slot = Names.Add(Name);
+    Types.Add(SlotType);
+    SlotsByName.Add(Name, Slot);
+    return Slot;
+}
+
+FString FDialogueAttributeRegistry::DescribeRejection(FName Name, EDialogueValueType Type) const
+{
+    const EDialogueValueType Existing = FindType(Name);
+    if (Existing == EDialogueValueType::None)
+    {
+        return FString::Printf(TEXT("unknown attribute '%s' (declare it in [DialogueAttributes] of the Game config)"), *Name.ToString());
+    }
+    return FString::Printf(TEXT("'%s' is a %s attribute, not %s"), *Name.ToString(), FDialogueValue::TypeToString(Existing), FDialogueValue::TypeToString(Type));
+}
+
+int32 FDialogueAttributeRegistry::Find(FName Name) const
+{
+    FReadScopeLock ReadLock(Lock);
+    const int32* Found = SlotsByName.Find(Name);
+    return Found ? *Found : INDEX_NONE;
+}
+
+EDialogueValueType FDialogueAttributeRegistry::FindType(FName Name) const
+{
+    FReadScopeLock ReadLock(Lock);
+    const int32* Found = SlotsByName.Find(Name);
+    return Found ? Types[*Found] : FindPrefixType(Name);
+}
+
+EDialogueValueType FDialogueAttributeRegistry::GetType(int32 Slot) const
+{
+    FReadScopeLock ReadLock(Lock);
+    return Types.IsValidIndex(Slot) ? Types[Slot] : EDialogueValueType::None;
+}
+
+FName FDialogueAttributeRegistry::GetName(int32 Slot) const
+{
+    FReadScopeLock ReadLock(Lock);
+    return Names.IsValidIndex(Slot) ? Names[Slot] : NAME_None;
+}
+
+int32 FDialogueAttributeRegistry::Num() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return Names.Num();
+}
+
+bool FDialogueCompiledEffect::Compile(const FString& Attribute, EDialogueStateOp InOp, const FString& InValue, FString& OutError)
+{
+    Slot = INDEX_NONE;
+    Op = InOp;
+
+    if (Attribute.IsEmpty())
+    {
+        OutError = TEXT("effect has no attribute");
+        return false;
+    }
+
+    FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const FName Name(*Attribute);
+
+    // Type of an undeclared new attribute follows from how it is first written
+    EDialogueValueType Type = Registry.FindType(Name);
+    if (Type == EDialogueValueType::None)
+    {
+        if (Op == EDialogueStateOp::Toggle) Type = EDialogueValueType::Bool;
+        else if (Attribute.StartsWith(TEXT("skill."), ESearchCase::IgnoreCase)) Type = EDialogueValueType::Int;
+        else Type = FDialogueValue::InferType(InValue, false);
+    }
+
+    switch (Op)
+    {
+    case EDialogueStateOp::Toggle:
+        if (Type != EDialogueValueType::Bool)
+        {
+            OutError = FString::Printf(TEXT("can't toggle %s attribute '%s'"), FDialogueValue::TypeToString(Type), *Attribute);
+            return false;
+        }
+        break;
+
+    case EDialogueStateOp::Add:
+        if (Type == EDialogueValueType::Bool)
+        {
+            OutError = FString::Printf(TEXT("can't add to bool attribute '%s'"), *Attribute);
+            return false;
+        }
+        // Add on a name attribute behaves like Set
+        if (Type == EDialogueValueType::Name) Op = EDialogueStateOp::Set;
+        [[fallthrough]];
+
+    case EDialogueStateOp::Set:
+        if (!FDialogueValue::Parse(InValue, Type, Value))
+        {
+            OutError = FString::Printf(TEXT("'%s' is not a valid %s for '%s'"), *InValue, FDialogueValue::TypeToString(Type), *Attribute);
+            return false;
+        }
+        break;
+    }
+
+    Slot = Registry.FindOrAdd(Name, Type);
+    if (Slot == INDEX_NONE)
+    {
+        OutError = Registry.DescribeRejection(Name, Type);
+        return false;
+    }
+    return true;
+}
+
+static uint32 AllocateStateId()
+{
+    static std::atomic<uint32> NextId { 1 };
+    return NextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+FDialogueState::FDialogueState()
+    : Id(AllocateStateId())
+{
+}
+
+FDialogueState::FDialogueState(const FDialogueState& Other)
+    : Values(Other.Values)
+    , SlotVersions(Other.SlotVersions)
+    , Version(Other.Version)
+    , ResetVersion(Other.ResetVersion)
+    , Id(AllocateStateId())
+{
+}
+
+FDialogueState::FDialogueState(FDialogueState&& Other)
+    : Values(MoveTemp(Other.Values))
+    , SlotVersions(MoveTemp(Other.SlotVersions))
+    , Version(Other.Version)
+    , ResetVersion(Other.ResetVersion)
+    , Id(AllocateStateId())
+{
+}
+
+FDialogueState& FDialogueState::operator=(const FDialogueState& Other)
+{
+    Values = Other.Values;
+    SlotVersions = Other.SlotVersions;
+    Version = Other.Version;
+    ResetVersion = Other.ResetVersion;
+    Id = AllocateStateId();
+    return *this;
+}
+
+FDialogueState& FDialogueState::operator=(FDialogueState&& Other)
+{
+    Values = MoveTemp(Other.Values);
+    SlotVersions = MoveTemp(Other.SlotVersions);
+    Version = Other.Version;
+    ResetVersion = Other.ResetVersion;
+    Id = AllocateStateId();
+    return *this;
+}
+
+int32 FDialogueState::GetInt(int32 Slot) const
+{
+    if (!Values.IsValidIndex(Slot)) return 0;
+    const FDialogueValue& Value = Values[Slot];
+    return Value.Type == EDialogueValueType::Float ? static_cast<int32>(Value.Float) : Value.Int;
+}
+
+float FDialogueState::GetFloat(int32 Slot) const
+{
+    if (!Values.IsValidIndex(Slot)) return 0.f;
+    const FDialogueValue& Value = Values[Slot];
+    return Value.Type == EDialogueValueType::Float ? Value.Float : static_cast<float>(Value.Int);
+}
+
+void FDialogueState::Set(int32 Slot, const FDialogueValue& Value)
+{
+    if (Slot < 0) return;
+    if (Slot >= Values.Num())
+    {
+        Values.SetNum(Slot + 1);
+        SlotVersions.SetNumZeroed(Slot + 1);
+    }
+    else if (Values[Slot] == Value)
+    {
+        // Same value as far as conditions can tell; still store it for the exact spelling of names
+        Values[Slot] = Value;
+        return;
+    }
+
+    Values[Slot] = Value;
+    SlotVersions[Slot] = ++Version;
+}
+
+void FDialogueState::Reset()
+{
+    Values.Reset();
+    SlotVersions.Reset();
+    ResetVersion = ++Version;
+}
+
+void FDialogueState::ApplyEffect(const FDialogueCompiledEffect& Effect)
+{
+    if (!Effect.IsValid()) return;
+
+    switch (Effect.Op)
+    {
+    case EDialogueStateOp::Set:
+        Set(Effect.Slot, Effect.Value);
+        break;
+
+    case EDialogueStateOp::Add:
+        if (Effect.Value.Type == EDialogueValueType::Float)
+        {
+            Set(Effect.Slot, FDialogueValue::MakeFloat(GetFloat(Effect.Slot) + Effect.Value.Float));
+        }
+        else
+        {
+            Set(Effect.Slot, FDialogueValue::MakeInt(GetInt(Effect.Slot) + Effect.Value.Int));
+        }
+        break;
+
+    case EDialogueStateOp::Toggle:
+        Set(Effect.Slot, FDialogueValue::MakeBool(!GetBool(Effect.Slot)));
+        break;
+    }
+}
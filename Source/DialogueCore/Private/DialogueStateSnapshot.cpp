@@ -0,0 +1,96 @@
+#include "DialogueStateSnapshot.h"
+
+namespace
+{
+    // Recycled snapshots kept around beyond this are freed
+    constexpr int32 MaxFreeSnapshots = 4;
+}
+
+FDialogueStatePublisher::FDialogueStatePublisher()
+{
+    Readers[0].store(0);
+    Readers[1].store(0);
+
+    // Readers always find a snapshot, even before the first Publish
+    Current.store(new FSnapshot());
+}
+
+FDialogueStatePublisher::~FDialogueStatePublisher()
+{
+    // No reader can be left: each one holds a reference to the publisher
+    delete Current.load();
+    for (FSnapshot* Snapshot : Retired) delete Snapshot;
+    for (FSnapshot* Snapshot : Free) delete Snapshot;
+}
+
+uint32 FDialogueStatePublisher::GetPublishedVersion() const
+{
+    return Current.load()->State.GetVersion();
+}
+
+void FDialogueStatePublisher::Publish(const FDialogueState& State)
+{
+    if (State.GetId() == PublishedStateId && State.GetVersion() == PublishedStateVersion) return;
+    PublishedStateId = State.GetId();
+    PublishedStateVersion = State.GetVersion();
+
+    // Copy-assigning into a recycled snapshot reuses its arrays
+    FSnapshot* Snapshot = Free.Num() > 0 ? Free.Pop(false) : new FSnapshot();
+    Snapshot->State = State;
+
+    FSnapshot* Previous = Current.exchange(Snapshot);
+    Previous->RetiredEpoch = Epoch.load();
+    Retired.Add(Previous);
+
+    Reclaim();
+}
+
+void FDialogueStatePublisher::Reclaim()
+{
+    // Readers only ever sit in the current epoch or the one before it. Once the one before is
+    // empty, move on; readers are then in {E, E + 1} and nothing retired before E is reachable.
+    const uint64 CurrentEpoch = Epoch.load();
+    if (Readers[(CurrentEpoch + 1) & 1].load() == 0)
+    {
+        Epoch.store(CurrentEpoch + 1);
+    }
+
+    const uint64 SafeEpoch = Epoch.load();
+    for (int32 Index = Retired.Num() - 1; Index >= 0; --Index)
+    {
+        FSnapshot* Snapshot = Retired[Index];
+        if (Snapshot->RetiredEpoch + 2 > SafeEpoch) continue;
+
+        Retired.RemoveAtSwap(Index, 1, false);
+        if (Free.Num() < MaxFreeSnapshots)
+        {
+            Free.Add(Snapshot);
+        }
+        else
+        {
+            delete Snapshot;
+        }
+    }
+}
+
+FDialogueStateReadScope::FDialogueStateReadScope(const FDialogueStatePublisher& InPublisher)
+    : Publisher(InPublisher)
+{
+    // Register in the epoch, then confirm it didn't move on while registering; otherwise the
+    // writer may already have judged that epoch empty
+    for (;;)
+    {
+        const uint64 Epoch = Publisher.Epoch.load();
+        Parity = static_cast<uint32>(Epoch & 1);
+        Publisher.Readers[Parity].fetch_add(1);
+        if (Publisher.Epoch.load() == Epoch) break;
+        Publisher.Readers[Parity].fetch_sub(1);
+    }
+
+    State = &Publisher.Current.load()->State;
+}
+
+FDialogueStateReadScope::~FDialogueStateReadScope()
+{
+    Publisher.Readers[Parity].fetch_sub(1);
+}
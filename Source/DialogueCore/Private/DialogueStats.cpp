@@ -0,0 +1,17 @@
+#include "DialogueStats.h"
+
+DEFINE_LOG_CATEGORY(LogDialogue);
+
+DEFINE_STAT(STAT_DialogueLoad);
+DEFINE_STAT(STAT_DialogueParse);
+DEFINE_STAT(STAT_DialogueConditions);
+DEFINE_STAT(STAT_DialogueResolveLine);
+DEFINE_STAT(STAT_DialogueResolveChoices);
+DEFINE_STAT(STAT_DialogueUpdateUI);
+DEFINE_STAT(STAT_DialogueConditionsEvaluated);
+DEFINE_STAT(STAT_DialogueNodesLoaded);
+DEFINE_STAT(STAT_DialogueResidentMemory);
+
+CSV_DEFINE_CATEGORY_MODULE(DIALOGUECORE_API, Dialogue, true);
+
+UE_TRACE_CHANNEL_DEFINE(DialogueChannel);
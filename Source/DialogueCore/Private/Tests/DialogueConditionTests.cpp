@@ -0,0 +1,125 @@
+#include "DialogueCondition.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Attribute names used here are among those declared in Config/DefaultGame.ini, so the tests pass
+// whether or not the registry is in declared mode.
+namespace DialogueConditionTests
+{
+    int32 Slot(const TCHAR* Name, EDialogueValueType Type)
+    {
+        return FDialogueAttributeRegistry::Get().FindOrAdd(FName(Name), Type);
+    }
+
+    bool Compile(FDialogueCondition& Condition, const TCHAR* Source)
+    {
+        FString Error;
+        return Condition.Compile(Source, Error);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueConditionEvaluateTest, "Project.Dialogue.Condition.Evaluate",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueConditionEvaluateTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueConditionTests;
+
+    const int32 Trust = Slot(TEXT("trust"), EDialogueValueType::Int);
+    const int32 LastTopic = Slot(TEXT("last_topic"), EDialogueValueType::Name);
+    const int32 Door = Slot(TEXT("Clue_Test_Door"), EDialogueValueType::Bool);
+    const int32 Observation = Slot(TEXT("skill.observation"), EDialogueValueType::Int);
+
+    FDialogueState State;
+
+    FDialogueCondition And;
+    TestTrue(TEXT("AND compiles"), Compile(And, TEXT("trust >= 1 && last_topic == \"autonomy\"")));
+    TestFalse(TEXT("AND with nothing set"), And.Evaluate(State));
+    State.Set(Trust, FDialogueValue::MakeInt(1));
+    TestFalse(TEXT("AND with one side set"), And.Evaluate(State));
+    State.Set(LastTopic, FDialogueValue::MakeName(TEXT("Autonomy")));
+    TestTrue(TEXT("AND with both sides set, names compared case-insensitively"), And.Evaluate(State));
+
+    FDialogueCondition Or;
+    TestTrue(TEXT("OR compiles"), Compile(Or, TEXT("trust > 5 || Clue_Test_Door && skill.observation >= 2")));
+    TestEqual(TEXT("OR splits the program into groups"), Or.Ops.Num(), 4);
+    TestFalse(TEXT("OR with no group passing"), Or.Evaluate(State));
+    State.Set(Door, FDialogueValue::MakeBool(true));
+    TestFalse(TEXT("second group needs both comparisons"), Or.Evaluate(State));
+    State.Set(Observation, FDialogueValue::MakeInt(2));
+    TestTrue(TEXT("second group passes"), Or.Evaluate(State));
+    State.Set(Door, FDialogueValue::MakeBool(false));
+    State.Set(Trust, FDialogueValue::MakeInt(6));
+    TestTrue(TEXT("first group passes"), Or.Evaluate(State));
+
+    FDialogueCondition Decimal;
+    TestTrue(TEXT("decimal literal compiles"), Compile(Decimal, TEXT("trust > 2.5")));
+    State.Set(Trust, FDialogueValue::MakeInt(2));
+    TestFalse(TEXT("2 > 2.5"), Decimal.Evaluate(State));
+    State.Set(Trust, FDialogueValue::MakeInt(3));
+    TestTrue(TEXT("3 > 2.5"), Decimal.Evaluate(State));
+
+    FDialogueCondition Negated;
+    TestTrue(TEXT("!= compiles"), Compile(Negated, TEXT("last_topic != \"autonomy\"")));
+    TestFalse(TEXT("!= on an equal name"), Negated.Evaluate(State));
+
+    FDialogueCondition Literal;
+    TestTrue(TEXT("bare true compiles"), Compile(Literal, TEXT("true")));
+    TestTrue(TEXT("bare true passes"), Literal.Evaluate(State));
+    TestTrue(TEXT("bare false compiles"), Compile(Literal, TEXT("false")));
+    TestFalse(TEXT("bare false fails"), Literal.Evaluate(State));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueConditionErrorsTest, "Project.Dialogue.Condition.Errors",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueConditionErrorsTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueConditionTests;
+
+    // Give the attributes their types before anything below could register them
+    Slot(TEXT("trust"), EDialogueValueType::Int);
+    Slot(TEXT("last_topic"), EDialogueValueType::Name);
+    Slot(TEXT("Clue_Test_Door"), EDialogueValueType::Bool);
+
+    const TCHAR* Malformed[] =
+    {
+        TEXT(""),
+        TEXT("trust >="),
+        TEXT("trust >= 1 &&"),
+        TEXT("trust >= 1 junk"),
+        TEXT("trust >= \"high\""),
+        TEXT("trust >= high"),
+        TEXT("last_topic > \"autonomy\""),
+        TEXT("last_topic == \"autonomy"),
+        TEXT("\"autonomy\" == last_topic"),
+        TEXT("true == trust"),
+        TEXT("Clue_Test_Door >= 2"),
+        TEXT("trust"),
+    };
+
+    FDialogueState State;
+    for (const TCHAR* Source : Malformed)
+    {
+        FDialogueCondition Condition;
+        FString Error;
+        const bool bCompiled = Condition.Compile(Source, Error);
+        TestFalse(FString::Printf(TEXT("'%s' is rejected"), Source), bCompiled);
+        TestFalse(FString::Printf(TEXT("'%s' explains why"), Source), Error.IsEmpty());
+        TestTrue(FString::Printf(TEXT("'%s' is marked compiled"), Source), Condition.IsCompiled());
+        TestFalse(FString::Printf(TEXT("'%s' is invalid"), Source), Condition.IsValid());
+        TestFalse(FString::Printf(TEXT("'%s' never passes"), Source), Condition.Evaluate(State));
+    }
+
+    // Recompiling replaces the previous program
+    FDialogueCondition Condition;
+    TestFalse(TEXT("first compile fails"), Compile(Condition, TEXT("trust >= 1 junk")));
+    TestTrue(TEXT("second compile succeeds"), Compile(Condition, TEXT("true")));
+    TestTrue(TEXT("recompiled condition is valid"), Condition.IsValid());
+    TestTrue(TEXT("recompiled condition passes"), Condition.Evaluate(State));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
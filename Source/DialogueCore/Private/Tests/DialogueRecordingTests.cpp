@@ -0,0 +1,212 @@
+#include "DialogueGraph.h"
+#include "DialogueRecording.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DialogueRecordingTests
+{
+    int32 Slot(const TCHAR* Name, EDialogueValueType Type)
+    {
+        return FDialogueAttributeRegistry::Get().FindOrAdd(FName(Name), Type);
+    }
+
+    FDialogueRecording MakeRecording()
+    {
+        FDialogueState State;
+        State.Set(Slot(TEXT("trust"), EDialogueValueType::Int), FDialogueValue::MakeInt(-2));
+        State.Set(Slot(TEXT("last_topic"), EDialogueValueType::Name), FDialogueValue::MakeName(TEXT("autonomy")));
+        State.Set(Slot(TEXT("Clue_Test_Door"), EDialogueValueType::Bool), FDialogueValue::MakeBool(true));
+
+        FDialogueRecording Recording;
+        Recording.GraphPath = TEXT("Dialogues/luka_session_01.json");
+        Recording.GraphHash = 0xDEADBEEF;
+        Recording.StartNodeID = TEXT("start");
+        Recording.bShowLockedChoices = true;
+        Recording.SetInitialState(State);
+
+        const EDialogueRecordedInput Inputs[] = { EDialogueRecordedInput::Start, EDialogueRecordedInput::SelectChoice, EDialogueRecordedInput::Advance };
+        for (int32 Index = 0; Index < 3; ++Index)
+        {
+            FDialogueRecordedStep& Step = Recording.Steps.AddDefaulted_GetRef();
+            Step.Input = Inputs[Index];
+            Step.ChoiceIndex = Step.Input == EDialogueRecordedInput::SelectChoice ? 2 : INDEX_NONE;
+            Step.NodeIndex = Index < 2 ? Index * 1000 : INDEX_NONE;
+            Step.LineHash = 0x1000u + Index;
+            Step.StateHash = 0xF0000000u + Index;
+        }
+        return Recording;
+    }
+
+    TArray<uint8> Save(FDialogueRecording& Recording)
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Writer(Bytes);
+        Recording.Serialize(Writer);
+        return Bytes;
+    }
+
+    bool Load(TConstArrayView<uint8> Bytes, FDialogueRecording& OutRecording)
+    {
+        TArray<uint8> Copy(Bytes.GetData(), Bytes.Num());
+        FMemoryReader Reader(Copy);
+        return OutRecording.Serialize(Reader);
+    }
+
+    FDialogueGraphRef MakeGraph(const TCHAR* Line)
+    {
+        FDialogueGraphBuilder Builder;
+        FDialogueGraphBuilder::FNode& Start = Builder.AddNode(TEXT("start"));
+        Start.BaseLine = Line;
+        Start.NextNodeID = TEXT("end");
+        FDialogueGraphBuilder::FNode& End = Builder.AddNode(TEXT("end"));
+        End.BaseLine = TEXT("Bye.");
+        FDialogueGraphBuilder::FChoice& Choice = End.Choices.AddDefaulted_GetRef();
+        Choice.Text = TEXT("Leave.");
+        Choice.Requirements.Add(TEXT("trust >= 1"));
+        Choice.Effects.Add({ TEXT("trust"), EDialogueStateOp::Add, TEXT("1") });
+
+        TSharedRef<FDialogueGraph, ESPMode::ThreadSafe> Graph = MakeShared<FDialogueGraph, ESPMode::ThreadSafe>();
+        Graph->SourcePath = TEXT("DialogueRecordingTests");
+        Graph->Build(Builder);
+        return Graph;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueRecordingRoundTripTest, "Project.Dialogue.Recording.RoundTrip",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueRecordingRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueRecordingTests;
+
+    FDialogueRecording Saved = MakeRecording();
+    const TArray<uint8> Bytes = Save(Saved);
+
+    FDialogueRecording Loaded;
+    if (!TestTrue(TEXT("recording loads"), Load(Bytes, Loaded))) return false;
+
+    TestEqual(TEXT("graph path"), Loaded.GraphPath, Saved.GraphPath);
+    TestEqual(TEXT("graph hash"), Loaded.GraphHash, Saved.GraphHash);
+    TestEqual(TEXT("start node"), Loaded.StartNodeID, Saved.StartNodeID);
+    TestEqual(TEXT("locked choices flag"), Loaded.bShowLockedChoices, Saved.bShowLockedChoices);
+
+    if (TestEqual(TEXT("initial attributes"), Loaded.InitialState.Num(), Saved.InitialState.Num()))
+    {
+        for (int32 Index = 0; Index < Saved.InitialState.Num(); ++Index)
+        {
+            TestEqual(TEXT("attribute name"), Loaded.InitialState[Index].Key, Saved.InitialState[Index].Key);
+            TestTrue(TEXT("attribute value"), Loaded.InitialState[Index].Value == Saved.InitialState[Index].Value);
+        }
+    }
+    TestEqual(TEXT("initial state hash"),
+        FDialogueRecording::HashState(Loaded.MakeInitialState()), FDialogueRecording::HashState(Saved.MakeInitialState()));
+
+    if (TestEqual(TEXT("steps"), Loaded.Steps.Num(), Saved.Steps.Num()))
+    {
+        for (int32 Index = 0; Index < Saved.Steps.Num(); ++Index)
+        {
+            const FDialogueRecordedStep& Expected = Saved.Steps[Index];
+            const FDialogueRecordedStep& Actual = Loaded.Steps[Index];
+            TestTrue(TEXT("step input"), Actual.Input == Expected.Input);
+            TestEqual(TEXT("step choice"), Actual.ChoiceIndex, Expected.ChoiceIndex);
+            TestEqual(TEXT("step node"), Actual.NodeIndex, Expected.NodeIndex);
+            TestEqual(TEXT("step line hash"), Actual.LineHash, Expected.LineHash);
+            TestEqual(TEXT("step state hash"), Actual.StateHash, Expected.StateHash);
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueRecordingCorruptTest, "Project.Dialogue.Recording.Corrupt",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueRecordingCorruptTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueRecordingTests;
+
+    FDialogueRecording Saved = MakeRecording();
+    const TArray<uint8> Bytes = Save(Saved);
+
+    // Every cut-off file is rejected without reading past its end
+    for (int32 Length = 0; Length < Bytes.Num(); ++Length)
+    {
+        FDialogueRecording Loaded;
+        TestFalse(FString::Printf(TEXT("recording cut at %d of %d bytes is rejected"), Length, Bytes.Num()),
+            Load(TConstArrayView<uint8>(Bytes.GetData(), Length), Loaded));
+    }
+
+    TArray<uint8> WrongMagic = Bytes;
+    WrongMagic[0] ^= 0xFF;
+    FDialogueRecording Loaded;
+    TestFalse(TEXT("other files are rejected"), Load(WrongMagic, Loaded));
+
+    // A header claiming more attributes or steps than the file could hold must not be trusted
+    for (const bool bHugeSteps : { false, true })
+    {
+        TArray<uint8> Forged;
+        FMemoryWriter Writer(Forged);
+        uint32 Magic = 0x43455244;
+        uint32 Version = 1;
+        FString Path = Saved.GraphPath;
+        uint32 Hash = Saved.GraphHash;
+        FString StartNodeID = Saved.StartNodeID;
+        uint8 bLocked = 0;
+        uint32 NumAttributes = bHugeSteps ? 0 : 0x7FFFFFF0;
+        uint32 NumSteps = 0xFFFFFFF0;
+        Writer << Magic;
+        Writer.SerializeIntPacked(Version);
+        Writer << Path << Hash << StartNodeID << bLocked;
+        Writer.SerializeIntPacked(NumAttributes);
+        if (bHugeSteps)
+        {
+            Writer.SerializeIntPacked(NumSteps);
+        }
+        for (int32 Index = 0; Index < 64; ++Index)
+        {
+            uint8 Padding = 0;
+            Writer << Padding;
+        }
+
+        FDialogueRecording Forgery;
+        TestFalse(bHugeSteps ? TEXT("huge step count is rejected") : TEXT("huge attribute count is rejected"), Load(Forged, Forgery));
+        TestTrue(TEXT("nothing was allocated for the claimed entries"), Forgery.InitialState.Num() == 0 && Forgery.Steps.Num() == 0);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueRecordingHashTest, "Project.Dialogue.Recording.Hashes",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueRecordingHashTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueRecordingTests;
+
+    const int32 Trust = Slot(TEXT("trust"), EDialogueValueType::Int);
+    const int32 LastTopic = Slot(TEXT("last_topic"), EDialogueValueType::Name);
+
+    // Attributes set in another order (and so at other versions) hash the same
+    FDialogueState A;
+    A.Set(Trust, FDialogueValue::MakeInt(2));
+    A.Set(LastTopic, FDialogueValue::MakeName(TEXT("autonomy")));
+    FDialogueState B;
+    B.Set(LastTopic, FDialogueValue::MakeName(TEXT("autonomy")));
+    B.Set(Trust, FDialogueValue::MakeInt(1));
+    B.Set(Trust, FDialogueValue::MakeInt(2));
+    TestEqual(TEXT("state hash ignores order"), FDialogueRecording::HashState(A), FDialogueRecording::HashState(B));
+    B.Set(Trust, FDialogueValue::MakeInt(3));
+    TestNotEqual(TEXT("state hash sees values"), FDialogueRecording::HashState(A), FDialogueRecording::HashState(B));
+
+    // Builds of the same data agree whatever their ids; a changed line doesn't
+    const FDialogueGraphRef First = MakeGraph(TEXT("Hello."));
+    const FDialogueGraphRef Second = MakeGraph(TEXT("Hello."));
+    const FDialogueGraphRef Edited = MakeGraph(TEXT("Hello there."));
+    TestNotEqual(TEXT("each build has its own id"), First->GetId(), Second->GetId());
+    TestEqual(TEXT("content hash of the same data"), First->GetContentHash(), Second->GetContentHash());
+    TestNotEqual(TEXT("content hash of edited data"), First->GetContentHash(), Edited->GetContentHash());
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
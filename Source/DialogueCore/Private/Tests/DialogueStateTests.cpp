@@ -0,0 +1,167 @@
+#include "DialogueConditionCache.h"
+#include "DialogueGraph.h"
+#include "DialogueSession.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DialogueStateTests
+{
+    int32 Slot(const TCHAR* Name, EDialogueValueType Type)
+    {
+        return FDialogueAttributeRegistry::Get().FindOrAdd(FName(Name), Type);
+    }
+
+    // One node whose only choice requires "trust >= 1", so the graph has exactly that condition
+    FDialogueGraphRef MakeGraph()
+    {
+        FDialogueGraphBuilder Builder;
+        FDialogueGraphBuilder::FNode& Node = Builder.AddNode(TEXT("start"));
+        Node.Speaker = TEXT("Luka");
+        Node.BaseLine = TEXT("Trust is {trust}.");
+        FDialogueGraphBuilder::FChoice& Choice = Node.Choices.AddDefaulted_GetRef();
+        Choice.Text = TEXT("Go on.");
+        Choice.Requirements.Add(TEXT("trust >= 1"));
+
+        TSharedRef<FDialogueGraph, ESPMode::ThreadSafe> Graph = MakeShared<FDialogueGraph, ESPMode::ThreadSafe>();
+        Graph->SourcePath = TEXT("DialogueStateTests");
+        Graph->Build(Builder);
+        return Graph;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueStateVersionTest, "Project.Dialogue.State.Versions",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueStateVersionTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueStateTests;
+
+    const int32 Trust = Slot(TEXT("trust"), EDialogueValueType::Int);
+    const int32 LastTopic = Slot(TEXT("last_topic"), EDialogueValueType::Name);
+
+    FDialogueState State;
+    const uint32 Id = State.GetId();
+    const uint32 Start = State.GetVersion();
+
+    State.Set(Trust, FDialogueValue::MakeInt(2));
+    TestTrue(TEXT("a change bumps the version"), State.GetVersion() > Start);
+    TestEqual(TEXT("the changed slot records the version"), State.GetSlotVersion(Trust), State.GetVersion());
+    TestTrue(TEXT("an untouched slot stays older"), State.GetSlotVersion(LastTopic) < State.GetVersion());
+
+    const uint32 AfterSet = State.GetVersion();
+    State.Set(Trust, FDialogueValue::MakeInt(2));
+    TestEqual(TEXT("writing the same value is not a change"), State.GetVersion(), AfterSet);
+
+    State.Set(LastTopic, FDialogueValue::MakeName(TEXT("autonomy")));
+    State.Set(LastTopic, FDialogueValue::MakeName(TEXT("Autonomy")));
+    TestEqual(TEXT("a name differing only in case is not a change"), State.GetSlotVersion(LastTopic), State.GetVersion());
+
+    State.Reset();
+    TestEqual(TEXT("reset clears values"), State.GetInt(Trust), 0);
+    TestEqual(TEXT("reset counts as a change to every slot"), State.GetSlotVersion(LastTopic), State.GetVersion());
+    TestEqual(TEXT("Set and Reset keep the id"), State.GetId(), Id);
+
+    State.Set(Trust, FDialogueValue::MakeInt(3));
+    FDialogueState Copy(State);
+    TestNotEqual(TEXT("a copy gets its own id"), Copy.GetId(), State.GetId());
+    TestEqual(TEXT("a copy keeps the version"), Copy.GetVersion(), State.GetVersion());
+    TestEqual(TEXT("a copy keeps the values"), Copy.GetInt(Trust), 3);
+
+    FDialogueState Assigned;
+    const uint32 AssignedId = Assigned.GetId();
+    Assigned = State;
+    TestNotEqual(TEXT("assignment gives a new id"), Assigned.GetId(), AssignedId);
+    TestNotEqual(TEXT("assignment doesn't take the source's id"), Assigned.GetId(), State.GetId());
+
+    const uint32 CopyId = Copy.GetId();
+    FDialogueState Moved(MoveTemp(Copy));
+    TestNotEqual(TEXT("a moved-to state gets its own id"), Moved.GetId(), CopyId);
+    TestEqual(TEXT("a moved-to state keeps the values"), Moved.GetInt(Trust), 3);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueConditionCacheTest, "Project.Dialogue.State.ConditionCache",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueConditionCacheTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueStateTests;
+
+    const int32 Trust = Slot(TEXT("trust"), EDialogueValueType::Int);
+    const int32 LastTopic = Slot(TEXT("last_topic"), EDialogueValueType::Name);
+
+    const FDialogueGraphRef Graph = MakeGraph();
+    if (!TestEqual(TEXT("graph has one condition"), Graph->Conditions.Num(), 1)) return false;
+
+    FDialogueConditionCache Cache;
+    FDialogueState State;
+    State.Set(Trust, FDialogueValue::MakeInt(1));
+
+    TestTrue(TEXT("first evaluation"), Cache.Evaluate(*Graph, 0, State));
+    TestTrue(TEXT("second evaluation"), Cache.Evaluate(*Graph, 0, State));
+    TestEqual(TEXT("unchanged state is a hit"), Cache.GetNumHits(), 1);
+    TestEqual(TEXT("only the first evaluation ran"), Cache.GetNumMisses(), 1);
+
+    State.Set(LastTopic, FDialogueValue::MakeName(TEXT("autonomy")));
+    Cache.Evaluate(*Graph, 0, State);
+    TestEqual(TEXT("a slot the condition doesn't read keeps the result"), Cache.GetNumHits(), 2);
+
+    State.Set(Trust, FDialogueValue::MakeInt(0));
+    TestFalse(TEXT("a slot the condition reads reruns it"), Cache.Evaluate(*Graph, 0, State));
+    TestEqual(TEXT("rerun counted as a miss"), Cache.GetNumMisses(), 2);
+
+    // Same values and version, but results of one state say nothing about another
+    FDialogueState Copy(State);
+    Copy.Set(Trust, FDialogueValue::MakeInt(5));
+    State.Set(Trust, FDialogueValue::MakeInt(0));
+    TestTrue(TEXT("another state isn't served the first state's result"), Cache.Evaluate(*Graph, 0, Copy));
+    TestFalse(TEXT("switching back reruns as well"), Cache.Evaluate(*Graph, 0, State));
+    TestEqual(TEXT("each switch was a miss"), Cache.GetNumMisses(), 4);
+
+    // A rebuilt graph gets a new id even if it happens to reuse the old one's address
+    const FDialogueGraphRef Rebuilt = MakeGraph();
+    TestNotEqual(TEXT("rebuilt graph has its own id"), Rebuilt->GetId(), Graph->GetId());
+    Cache.Evaluate(*Rebuilt, 0, State);
+    TestEqual(TEXT("another graph is a miss"), Cache.GetNumMisses(), 5);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueSessionStateTest, "Project.Dialogue.State.Session",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueSessionStateTest::RunTest(const FString& Parameters)
+{
+    using namespace DialogueStateTests;
+
+    const int32 Trust = Slot(TEXT("trust"), EDialogueValueType::Int);
+
+    FDialogueSession Session;
+    Session.SetGraph(MakeGraph());
+    if (!TestTrue(TEXT("session starts"), Session.Start(TEXT("start")))) return false;
+
+    TestEqual(TEXT("line shows the state"), Session.GetLine(), FString(TEXT("Trust is 0.")));
+    TestEqual(TEXT("locked choice is hidden"), Session.GetChoices().Num(), 0);
+
+    Session.SetValue(Trust, FDialogueValue::MakeInt(1));
+    TestEqual(TEXT("line follows SetValue"), Session.GetLine(), FString(TEXT("Trust is 1.")));
+    TestEqual(TEXT("choices follow SetValue"), Session.GetChoices().Num(), 1);
+
+    // Two states that reach the same version along different paths: the session must not serve the
+    // results of one for the other
+    FDialogueState Locked(Session.GetState());
+    FDialogueState Unlocked(Session.GetState());
+    Locked.Set(Trust, FDialogueValue::MakeInt(0));
+    Unlocked.Set(Trust, FDialogueValue::MakeInt(7));
+    TestEqual(TEXT("both states are at the same version"), Locked.GetVersion(), Unlocked.GetVersion());
+
+    Session.SetState(Locked);
+    TestEqual(TEXT("line follows SetState"), Session.GetLine(), FString(TEXT("Trust is 0.")));
+    TestEqual(TEXT("choices follow SetState"), Session.GetChoices().Num(), 0);
+    Session.SetState(Unlocked);
+    TestEqual(TEXT("line follows a state at the same version"), Session.GetLine(), FString(TEXT("Trust is 7.")));
+    TestEqual(TEXT("choices follow a state at the same version"), Session.GetChoices().Num(), 1);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
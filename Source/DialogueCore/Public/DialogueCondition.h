@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueState.h"
+
+// Instruction kind of a compiled condition
+enum class EDialogueConditionOpCode : uint8
+{
+    Compare,    // evaluate one comparison
+    Or          // closes the current AND group
+};
+
+enum class EDialogueConditionCompare : uint8
+{
+    Equal,
+    NotEqual,
+    GreaterEqual,
+    LessEqual,
+    Greater,
+    Less,
+    IsTrue      // no comparator, e.g. "Clue_Cinema_MainDoor"
+};
+
+// One instruction of a compiled condition.
+// A program is a flat list of comparisons; consecutive comparisons are AND-ed and
+// an Or instruction separates the AND groups, so "a && b || c" becomes [a, b, Or, c].
+struct DIALOGUECORE_API FDialogueConditionOp
+{
+    EDialogueConditionOpCode Code = EDialogueConditionOpCode::Compare;
+    EDialogueConditionCompare Compare = EDialogueConditionCompare::IsTrue;
+
+    // Where to continue when this comparison fails: the next Or instruction or the end of the program
+    int32 SkipTo = 0;
+
+    // State slot read by the comparison, or INDEX_NONE for a bare true / false
+    int32 Slot = INDEX_NONE;
+
+    // Right-hand side, already typed for the comparison (Float if either side is a float)
+    FDialogueValue Literal;
+};
+
+// A condition string ("trust >= 1 && last_topic == \"autonomy\"") parsed once into a small program.
+// Attribute names are resolved to FDialogueAttributeRegistry slots while compiling.
+struct DIALOGUECORE_API FDialogueCondition
+{
+    TArray<FDialogueConditionOp> Ops;
+
+    // Compile() has run on this condition
+    bool bCompiled = false;
+
+    // Compile() succeeded; an invalid condition always evaluates to false
+    bool bValid = false;
+
+    bool IsCompiled() const { return bCompiled; }
+    bool IsValid() const { return bValid; }
+
+    // Parse Source into Ops. Returns false and fills OutError if Source is malformed.
+    bool Compile(const FString& Source, FString& OutError);
+
+    // Run the program against State. No allocations, no string work.
+    bool Evaluate(const FDialogueState& State) const;
+
+    // Run a program stored elsewhere (e.g. FDialogueGraph::ConditionOps). SkipTo is relative to Program.
+    static bool EvaluateOps(TConstArrayView<FDialogueConditionOp> Program, const FDialogueState& State);
+};
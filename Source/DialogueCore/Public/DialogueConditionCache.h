@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDialogueGraph;
+class FDialogueState;
+
+// Remembers condition results of one graph against one state.
+// A result is reused until one of the slots the condition reads changes (tracked through the
+// state's slot versions), so re-resolving a node whose inputs are unchanged runs no condition at all.
+// Results are tied to the graph and state they came from (by id), and dropped when either changes.
+class DIALOGUECORE_API FDialogueConditionCache
+{
+public:
+    bool Evaluate(const FDialogueGraph& Graph, int32 ConditionIndex, const FDialogueState& State);
+
+    // Forget every result
+    void Reset();
+
+    int32 GetNumHits() const { return NumHits; }
+    int32 GetNumMisses() const { return NumMisses; }
+
+private:
+    struct FEntry
+    {
+        // State version the result was computed at, 0 if never computed
+        uint32 Version = 0;
+        bool bResult = false;
+    };
+
+    // FDialogueGraph::GetId and FDialogueState::GetId Entries belong to
+    uint32 GraphId = 0;
+    uint32 StateId = 0;
+    TArray<FEntry> Entries;
+
+    int32 NumHits = 0;
+    int32 NumMisses = 0;
+};
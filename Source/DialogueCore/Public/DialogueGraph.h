@@ -0,0 +1,308 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueCondition.h"
+#include "DialogueState.h"
+
+class FDialogueConditionCache;
+
+// Span of entries in one of the graph's flat arrays
+struct FDialogueRange
+{
+    int32 First = 0;
+    int32 Num = 0;
+
+    int32 End() const { return First + Num; }
+};
+
+// Span of ops in FDialogueGraph::ConditionOps. First == INDEX_NONE means the condition
+// was malformed and never passes.
+struct FDialogueGraphCondition
+{
+    int32 First = INDEX_NONE;
+    int32 Num = 0;
+
+    // State slots the condition reads, as a span of FDialogueGraph::ConditionReads
+    FDialogueRange Reads;
+};
+
+// Alt line, append line or choice alt text
+struct FDialogueGraphLine
+{
+    // Index into Conditions
+    int32 Condition = INDEX_NONE;
+
+    // Index into the string pool
+    int32 Text = 0;
+};
+
+// Piece of a line template. Lines may embed "{attribute}", "{condition?shown if true:shown otherwise}"
+// and "{speaker}"; "{{" and "}}" are literal braces. Templates are split into segments when the graph is built.
+enum class EDialogueTextSegment : uint8
+{
+    Literal,    // Text
+    Value,      // value of state slot Index
+    Select,     // Text if condition Index passes, AltText otherwise
+    Speaker     // speaker of the node being shown
+};
+
+struct FDialogueTextSegment
+{
+    EDialogueTextSegment Kind = EDialogueTextSegment::Literal;
+
+    // Indices into the string pool
+    int32 Text = 0;
+    int32 AltText = 0;
+
+    // Slot for Value, index into Conditions for Select. A Value of an attribute nothing had typed when
+    // the graph was built has no slot; Text then holds its name and the slot is looked up when shown.
+    int32 Index = INDEX_NONE;
+};
+
+struct FDialogueGraphChoice
+{
+    int32 Text = 0;
+
+    // Lines, first match replaces Text
+    FDialogueRange AltTexts;
+
+    // Conditions, all must pass
+    FDialogueRange Requirements;
+
+    // Effects, applied in order
+    FDialogueRange Effects;
+
+    // Links: node indices, INDEX_NONE ends the dialogue, lower values are cross-file links
+    int32 Next = INDEX_NONE;
+    int32 Failure = INDEX_NONE;
+};
+
+struct FDialogueGraphNode
+{
+    int32 Id = 0;
+    int32 Speaker = 0;
+    int32 BaseLine = 0;
+
+    // Lines
+    FDialogueRange AltLines;
+    FDialogueRange AppendLines;
+
+    // Choices
+    FDialogueRange Choices;
+
+    // Link like FDialogueGraphChoice::Next
+    int32 Next = INDEX_NONE;
+
+    // Index into NodeMedia, INDEX_NONE if the node has no media
+    int32 Media = INDEX_NONE;
+};
+
+// Voice-over, portrait and montage of a node as pooled object paths; empty for none.
+// The game turns them into soft references (see UDialogueDataLoader::GetNodeAssets).
+struct FDialogueGraphMedia
+{
+    int32 VoiceOver = 0;
+    int32 Portrait = 0;
+    int32 Montage = 0;
+};
+
+// Target of a link written "file:node" in data, resolved when a conversation follows it
+struct FDialogueExternalLink
+{
+    // Pooled relative path under Content, e.g. "Dialogues/luka_session_02.json"
+    int32 File = 0;
+
+    // Pooled node id in that file
+    int32 Node = 0;
+};
+
+// A choice of some node as shown to the player
+struct FDialogueResolvedChoice
+{
+    // Index among the node's authored choices
+    int32 ChoiceIndex = INDEX_NONE;
+
+    // Pooled string of the text with alt texts applied; may be a template, render it with AppendText
+    int32 Text = 0;
+
+    // Requirements failed; only listed when locked choices are requested
+    bool bLocked = false;
+};
+
+// Authored dialogue in plain C++, the input of FDialogueGraph::Build. Fill it node by node;
+// links name nodes by id, or "file:node" for a node in another file.
+class DIALOGUECORE_API FDialogueGraphBuilder
+{
+public:
+    struct FLine
+    {
+        FString Condition;
+        FString Text;
+    };
+
+    struct FEffect
+    {
+        FString Attribute;
+        EDialogueStateOp Op = EDialogueStateOp::Set;
+        FString Value;
+    };
+
+    struct FChoice
+    {
+        FString Text;
+        TArray<FLine> AltTexts;
+        TArray<FString> Requirements;
+        TArray<FEffect> Effects;
+        FString NextNodeID;
+        FString FailureNodeID;
+    };
+
+    struct FNode
+    {
+        FString ID;
+        FString Speaker;
+        FString BaseLine;
+        TArray<FLine> AltLines;
+        TArray<FLine> AppendLines;
+        TArray<FChoice> Choices;
+        FString NextNodeID;
+
+        // Object paths, e.g. "/Game/Audio/VO_Luka_01.VO_Luka_01"
+        FString VoiceOver;
+        FString Portrait;
+        FString Montage;
+    };
+
+    void Reserve(int32 NumNodes) { Nodes.Reserve(NumNodes); }
+
+    // Nodes keep the order they are added in as their index in the graph
+    FNode& AddNode(FString ID)
+    {
+        FNode& Node = Nodes.AddDefaulted_GetRef();
+        Node.ID = MoveTemp(ID);
+        return Node;
+    }
+
+    TConstArrayView<FNode> GetNodes() const { return Nodes; }
+
+private:
+    TArray<FNode> Nodes;
+};
+
+// Dialogue data loaded from one file. Immutable once built and shared by every
+// trigger and manager that uses the file (see UDialogueGraphSubsystem).
+//
+// Nodes, choices, lines, conditions and effects each live in one contiguous array and refer to
+// each other by index; node links are resolved when the graph is built. All text is stored once
+// in a deduplicated string pool. String node ids are only kept for lookups from outside
+// (trigger starting nodes, Blueprint, logs).
+struct DIALOGUECORE_API FDialogueGraph
+{
+    // Relative path under Content, e.g. "Dialogues/luka_session_01.json"
+    FString SourcePath;
+
+    TArray<FDialogueGraphNode> Nodes;
+    TArray<FDialogueGraphChoice> Choices;
+    TArray<FDialogueGraphLine> Lines;
+    TArray<FDialogueGraphCondition> Conditions;
+    TArray<FDialogueConditionOp> ConditionOps;
+    TArray<int32> ConditionReads;
+    TArray<FDialogueCompiledEffect> Effects;
+    TArray<FDialogueGraphMedia> NodeMedia;
+    TArray<FDialogueTextSegment> TextSegments;
+    TArray<FDialogueExternalLink> ExternalLinks;
+
+    // Build from authored nodes: compile conditions and effects, resolve node links and pool strings.
+    // Problems are logged against SourcePath; returns how many conditions, effects or links were dropped.
+    int32 Build(const FDialogueGraphBuilder& Source);
+
+    int32 NumNodes() const { return Nodes.Num(); }
+
+    // Unique to each Build in this process, so a reloaded file never shares one with the graph it
+    // replaces. Caches key on this rather than the graph's address, which a later graph may reuse.
+    uint32 GetId() const { return Id; }
+
+    // Node index for a string id, INDEX_NONE if there is none
+    int32 FindNodeIndex(const FString& NodeID) const;
+
+    const FDialogueGraphNode* GetNode(int32 NodeIndex) const { return Nodes.IsValidIndex(NodeIndex) ? &Nodes[NodeIndex] : nullptr; }
+
+    // Link values below INDEX_NONE point into ExternalLinks
+    static bool IsExternalLink(int32 Link) { return Link < INDEX_NONE; }
+    const FDialogueExternalLink& GetExternalLink(int32 Link) const { return ExternalLinks[INDEX_NONE - 1 - Link]; }
+
+    // "file:node" for a cross-file link, the node id otherwise; empty for INDEX_NONE
+    FString GetLinkId(int32 Link) const;
+
+    // Pooled string by index. Null-terminated, valid for the graph's lifetime.
+    FStringView GetString(int32 StringIndex) const
+    {
+        return FStringView(StringData.GetData() + StringOffsets[StringIndex], StringOffsets[StringIndex + 1] - StringOffsets[StringIndex] - 1);
+    }
+
+    FStringView GetNodeId(int32 NodeIndex) const { return GetString(Nodes[NodeIndex].Id); }
+
+    // Media of a node, nullptr if it has none
+    const FDialogueGraphMedia* GetNodeMedia(int32 NodeIndex) const
+    {
+        const int32 MediaIndex = Nodes.IsValidIndex(NodeIndex) ? Nodes[NodeIndex].Media : INDEX_NONE;
+        return MediaIndex != INDEX_NONE ? &NodeMedia[MediaIndex] : nullptr;
+    }
+
+    // Run a condition against State. With a Cache, a result is reused until a slot it reads changes.
+    bool EvaluateCondition(int32 ConditionIndex, const FDialogueState& State, FDialogueConditionCache* Cache = nullptr) const;
+
+    // True if every requirement of the choice passes
+    bool IsChoiceUnlocked(const FDialogueGraphChoice& Choice, const FDialogueState& State, FDialogueConditionCache* Cache = nullptr) const;
+
+    // Base line with the first passing alt line substituted and passing append lines added.
+    // Rendered on the stack, so the returned string is the only allocation.
+    FString ResolveLine(const FDialogueGraphNode& Node, const FDialogueState& State, FDialogueConditionCache* Cache = nullptr) const;
+
+    // Same as ResolveLine, appended to Out
+    void AppendLine(const FDialogueGraphNode& Node, const FDialogueState& State, FStringBuilderBase& Out, FDialogueConditionCache* Cache = nullptr) const;
+
+    // Append a pooled string to Out with its template fields filled in. Speaker is the pooled speaker of the node shown.
+    void AppendText(int32 StringIndex, int32 Speaker, const FDialogueState& State, FStringBuilderBase& Out, FDialogueConditionCache* Cache = nullptr) const;
+
+    // Pooled string of the choice text with the first passing alt text substituted
+    int32 ResolveChoiceText(const FDialogueGraphChoice& Choice, const FDialogueState& State, FDialogueConditionCache* Cache = nullptr) const;
+
+    // Fill Out with the node's unlocked choices, plus its locked ones if bIncludeLocked.
+    // Out is reset without freeing, so a reused buffer doesn't allocate once it has grown.
+    void ResolveChoices(const FDialogueGraphNode& Node, const FDialogueState& State, bool bIncludeLocked,
+        TArray<FDialogueResolvedChoice>& Out, FDialogueConditionCache* Cache = nullptr) const;
+
+    void ApplyEffects(const FDialogueGraphChoice& Choice, FDialogueState& State) const;
+
+    // Bytes held by the flat arrays and string pool
+    SIZE_T GetAllocatedSize() const;
+
+    // Hash of everything a node shows and does: text, compiled conditions and effects, media and
+    // link targets by id. Comparable across graphs, so a rebuilt file can be diffed node by node.
+    uint32 HashNode(int32 NodeIndex) const;
+
+    // Hash of the whole graph that every process building the same nodes in the same order agrees on;
+    // attributes are hashed by name rather than slot. Tells whether a recording was made against this
+    // version of a file. A graph reloaded in place keeps its previous node order, so it can hash
+    // differently from a fresh load of the same file.
+    uint32 GetContentHash() const;
+
+private:
+    // 0 until built
+    uint32 Id = 0;
+
+    // Characters of every pooled string, each followed by a terminator
+    TArray<TCHAR> StringData;
+
+    // Start of each string in StringData, plus one past the end of the last
+    TArray<int32> StringOffsets;
+
+    // Segments of each pooled string in TextSegments; Num is 0 unless the string is a line template
+    TArray<FDialogueRange> StringTemplates;
+
+    TMap<FString, int32> NodeIndexById;
+};
+
+// Reference-counted handle to a loaded graph. The graph is freed when the last handle is released.
+using FDialogueGraphRef = TSharedPtr<const FDialogueGraph, ESPMode::ThreadSafe>;
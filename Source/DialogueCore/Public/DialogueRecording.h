@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueState.h"
+
+// What the player did at a recorded step
+enum class EDialogueRecordedInput : uint8
+{
+    Start,          // StartDialogue
+    SelectChoice,   // SelectChoice(ChoiceIndex)
+    Advance         // AdvanceDialogue
+};
+
+// One input and what the manager showed once it was handled, to verify a replay against
+struct FDialogueRecordedStep
+{
+    EDialogueRecordedInput Input = EDialogueRecordedInput::Start;
+    int32 ChoiceIndex = INDEX_NONE;
+
+    // Node index afterwards (INDEX_NONE once the dialogue ended), and hashes of the resolved line and the state
+    int32 NodeIndex = INDEX_NONE;
+    uint32 LineHash = 0;
+    uint32 StateHash = 0;
+};
+
+// One conversation as recorded by UDialogueManager (bRecordDialogues): the graph it ran on, the
+// state it started from and every input, each with a checksum of the outcome. Replaying the inputs
+// on the same graph and state must reproduce every checksum (see the DialogueReplay commandlet).
+//
+// Stored as a compact binary file: attributes by name, numbers packed, a few bytes per step.
+struct DIALOGUECORE_API FDialogueRecording
+{
+    // SourcePath and content hash of the graph the conversation started in
+    FString GraphPath;
+    uint32 GraphHash = 0;
+
+    FString StartNodeID;
+
+    // Choice indices count locked choices too when this was set
+    bool bShowLockedChoices = false;
+
+    // Every set attribute of the state the conversation started with
+    TArray<TPair<FName, FDialogueValue>> InitialState;
+
+    TArray<FDialogueRecordedStep> Steps;
+
+    void SetInitialState(const FDialogueState& State);
+
+    // InitialState resolved against this process's attribute registry
+    FDialogueState MakeInitialState() const;
+
+    // Order-independent hash of the set attributes by name, comparable across processes
+    static uint32 HashState(const FDialogueState& State);
+    static uint32 HashLine(const FString& Line) { return FCrc::StrCrc32(*Line); }
+
+    // Returns false if the archive isn't a recording, is of a newer version, or is truncated or corrupt
+    bool Serialize(FArchive& Ar);
+
+    bool SaveToFile(const FString& FilePath) const;
+    bool LoadFromFile(const FString& FilePath);
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueGraph.h"
+#include "DialogueConditionCache.h"
+
+class FDialogueSpeculation;
+
+/**
+ * One conversation on a graph: the current node, the state it runs against and the line and
+ * choices resolved for it. Needs no world or UObject, so tools, servers and worker threads can
+ * step dialogue directly; UDialogueManager wraps one for gameplay (UI events, replication,
+ * recording, streaming in linked files).
+ *
+ * Resolved text and choices are cached per node and state version, and conditions through a
+ * FDialogueConditionCache, so reading the same step again costs nothing.
+ */
+class DIALOGUECORE_API FDialogueSession
+{
+public:
+    const FDialogueGraphRef& GetGraph() const { return Graph; }
+
+    // Switch graph. Node indices and cached results are per graph, so the session ends and has no node.
+    void SetGraph(FDialogueGraphRef InGraph);
+
+    const FDialogueState& GetState() const { return State; }
+
+    // Store Value in Slot of the state. Shows in the next resolve.
+    void SetValue(int32 Slot, const FDialogueValue& Value) { State.Set(Slot, Value); }
+
+    // Replace the whole state, e.g. with the start state of a recording. Drops every cached result.
+    void SetState(const FDialogueState& InState);
+
+    // Enter the node with the given id; false if the graph has no such node
+    bool Start(const FString& NodeID);
+
+    // Make NodeIndex current. An index that isn't a node of the graph ends the session.
+    void EnterNode(int32 NodeIndex);
+
+    // Leave the conversation. The last node stays readable.
+    void End() { bActive = false; }
+
+    // Between entering a node and the end of the conversation
+    bool IsActive() const { return bActive; }
+
+    int32 GetNodeIndex() const { return NodeIndex; }
+
+    // Current node, nullptr if there is none
+    const FDialogueGraphNode* GetNode() const { return Graph ? Graph->GetNode(NodeIndex) : nullptr; }
+
+    // Speaker of the current node, empty if there is none
+    FString GetSpeaker() const;
+
+    // Line of the current node with alt and append lines applied. Resolved once per node and state.
+    const FString& GetLine() const;
+
+    // Choices of the current node in display order, with locked ones when bIncludeLocked.
+    // Resolved once per node and state; the view is valid until the node, graph or state changes.
+    TConstArrayView<FDialogueResolvedChoice> GetChoices(bool bIncludeLocked = false) const;
+
+    // Authored choice of the current node behind a resolved one
+    const FDialogueGraphChoice& GetAuthoredChoice(const FDialogueResolvedChoice& Choice) const;
+
+    // Append the text of a resolved choice of the current node to Out, with its template fields filled in
+    void AppendChoiceText(const FDialogueResolvedChoice& Choice, FStringBuilderBase& Out) const;
+
+    // Apply the effects of a resolved choice of the current node and return the link it leads to.
+    // A locked choice changes nothing and leads to its failure link. The session doesn't move;
+    // follow the link with Follow, or load the other file for a cross-file link.
+    int32 TakeChoice(const FDialogueResolvedChoice& Choice);
+
+    // Enter the node Link points to, or end the conversation for INDEX_NONE. Cross-file links need
+    // the other file: the session stays where it is and returns false.
+    bool Follow(int32 Link);
+
+    // Take choice ChoiceIndex of GetChoices(bIncludeLocked) and follow it. Returns false if there is
+    // no such choice, it is locked without a failure link (the session stays on the node) or it leads
+    // into another file (see TakeChoice for doing that by hand).
+    bool SelectChoice(int32 ChoiceIndex, bool bIncludeLocked = false);
+
+    // Continue from a node without choices. Returns false if the node has choices, there is no node
+    // or the next node is in another file.
+    bool Advance();
+
+    // Take the branch of a ready speculation for authored choice ChoiceIndex (INDEX_NONE for the
+    // node's Next link, bFailure for a locked choice's failure link): apply the choice's effects and
+    // keep the line and choices resolved for the node it enters, so entering it resolves nothing.
+    // Returns that node, or INDEX_NONE with nothing changed if the speculation wasn't made for this
+    // graph, node and state as they are now, or has no such branch. The session doesn't move; follow
+    // up with EnterNode.
+    int32 AdoptSpeculated(FDialogueSpeculation& Speculation, int32 ChoiceIndex, bool bFailure, bool bIncludeLocked);
+
+    // Conditions the session ran on a cache miss since it was created
+    int32 GetNumConditionsEvaluated() const { return ConditionCache.GetNumMisses(); }
+
+private:
+    // What ResolvedLine / ResolvedChoices were computed for
+    struct FResolvedKey
+    {
+        uint32 GraphId = 0;
+        int32 NodeIndex = INDEX_NONE;
+        uint32 StateId = 0;
+        uint32 StateVersion = 0;
+        bool bShowLocked = false;
+
+        bool operator==(const FResolvedKey& Other) const
+        {
+            return GraphId == Other.GraphId && NodeIndex == Other.NodeIndex && StateId == Other.StateId && StateVersion == Other.StateVersion && bShowLocked == Other.bShowLocked;
+        }
+    };
+
+    // Forget every cached condition result and resolved step
+    void ResetResolved();
+
+    FDialogueGraphRef Graph;
+    FDialogueState State;
+
+    int32 NodeIndex = INDEX_NONE;
+    bool bActive = false;
+
+    // Condition results for Graph against State; filled lazily by the const getters
+    mutable FDialogueConditionCache ConditionCache;
+
+    mutable FString ResolvedLine;
+    mutable FResolvedKey ResolvedLineKey;
+
+    mutable TArray<FDialogueResolvedChoice> ResolvedChoices;
+    mutable FResolvedKey ResolvedChoicesKey;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueGraph.h"
+#include <atomic>
+
+// One way out of a node, resolved ahead of time
+struct FDialogueSpeculativeBranch
+{
+    // Authored choice index within the node, INDEX_NONE for the node's own Next link
+    int32 ChoiceIndex = INDEX_NONE;
+
+    // Reached through the choice's failure link because it was locked
+    bool bFailure = false;
+
+    // Node entered
+    int32 NodeIndex = INDEX_NONE;
+
+    // State after the choice's effects, which the entered node was resolved against
+    FDialogueState State;
+
+    // The entered node resolved against State
+    FString Line;
+    TArray<FDialogueResolvedChoice> Choices;
+};
+
+// Successors of one node, resolved on the thread pool against a snapshot of the state while the
+// player is still reading the node. A result only applies while the graph, node, state version and
+// locked-choice setting it was made for are all still current; anything else is simply dropped.
+class DIALOGUECORE_API FDialogueSpeculation
+{
+public:
+    // Start resolving every successor of NodeIndex. Graph is kept alive until the work is done.
+    static TSharedRef<FDialogueSpeculation, ESPMode::ThreadSafe> Launch(FDialogueGraphRef Graph, int32 NodeIndex,
+        const FDialogueState& State, bool bIncludeLocked);
+
+    // True once the worker has filled every branch
+    bool IsReady() const { return bReady.load(std::memory_order_acquire); }
+
+    // Let the worker stop early; nobody will read the result
+    void Cancel() { bCancelled.store(true, std::memory_order_relaxed); }
+
+    // Made for this graph and node and this very state, unchanged since
+    bool Matches(const FDialogueGraph* InGraph, int32 InNodeIndex, const FDialogueState& State, bool bInIncludeLocked) const;
+
+    // Ready branch for an authored choice (INDEX_NONE for the node's Next link), nullptr if that
+    // branch wasn't resolved. The caller may move out of it; see FDialogueSession::AdoptSpeculated.
+    FDialogueSpeculativeBranch* FindBranch(int32 ChoiceIndex, bool bFailure);
+
+private:
+    FDialogueSpeculation() = default;
+
+    void Run();
+
+    FDialogueGraphRef Graph;
+    int32 NodeIndex = INDEX_NONE;
+    FDialogueState BaseState;
+    bool bIncludeLocked = false;
+
+    // Id and version of the state BaseState was copied from; BaseState itself has an id of its own
+    uint32 SourceStateId = 0;
+    uint32 SourceStateVersion = 0;
+
+    // Written by the worker, read by the game thread once bReady is set
+    TArray<FDialogueSpeculativeBranch> Branches;
+
+    std::atomic<bool> bReady { false };
+    std::atomic<bool> bCancelled { false };
+};
+
+using FDialogueSpeculationRef = TSharedPtr<FDialogueSpeculation, ESPMode::ThreadSafe>;
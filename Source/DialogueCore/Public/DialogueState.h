@@ -0,0 +1,176 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Type of a dialogue attribute. Fixed by its declaration (see FDialogueAttributeRegistry::Declare),
+// or the first time an attribute name is seen if nothing is declared.
+enum class EDialogueValueType : uint8
+{
+    None,   // unset
+    Int,
+    Float,
+    Bool,
+    Name    // string-like values such as last_topic, compared case-insensitively
+};
+
+// What an effect does to its attribute (mirrors EDialogueEffectOp without the reflection dependency)
+enum class EDialogueStateOp : uint8
+{
+    Add,
+    Set,
+    Toggle
+};
+
+// A typed value stored in a dialogue state slot. Bools are stored in Int.
+struct DIALOGUECORE_API FDialogueValue
+{
+    EDialogueValueType Type = EDialogueValueType::None;
+    int32 Int = 0;
+    float Float = 0.f;
+    FName Name;
+
+    static FDialogueValue MakeInt(int32 Value);
+    static FDialogueValue MakeFloat(float Value);
+    static FDialogueValue MakeBool(bool bValue);
+    static FDialogueValue MakeName(FName Value);
+
+    bool operator==(const FDialogueValue& Other) const;
+    bool operator!=(const FDialogueValue& Other) const { return !(*this == Other); }
+
+    FString ToString() const;
+
+    // Parse text written for an attribute of the given type ("3", "0.5", "true", "autonomy").
+    // Decimal text is not a valid Int.
+    static bool Parse(const FString& Text, EDialogueValueType Type, FDialogueValue& OutValue);
+
+    // Guess the type of a literal written in dialogue data
+    static EDialogueValueType InferType(const FString& Text, bool bQuoted);
+
+    static const TCHAR* TypeToString(EDialogueValueType Type);
+};
+
+// Process-wide table that maps attribute names to dense slot indices.
+// Names are resolved once when dialogue data is compiled; at runtime states are indexed by slot only.
+// Thread-safe, since dialogue files may be compiled off the game thread.
+//
+// Attributes are declared with their types in [DialogueAttributes] of the Game config, read when the
+// module starts. Once anything is declared, only declared names can be used, so a misspelled
+// attribute in data is an error rather than a new slot with whatever type it was first used as.
+class DIALOGUECORE_API FDialogueAttributeRegistry
+{
+public:
+    static FDialogueAttributeRegistry& Get();
+
+    // Declare Name with a fixed type. A Name ending in '*' declares every attribute starting with the
+    // rest, e.g. "skill.*". Returns false if Name is already declared or registered with another type.
+    bool Declare(const FString& Name, EDialogueValueType Type);
+
+    // Declare every "name:type" entry of Attributes in [DialogueAttributes] of ConfigFile; bad entries are logged
+    void LoadDeclarations(const FString& ConfigFile);
+
+    // True once anything is declared
+    bool HasDeclarations() const;
+
+    // Slot for Name, registered with Type if new. Returns INDEX_NONE if Name is registered or declared
+    // with a type Type can't be stored in (Int and Float are interchangeable), or if attributes are
+    // declared and Name isn't one of them. DescribeRejection tells which.
+    int32 FindOrAdd(FName Name, EDialogueValueType Type);
+
+    // Why FindOrAdd(Name, Type) returned INDEX_NONE, for error messages
+    FString DescribeRejection(FName Name, EDialogueValueType Type) const;
+
+    // Slot for Name, or INDEX_NONE if it was never registered
+    int32 Find(FName Name) const;
+
+    // Registered type of Name, else the type a declaration gives it, else None
+    EDialogueValueType FindType(FName Name) const;
+
+    EDialogueValueType GetType(int32 Slot) const;
+    FName GetName(int32 Slot) const;
+    int32 Num() const;
+
+private:
+    FDialogueAttributeRegistry();
+
+    // Declared type of an unregistered Name from the prefix declarations, None if no prefix matches.
+    // Caller holds Lock.
+    EDialogueValueType FindPrefixType(FName Name) const;
+
+    mutable FRWLock Lock;
+    TMap<FName, int32> SlotsByName;
+    TArray<FName> Names;
+    TArray<EDialogueValueType> Types;
+
+    // Names declared one by one are registered right away; prefixes are kept until a name uses them
+    TArray<TPair<FString, EDialogueValueType>> DeclaredPrefixes;
+    bool bDeclared = false;
+};
+
+// An effect compiled against the registry, applied without any string work
+struct DIALOGUECORE_API FDialogueCompiledEffect
+{
+    int32 Slot = INDEX_NONE;
+    EDialogueStateOp Op = EDialogueStateOp::Set;
+    FDialogueValue Value;
+
+    bool IsValid() const { return Slot != INDEX_NONE; }
+
+    // Resolve Attribute to a slot and parse Value for its type. Returns false and fills OutError on failure.
+    bool Compile(const FString& Attribute, EDialogueStateOp InOp, const FString& InValue, FString& OutError);
+};
+
+// Blackboard of dialogue attributes: one contiguous array of values indexed by registry slot.
+// Unset slots read as 0 / false / None.
+//
+// Every change bumps a state-wide version, and each slot remembers the version it last changed at,
+// so cached condition results can tell whether anything they read has changed (see FDialogueConditionCache).
+// Versions are only comparable within one state: a copy starts from the same numbers, so every
+// construction and assignment also gets a new id, and anything keyed on a version checks the id too.
+class DIALOGUECORE_API FDialogueState
+{
+public:
+    FDialogueState();
+    FDialogueState(const FDialogueState& Other);
+    FDialogueState(FDialogueState&& Other);
+    FDialogueState& operator=(const FDialogueState& Other);
+    FDialogueState& operator=(FDialogueState&& Other);
+
+    int32 GetInt(int32 Slot) const;
+    float GetFloat(int32 Slot) const;
+    bool GetBool(int32 Slot) const { return GetInt(Slot) != 0; }
+    FName GetName(int32 Slot) const { return Values.IsValidIndex(Slot) ? Values[Slot].Name : NAME_None; }
+    const FDialogueValue* GetValue(int32 Slot) const { return Values.IsValidIndex(Slot) ? &Values[Slot] : nullptr; }
+
+    // Store Value in Slot. Compiled effects already carry values typed for their slot.
+    // Writing the value a slot already holds is not a change and keeps its version.
+    void Set(int32 Slot, const FDialogueValue& Value);
+
+    void ApplyEffect(const FDialogueCompiledEffect& Effect);
+
+    void Reset();
+
+    const TArray<FDialogueValue>& GetValues() const { return Values; }
+
+    // Incremented by every change
+    uint32 GetVersion() const { return Version; }
+
+    // Unique to this state since it was constructed or last assigned; Set and Reset keep it
+    uint32 GetId() const { return Id; }
+
+    // Version at which Slot last changed
+    uint32 GetSlotVersion(int32 Slot) const
+    {
+        return FMath::Max(SlotVersions.IsValidIndex(Slot) ? SlotVersions[Slot] : 0u, ResetVersion);
+    }
+
+private:
+    TArray<FDialogueValue> Values;
+    TArray<uint32> SlotVersions;
+
+    uint32 Version = 1;
+
+    // Version of the last Reset(), which counts as a change to every slot
+    uint32 ResetVersion = 0;
+
+    uint32 Id = 0;
+};
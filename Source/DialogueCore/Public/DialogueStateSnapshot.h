@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueState.h"
+#include <atomic>
+
+// Publishes immutable copies of a dialogue state for readers on other threads.
+//
+// The owner (one writer, normally the game thread) keeps mutating its own FDialogueState and calls
+// Publish after changes; each call makes a copy current with a single atomic pointer swap. Readers
+// on any thread open an FDialogueStateReadScope and see one consistent snapshot for as long as the
+// scope lives, without taking a lock.
+//
+// Replaced snapshots are reclaimed by epoch: a reader registers in the current epoch before it loads
+// the snapshot pointer, and the writer only moves the epoch on once no reader is left in the epoch
+// before it. A snapshot retired two epochs ago can't be seen by anyone and is recycled for a later
+// Publish, so steady-state publishing doesn't allocate.
+//
+// Hold the publisher through a shared reference from worker tasks so it outlives their reads.
+class DIALOGUECORE_API FDialogueStatePublisher
+{
+public:
+    FDialogueStatePublisher();
+    ~FDialogueStatePublisher();
+
+    FDialogueStatePublisher(const FDialogueStatePublisher&) = delete;
+    FDialogueStatePublisher& operator=(const FDialogueStatePublisher&) = delete;
+
+    // Writer only. Copy State into a new current snapshot, unless that same state was last published
+    // and hasn't changed since.
+    void Publish(const FDialogueState& State);
+
+    // Writer only. Version of the state last published.
+    uint32 GetPublishedVersion() const;
+
+private:
+    friend class FDialogueStateReadScope;
+
+    struct FSnapshot
+    {
+        FDialogueState State;
+
+        // Epoch in which the snapshot stopped being current
+        uint64 RetiredEpoch = 0;
+    };
+
+    // Writer only. Advance the epoch if possible and recycle snapshots nobody can see any more.
+    void Reclaim();
+
+    std::atomic<FSnapshot*> Current { nullptr };
+    std::atomic<uint64> Epoch { 0 };
+
+    // Readers registered in even and odd epochs
+    mutable std::atomic<int32> Readers[2];
+
+    // Writer only
+    TArray<FSnapshot*> Retired;
+    TArray<FSnapshot*> Free;
+
+    // Writer only. Id and version of the state the current snapshot was copied from; the snapshot
+    // has an id of its own, and a replaced state may come back with the same version.
+    uint32 PublishedStateId = 0;
+    uint32 PublishedStateVersion = 0;
+};
+
+// Consistent read-only view of the latest published state, usable from any thread.
+// Keep scopes short: a long-lived scope holds back reclamation of every later snapshot.
+class DIALOGUECORE_API FDialogueStateReadScope
+{
+public:
+    explicit FDialogueStateReadScope(const FDialogueStatePublisher& InPublisher);
+    ~FDialogueStateReadScope();
+
+    FDialogueStateReadScope(const FDialogueStateReadScope&) = delete;
+    FDialogueStateReadScope& operator=(const FDialogueStateReadScope&) = delete;
+
+    const FDialogueState& Get() const { return *State; }
+    const FDialogueState* operator->() const { return State; }
+
+private:
+    const FDialogueStatePublisher& Publisher;
+    const FDialogueState* State = nullptr;
+    uint32 Parity = 0;
+};
+
+using FDialogueStatePublisherRef = TSharedRef<FDialogueStatePublisher, ESPMode::ThreadSafe>;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+// Everything the dialogue system logs. Compiled out of shipping builds.
+#if UE_BUILD_SHIPPING
+DIALOGUECORE_API DECLARE_LOG_CATEGORY_EXTERN(LogDialogue, Log, NoLogging);
+#else
+DIALOGUECORE_API DECLARE_LOG_CATEGORY_EXTERN(LogDialogue, Log, All);
+#endif
+
+// "stat Dialogue" in the console
+DECLARE_STATS_GROUP(TEXT("Dialogue"), STATGROUP_Dialogue, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load graph"), STAT_DialogueLoad, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse JSON"), STAT_DialogueParse, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Evaluate conditions"), STAT_DialogueConditions, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve line"), STAT_DialogueResolveLine, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve choices"), STAT_DialogueResolveChoices, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update UI"), STAT_DialogueUpdateUI, STATGROUP_Dialogue, DIALOGUECORE_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Conditions evaluated"), STAT_DialogueConditionsEvaluated, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes loaded"), STAT_DialogueNodesLoaded, STATGROUP_Dialogue, DIALOGUECORE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Resident chapters"), STAT_DialogueResidentMemory, STATGROUP_Dialogue, DIALOGUECORE_API);
+
+// "-csvCategories=Dialogue": ConditionsPerStep (conditions the dialogue manager ran to resolve its steps in a frame)
+// and NodesLoaded
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(DIALOGUECORE_API, Dialogue);
+
+// Insights channel for dialogue scopes and bookmarks ("-trace=default,Dialogue")
+UE_TRACE_CHANNEL_EXTERN(DialogueChannel, DIALOGUECORE_API);
+
+// Cycle stat plus a scope of the same name on DialogueChannel
+#define DIALOGUE_SCOPE_CYCLE_COUNTER(Stat) \
+    SCOPE_CYCLE_COUNTER(Stat); \
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, DialogueChannel)
@@ -0,0 +1,138 @@
+#include "DialogueAssetPrefetcher.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "AssetRegistry/AssetData.h"
+
+void FDialogueAssetPrefetcher::Update(const FDialogueGraph& Graph, int32 NodeIndex)
+{
+    // Breadth-first, so each node is reached at its shortest distance
+    Walk.Reset();
+    if (Graph.GetNode(NodeIndex))
+    {
+        TBitArray<> Visited(false, Graph.NumNodes());
+        Visited[NodeIndex] = true;
+        Walk.Emplace(NodeIndex, 0);
+
+        for (int32 Cursor = 0; Cursor < Walk.Num(); ++Cursor)
+        {
+            const int32 Hops = Walk[Cursor].Value;
+            if (Hops >= MaxHops) continue;
+
+            auto Visit = [&](int32 Target)
+            {
+                // Cross-file links are prefetched once the conversation moves to that file
+                if (Target >= 0 && !Visited[Target])
+                {
+                    Visited[Target] = true;
+                    Walk.Emplace(Target, Hops + 1);
+                }
+            };
+
+            const FDialogueGraphNode& Node = Graph.Nodes[Walk[Cursor].Key];
+            Visit(Node.Next);
+            for (int32 Index = Node.Choices.First; Index < Node.Choices.End(); ++Index)
+            {
+                Visit(Graph.Choices[Index].Next);
+                Visit(Graph.Choices[Index].Failure);
+            }
+        }
+    }
+
+    Wanted.Reset();
+    for (const TPair<int32, int32>& Step : Walk)
+    {
+        if (const FDialogueGraphMedia* Media = Graph.GetNodeMedia(Step.Key))
+        {
+            for (const int32 Path : { Media->VoiceOver, Media->Portrait, Media->Montage })
+            {
+                if (!Graph.GetString(Path).IsEmpty()) Wanted.Emplace(FSoftObjectPath(FString(Graph.GetString(Path))), Step.Value);
+            }
+        }
+    }
+
+    // Nearest assets claim the budget first; the current node's are always kept.
+    // Requests still in flight count with their estimated size until they are measured.
+    const uint32 Stamp = NextStamp++;
+    FStreamableManager& Streamable = UAssetManager::GetStreamableManager();
+    int64 UsedBytes = 0;
+    for (const TPair<FSoftObjectPath, int32>& Asset : Wanted)
+    {
+        const bool bFits = Asset.Value == 0 || UsedBytes < BudgetBytes;
+        FEntry* Entry = Entries.Find(Asset.Key);
+        if (Entry && Entry->Stamp == Stamp) continue; // shared by a nearer node
+        if (!bFits) continue;
+
+        if (!Entry)
+        {
+            Entry = &Entries.Add(Asset.Key);
+            Entry->EstimatedBytes = EstimateBytes(Asset.Key);
+            Entry->Handle = Streamable.RequestAsyncLoad(Asset.Key, FStreamableDelegate(),
+                FStreamableManager::AsyncLoadHighPriority - Asset.Value, false, false, TEXT("DialoguePrefetch"));
+        }
+        Entry->Stamp = Stamp;
+
+        if (Entry->Bytes == INDEX_NONE && Entry->Handle.IsValid() && Entry->Handle->HasLoadCompleted())
+        {
+            const UObject* Loaded = Entry->Handle->GetLoadedAsset();
+            Entry->Bytes = Loaded ? Loaded->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal) : 0;
+        }
+        UsedBytes += Entry->Bytes != INDEX_NONE ? Entry->Bytes : Entry->EstimatedBytes;
+    }
+
+    // Out of the window or over the budget
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It->Value.Stamp != Stamp)
+        {
+            Release(It->Value);
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void FDialogueAssetPrefetcher::Reset()
+{
+    for (TPair<FSoftObjectPath, FEntry>& Pair : Entries)
+    {
+        Release(Pair.Value);
+    }
+    Entries.Reset();
+}
+
+int64 FDialogueAssetPrefetcher::GetLoadedBytes() const
+{
+    int64 Bytes = 0;
+    for (const TPair<FSoftObjectPath, FEntry>& Pair : Entries)
+    {
+        Bytes += FMath::Max<int64>(Pair.Value.Bytes, 0);
+    }
+    return Bytes;
+}
+
+int64 FDialogueAssetPrefetcher::EstimateBytes(const FSoftObjectPath& Path)
+{
+    // Voice-over and portraits are rarely smaller than this; better to hold back a request than overshoot
+    constexpr int64 UnknownBytes = 1024 * 1024;
+
+    const IAssetRegistry* Registry = IAssetRegistry::Get();
+    if (!Registry) return UnknownBytes;
+
+    const TOptional<FAssetPackageData> PackageData = Registry->GetAssetPackageDataCopy(Path.GetLongPackageFName());
+    return PackageData.IsSet() && PackageData->DiskSize > 0 ? PackageData->DiskSize : UnknownBytes;
+}
+
+void FDialogueAssetPrefetcher::Release(FEntry& Entry)
+{
+    if (!Entry.Handle.IsValid()) return;
+
+    if (Entry.Handle->IsLoadingInProgress())
+    {
+        Entry.Handle->CancelHandle();
+    }
+    else
+    {
+        Entry.Handle->ReleaseHandle();
+    }
+    Entry.Handle.Reset();
+}
@@ -0,0 +1,224 @@
+#include "DialogueCrowdSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueStats.h"
+
+UDialogueCrowdSubsystem* UDialogueCrowdSubsystem::Get(const UObject* WorldContextObject)
+{
+    const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UDialogueCrowdSubsystem>() : nullptr;
+}
+
+bool UDialogueCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDialogueCrowdSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(&InWorld))
+    {
+        GraphReloadedHandle = GraphSubsystem->OnGraphReloaded.AddUObject(this, &UDialogueCrowdSubsystem::HandleGraphReloaded);
+    }
+}
+
+void UDialogueCrowdSubsystem::Deinitialize()
+{
+    if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(GetWorld()))
+    {
+        GraphSubsystem->OnGraphReloaded.Remove(GraphReloadedHandle);
+    }
+    GraphReloadedHandle.Reset();
+
+    Conversations.Empty();
+    FreeSlots.Empty();
+    NumActive = 0;
+    Super::Deinitialize();
+}
+
+TStatId UDialogueCrowdSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UDialogueCrowdSubsystem, STATGROUP_Tickables);
+}
+
+FDialogueConversationHandle UDialogueCrowdSubsystem::Start(FDialogueGraphRef Graph, const FString& NodeID, const FDialogueState* InitialState, int32 Seed)
+{
+    const int32 NodeIndex = Graph ? Graph->FindNodeIndex(NodeID) : INDEX_NONE;
+    if (NodeIndex == INDEX_NONE)
+    {
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueCrowdSubsystem: node '%s' not found."), *NodeID);
+        return FDialogueConversationHandle();
+    }
+
+    const int32 Index = FreeSlots.Num() > 0 ? FreeSlots.Pop(false) : Conversations.AddDefaulted();
+    FDialogueConversation& Conversation = Conversations[Index];
+    Conversation.Graph = MoveTemp(Graph);
+    if (InitialState)
+    {
+        Conversation.State = *InitialState;
+    }
+    else
+    {
+        Conversation.State.Reset();
+    }
+    Conversation.Random.Initialize(Seed ? Seed : Index + 1);
+    Conversation.bActive = true;
+    Conversation.bEnded = false;
+    Enter(Conversation, NodeIndex);
+    ++NumActive;
+
+    return FDialogueConversationHandle{ Index, Conversation.Serial };
+}
+
+void UDialogueCrowdSubsystem::Stop(FDialogueConversationHandle Handle)
+{
+    if (Find(Handle))
+    {
+        Release(Handle.Index);
+    }
+}
+
+const FDialogueConversation* UDialogueCrowdSubsystem::Find(FDialogueConversationHandle Handle) const
+{
+    if (!Conversations.IsValidIndex(Handle.Index)) return nullptr;
+
+    const FDialogueConversation& Conversation = Conversations[Handle.Index];
+    return Conversation.bActive && Conversation.Serial == Handle.Serial ? &Conversation : nullptr;
+}
+
+FString UDialogueCrowdSubsystem::GetLine(FDialogueConversationHandle Handle) const
+{
+    const FDialogueConversation* Conversation = Find(Handle);
+    const FDialogueGraphNode* Node = Conversation ? Conversation->Graph->GetNode(Conversation->NodeIndex) : nullptr;
+    return Node ? Conversation->Graph->ResolveLine(*Node, Conversation->State) : FString();
+}
+
+FString UDialogueCrowdSubsystem::GetSpeaker(FDialogueConversationHandle Handle) const
+{
+    const FDialogueConversation* Conversation = Find(Handle);
+    const FDialogueGraphNode* Node = Conversation ? Conversation->Graph->GetNode(Conversation->NodeIndex) : nullptr;
+    return Node ? FString(Conversation->Graph->GetString(Node->Speaker)) : FString();
+}
+
+void UDialogueCrowdSubsystem::Release(int32 Index)
+{
+    FDialogueConversation& Conversation = Conversations[Index];
+    Conversation.Graph.Reset();
+    Conversation.NodeIndex = INDEX_NONE;
+    Conversation.bActive = false;
+    ++Conversation.Serial;
+    FreeSlots.Add(Index);
+    --NumActive;
+}
+
+void UDialogueCrowdSubsystem::HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph)
+{
+    for (int32 Index = 0; Index < Conversations.Num(); ++Index)
+    {
+        FDialogueConversation& Conversation = Conversations[Index];
+        if (!Conversation.bActive || Conversation.Graph != OldGraph || Conversation.NodeIndex == INDEX_NONE) continue;
+
+        // Conversations whose node was removed just stop
+        const int32 NodeIndex = NewGraph->FindNodeIndex(FString(OldGraph->GetNodeId(Conversation.NodeIndex)));
+        if (NodeIndex == INDEX_NONE)
+        {
+            Release(Index);
+            continue;
+        }
+        Conversation.Graph = NewGraph;
+        Conversation.NodeIndex = NodeIndex;
+    }
+}
+
+void UDialogueCrowdSubsystem::Enter(FDialogueConversation& Conversation, int32 NodeIndex) const
+{
+    const FDialogueGraphNode* Node = Conversation.Graph->GetNode(NodeIndex);
+    if (!Node)
+    {
+        Conversation.NodeIndex = INDEX_NONE;
+        Conversation.bEnded = true;
+        return;
+    }
+
+    Conversation.NodeIndex = NodeIndex;
+    Conversation.TimeLeft = LineSeconds + SecondsPerCharacter * Conversation.Graph->GetString(Node->BaseLine).Len();
+}
+
+int32 UDialogueCrowdSubsystem::ChooseNext(FDialogueConversation& Conversation) const
+{
+    const FDialogueGraph& Graph = *Conversation.Graph;
+    const FDialogueGraphNode& Node = Graph.Nodes[Conversation.NodeIndex];
+    if (Node.Choices.Num == 0)
+    {
+        return Node.Next;
+    }
+
+    // Uniform pick among unlocked choices in one pass, without building a list
+    const FDialogueGraphChoice* Picked = nullptr;
+    int32 NumUnlocked = 0;
+    for (int32 Index = Node.Choices.First; Index < Node.Choices.End(); ++Index)
+    {
+        const FDialogueGraphChoice& Choice = Graph.Choices[Index];
+        if (Graph.IsChoiceUnlocked(Choice, Conversation.State) && Conversation.Random.RandHelper(++NumUnlocked) == 0)
+        {
+            Picked = &Choice;
+        }
+    }
+    if (!Picked) return INDEX_NONE;
+
+    Graph.ApplyEffects(*Picked, Conversation.State);
+    return Picked->Next;
+}
+
+void UDialogueCrowdSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Each task collects its own events; no locks and no shared writes while stepping. The lists are
+    // ours rather than ParallelForWithTaskContext's, which would construct fresh ones every tick.
+    const int32 BatchSize = FMath::Max(MinBatchSize, 1);
+    const int32 NumTasks = ParallelForImpl::GetNumberOfThreadTasks(Conversations.Num(), BatchSize, EParallelForFlags::None);
+    if (TaskEvents.Num() < NumTasks)
+    {
+        TaskEvents.SetNum(NumTasks);
+    }
+    for (TArray<FDialogueCrowdEvent>& Batch : TaskEvents)
+    {
+        Batch.Reset();
+    }
+
+    ParallelForWithExistingTaskContext(MakeArrayView(TaskEvents.GetData(), NumTasks), Conversations.Num(), BatchSize,
+        [this, DeltaTime](TArray<FDialogueCrowdEvent>& OutEvents, int32 Index)
+        {
+            FDialogueConversation& Conversation = Conversations[Index];
+            if (!Conversation.bActive || Conversation.bEnded) return;
+
+            Conversation.TimeLeft -= DeltaTime;
+            if (Conversation.TimeLeft > 0.f) return;
+
+            Enter(Conversation, ChooseNext(Conversation));
+            OutEvents.Add(FDialogueCrowdEvent{ FDialogueConversationHandle{ Index, Conversation.Serial }, Conversation.Graph.Get(), Conversation.NodeIndex });
+        });
+
+    Events.Reset();
+    for (TArray<FDialogueCrowdEvent>& Batch : TaskEvents)
+    {
+        Events.Append(Batch);
+    }
+    if (Events.Num() == 0) return;
+
+    OnEvents.Broadcast(Events);
+
+    // Ended conversations keep their graph until the batch has been handled. Handlers may have
+    // stopped (and even restarted) slots already; the serial tells.
+    for (const FDialogueCrowdEvent& Event : Events)
+    {
+        if (Event.HasEnded() && Find(Event.Handle))
+        {
+            Release(Event.Handle.Index);
+        }
+    }
+}
@@ -1,50 +1,354 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "DialogueDataLoader.h"
+#include "DialogueStats.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 #include "Serialization/JsonReader.h"
-#include "Serialization/JsonSerializer.h"
-#include "JsonObjectConverter.h"
+
+namespace
+{
+	// Walks the reader's tokens and writes straight into FDialogueNodes, without building a JSON tree.
+	// Field names match case-insensitively, like the reflection-based converter did. A syntax error
+	// stops the parse; a value of the wrong type is reported and skipped.
+	class FDialogueJsonParser
+	{
+	public:
+		FDialogueJsonParser(const TSharedRef<TJsonReader<>>& InReader, const FString& InPath)
+			: Reader(InReader)
+			, Path(InPath)
+		{
+		}
+
+		bool Parse(TMap<FString, FDialogueNode>& OutNodes)
+		{
+			EJsonNotation Notation;
+			if (!Next(Notation)) return false;
+			if (Notation != EJsonNotation::ObjectStart)
+			{
+				Report(ELogVerbosity::Error, TEXT("expected an object of nodes"));
+				return false;
+			}
+
+			return ReadObject([this, &OutNodes](const FString& NodeID, EJsonNotation NodeNotation)
+			{
+				if (NodeNotation != EJsonNotation::ObjectStart)
+				{
+					Report(ELogVerbosity::Warning, *FString::Printf(TEXT("'%s' is not a node object, skipped"), *NodeID));
+					return Skip(NodeNotation);
+				}
+
+				if (OutNodes.Contains(NodeID))
+				{
+					Report(ELogVerbosity::Warning, *FString::Printf(TEXT("node '%s' is defined twice, the last one wins"), *NodeID));
+				}
+
+				// The id always comes from the key
+				FDialogueNode& Node = OutNodes.Add(NodeID);
+				Node.ID = NodeID;
+				return ReadNode(Node);
+			});
+		}
+
+	private:
+		bool ReadNode(FDialogueNode& Node)
+		{
+			return ReadObject([this, &Node](const FString& Key, EJsonNotation Notation)
+			{
+				if (Key == TEXT("Speaker"))     return ReadString(Notation, Node.Speaker);
+				if (Key == TEXT("BaseLine"))    return ReadString(Notation, Node.BaseLine);
+				if (Key == TEXT("AltLines"))    return ReadObjectArray(Notation, Node.AltLines, [this](FDialogueAltLine& Line) { return ReadLine(Line); });
+				if (Key == TEXT("AppendLines")) return ReadObjectArray(Notation, Node.AppendLines, [this](FDialogueAltLine& Line) { return ReadLine(Line); });
+				if (Key == TEXT("Choices"))     return ReadObjectArray(Notation, Node.Choices, [this](FDialogueChoice& Choice) { return ReadChoice(Choice); });
+				if (Key == TEXT("NextNodeID"))  return ReadString(Notation, Node.NextNodeID);
+				if (Key == TEXT("Assets"))      return ReadAssets(Notation, Node.Assets);
+				return Skip(Notation);
+			});
+		}
+
+		template<typename LineType>
+		bool ReadLine(LineType& Line)
+		{
+			return ReadObject([this, &Line](const FString& Key, EJsonNotation Notation)
+			{
+				if (Key == TEXT("Condition")) return ReadString(Notation, Line.Condition);
+				if (Key == TEXT("Text"))      return ReadString(Notation, Line.Text);
+				return Skip(Notation);
+			});
+		}
+
+		bool ReadChoice(FDialogueChoice& Choice)
+		{
+			return ReadObject([this, &Choice](const FString& Key, EJsonNotation Notation)
+			{
+				if (Key == TEXT("Text"))          return ReadString(Notation, Choice.Text);
+				if (Key == TEXT("AltTexts"))      return ReadObjectArray(Notation, Choice.AltTexts, [this](FDialogueAltText& Line) { return ReadLine(Line); });
+				if (Key == TEXT("Requirements"))  return ReadStringArray(Notation, Choice.Requirements);
+				if (Key == TEXT("Effects"))       return ReadObjectArray(Notation, Choice.Effects, [this](FDialogueEffect& Effect) { return ReadEffect(Effect); });
+				if (Key == TEXT("NextNodeID"))    return ReadString(Notation, Choice.NextNodeID);
+				if (Key == TEXT("FailureNodeID")) return ReadString(Notation, Choice.FailureNodeID);
+				return Skip(Notation);
+			});
+		}
+
+		bool ReadEffect(FDialogueEffect& Effect)
+		{
+			return ReadObject([this, &Effect](const FString& Key, EJsonNotation Notation)
+			{
+				if (Key == TEXT("Attribute")) return ReadString(Notation, Effect.Attribute);
+				if (Key == TEXT("Value"))     return ReadString(Notation, Effect.Value);
+				if (Key == TEXT("Operation"))
+				{
+					FString Operation;
+					if (!ReadString(Notation, Operation)) return false;
+
+					const int64 Value = StaticEnum<EDialogueEffectOp>()->GetValueByNameString(Operation);
+					if (Value == INDEX_NONE)
+					{
+						Report(ELogVerbosity::Warning, *FString::Printf(TEXT("unknown effect operation '%s', using Set"), *Operation));
+						return true;
+					}
+					Effect.Operation = static_cast<EDialogueEffectOp>(Value);
+					return true;
+				}
+				return Skip(Notation);
+			});
+		}
+
+		bool ReadAssets(EJsonNotation Notation, FDialogueNodeAssets& Assets)
+		{
+			if (Notation != EJsonNotation::ObjectStart) return Mismatch(Notation, TEXT("an object"));
+
+			return ReadObject([this, &Assets](const FString& Key, EJsonNotation AssetNotation)
+			{
+				if (Key == TEXT("VoiceOver")) return ReadSoftObject(AssetNotation, Assets.VoiceOver);
+				if (Key == TEXT("Portrait"))  return ReadSoftObject(AssetNotation, Assets.Portrait);
+				if (Key == TEXT("Montage"))   return ReadSoftObject(AssetNotation, Assets.Montage);
+				return Skip(AssetNotation);
+			});
+		}
+
+		template<typename ObjectType>
+		bool ReadSoftObject(EJsonNotation Notation, TSoftObjectPtr<ObjectType>& Out)
+		{
+			FString ObjectPath;
+			if (!ReadString(Notation, ObjectPath)) return false;
+			Out = TSoftObjectPtr<ObjectType>(FSoftObjectPath(ObjectPath));
+			return true;
+		}
+
+		// Scalars convert to text the way the reflection-based converter did
+		bool ReadString(EJsonNotation Notation, FString& Out)
+		{
+			switch (Notation)
+			{
+			case EJsonNotation::String:  Out = Reader->GetValueAsString(); return true;
+			case EJsonNotation::Number:  Out = Reader->GetValueAsNumberString(); return true;
+			case EJsonNotation::Boolean: Out = Reader->GetValueAsBoolean() ? TEXT("true") : TEXT("false"); return true;
+			case EJsonNotation::Null:    Out.Reset(); return true;
+			default:                     return Mismatch(Notation, TEXT("a string"));
+			}
+		}
+
+		bool ReadStringArray(EJsonNotation Notation, TArray<FString>& Out)
+		{
+			if (Notation != EJsonNotation::ArrayStart) return Mismatch(Notation, TEXT("an array"));
+
+			return ReadArray([this, &Out](EJsonNotation ElementNotation)
+			{
+				return ReadString(ElementNotation, Out.AddDefaulted_GetRef());
+			});
+		}
+
+		template<typename ElementType, typename ReadElementFunc>
+		bool ReadObjectArray(EJsonNotation Notation, TArray<ElementType>& Out, ReadElementFunc&& ReadElement)
+		{
+			if (Notation != EJsonNotation::ArrayStart) return Mismatch(Notation, TEXT("an array"));
+
+			return ReadArray([this, &Out, &ReadElement](EJsonNotation ElementNotation)
+			{
+				if (ElementNotation != EJsonNotation::ObjectStart) return Mismatch(ElementNotation, TEXT("an object"));
+				return ReadElement(Out.AddDefaulted_GetRef());
+			});
+		}
+
+		// Call Field(key, notation) for every member until the object closes. Field consumes the value.
+		template<typename FieldFunc>
+		bool ReadObject(FieldFunc&& Field)
+		{
+			EJsonNotation Notation;
+			while (Next(Notation))
+			{
+				if (Notation == EJsonNotation::ObjectEnd) return true;
+				if (!Field(Reader->GetIdentifier(), Notation)) return false;
+			}
+			return false;
+		}
+
+		template<typename ElementFunc>
+		bool ReadArray(ElementFunc&& Element)
+		{
+			EJsonNotation Notation;
+			while (Next(Notation))
+			{
+				if (Notation == EJsonNotation::ArrayEnd) return true;
+				if (!Element(Notation)) return false;
+			}
+			return false;
+		}
+
+		// Consume the rest of a value whose first token was Notation
+		bool Skip(EJsonNotation Notation)
+		{
+			int32 Depth = Notation == EJsonNotation::ObjectStart || Notation == EJsonNotation::ArrayStart ? 1 : 0;
+			while (Depth > 0 && Next(Notation))
+			{
+				if (Notation == EJsonNotation::ObjectStart || Notation == EJsonNotation::ArrayStart) ++Depth;
+				else if (Notation == EJsonNotation::ObjectEnd || Notation == EJsonNotation::ArrayEnd) --Depth;
+			}
+			return Depth == 0;
+		}
+
+		// Wrong type: report it and skip the value. Null stands for "not set" and is accepted anywhere.
+		bool Mismatch(EJsonNotation Notation, const TCHAR* Expected)
+		{
+			if (Notation != EJsonNotation::Null)
+			{
+				const FString& Key = Reader->GetIdentifier();
+				Report(ELogVerbosity::Warning, Key.IsEmpty()
+					? *FString::Printf(TEXT("expected %s, ignored"), Expected)
+					: *FString::Printf(TEXT("'%s' should be %s, ignored"), *Key, Expected));
+			}
+			return Skip(Notation);
+		}
+
+		bool Next(EJsonNotation& Notation)
+		{
+			if (Reader->ReadNext(Notation) && Notation != EJsonNotation::Error) return true;
+
+			const FString& Message = Reader->GetErrorMessage();
+			Report(ELogVerbosity::Error, Message.IsEmpty() ? TEXT("unexpected end of file") : *Message);
+			return false;
+		}
+
+		void Report(ELogVerbosity::Type Verbosity, const TCHAR* Message) const
+		{
+			if (Verbosity == ELogVerbosity::Error)
+			{
+				UE_LOG(LogDialogue, Error, TEXT("%s(%u:%u): %s"), *Path, Reader->GetLineNumber(), Reader->GetCharacterNumber(), Message);
+			}
+			else
+			{
+				UE_LOG(LogDialogue, Warning, TEXT("%s(%u:%u): %s"), *Path, Reader->GetLineNumber(), Reader->GetCharacterNumber(), Message);
+			}
+		}
+
+		TSharedRef<TJsonReader<>> Reader;
+		const FString& Path;
+	};
+}
 
 bool UDialogueDataLoader::LoadDialogueFromFile(const FString& RelativePath, TMap<FString, FDialogueNode>& OutNodes)
 {
-	const FString FullPath = FPaths::ProjectContentDir() / RelativePath;
+	return ParseDialogueFile(RelativePath, OutNodes);
+}
+
+bool UDialogueDataLoader::ParseDialogueFile(const FString& RelativePath, TMap<FString, FDialogueNode>& OutNodes)
+{
+	return ParseDialogueFileAtPath(FPaths::ProjectContentDir() / RelativePath, OutNodes);
+}
+
+bool UDialogueDataLoader::ParseDialogueFileAtPath(const FString& FullPath, TMap<FString, FDialogueNode>& OutNodes)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueParse);
+
 	FString JsonStr;
 	if (!FFileHelper::LoadFileToString(JsonStr, *FullPath))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to load dialogue JSON: %s"), *FullPath);
+		UE_LOG(LogDialogue, Error, TEXT("Failed to load dialogue JSON: %s"), *FullPath);
 		return false;
 	}
 
-	TSharedPtr<FJsonObject> RootObj;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonStr);
-	if (!FJsonSerializer::Deserialize(Reader, RootObj) || !RootObj.IsValid())
+	// The reader works on a view of the text; the text is the only copy of the file in memory
+	OutNodes.Empty();
+	FDialogueJsonParser Parser(TJsonReaderFactory<>::CreateFromView(JsonStr), FullPath);
+	if (!Parser.Parse(OutNodes))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to parse JSON in file: %s"), *FullPath);
+		UE_LOG(LogDialogue, Error, TEXT("Failed to parse JSON in file: %s"), *FullPath);
+		OutNodes.Empty();
 		return false;
 	}
 
-	OutNodes.Empty();
-	for (const auto& Pair : RootObj->Values)
-	{
-		const FString NodeID = Pair.Key;
-		TSharedPtr<FJsonObject> NodeObj = Pair.Value->AsObject();
-		if (!NodeObj.IsValid()) continue;
+	UE_LOG(LogDialogue, Log, TEXT("Loaded %d dialogue nodes from %s"), OutNodes.Num(), *FullPath);
+	return true;
+}
 
-		NodeObj->SetStringField(TEXT("ID"), NodeID);
+EDialogueStateOp UDialogueDataLoader::ToStateOp(EDialogueEffectOp Op)
+{
+	switch (Op)
+	{
+	case EDialogueEffectOp::Add:    return EDialogueStateOp::Add;
+	case EDialogueEffectOp::Toggle: return EDialogueStateOp::Toggle;
+	default:                        return EDialogueStateOp::Set;
+	}
+}
 
-		FDialogueNode NodeStruct;
-		if (FJsonObjectConverter::JsonObjectToUStruct<FDialogueNode>(NodeObj.ToSharedRef(), &NodeStruct, 0, 0))
+int32 UDialogueDataLoader::BuildGraph(TArray<FDialogueNode>&& Nodes, FDialogueGraph& Graph)
+{
+	auto MoveLines = [](auto& Authored, TArray<FDialogueGraphBuilder::FLine>& Out)
+	{
+		Out.Reserve(Authored.Num());
+		for (auto& Line : Authored)
 		{
-			OutNodes.Add(NodeID, MoveTemp(NodeStruct));
+			Out.Add({ MoveTemp(Line.Condition), MoveTemp(Line.Text) });
 		}
-		else
+	};
+
+	FDialogueGraphBuilder Builder;
+	Builder.Reserve(Nodes.Num());
+	for (FDialogueNode& Node : Nodes)
+	{
+		FDialogueGraphBuilder::FNode& Built = Builder.AddNode(MoveTemp(Node.ID));
+		Built.Speaker = MoveTemp(Node.Speaker);
+		Built.BaseLine = MoveTemp(Node.BaseLine);
+		MoveLines(Node.AltLines, Built.AltLines);
+		MoveLines(Node.AppendLines, Built.AppendLines);
+		Built.NextNodeID = MoveTemp(Node.NextNodeID);
+		Built.VoiceOver = Node.Assets.VoiceOver.ToString();
+		Built.Portrait = Node.Assets.Portrait.ToString();
+		Built.Montage = Node.Assets.Montage.ToString();
+
+		Built.Choices.Reserve(Node.Choices.Num());
+		for (FDialogueChoice& Choice : Node.Choices)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("Failed to convert node: %s"), *NodeID);
+			FDialogueGraphBuilder::FChoice& BuiltChoice = Built.Choices.AddDefaulted_GetRef();
+			BuiltChoice.Text = MoveTemp(Choice.Text);
+			MoveLines(Choice.AltTexts, BuiltChoice.AltTexts);
+			BuiltChoice.Requirements = MoveTemp(Choice.Requirements);
+			BuiltChoice.Effects.Reserve(Choice.Effects.Num());
+			for (FDialogueEffect& Effect : Choice.Effects)
+			{
+				BuiltChoice.Effects.Add({ MoveTemp(Effect.Attribute), ToStateOp(Effect.Operation), MoveTemp(Effect.Value) });
+			}
+			BuiltChoice.NextNodeID = MoveTemp(Choice.NextNodeID);
+			BuiltChoice.FailureNodeID = MoveTemp(Choice.FailureNodeID);
 		}
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("Loaded %d dialogue nodes from %s"), OutNodes.Num(), *FullPath);
-	return true;
+	// What's left of the nodes is empty shells; free them before the graph is compiled
+	Nodes.Empty();
+	return Graph.Build(Builder);
+}
+
+FDialogueNodeAssets UDialogueDataLoader::GetNodeAssets(const FDialogueGraph& Graph, int32 NodeIndex)
+{
+	FDialogueNodeAssets Assets;
+	if (const FDialogueGraphMedia* Media = Graph.GetNodeMedia(NodeIndex))
+	{
+		auto ToPath = [&Graph](int32 StringIndex) { return FSoftObjectPath(FString(Graph.GetString(StringIndex))); };
+		Assets.VoiceOver = TSoftObjectPtr<USoundBase>(ToPath(Media->VoiceOver));
+		Assets.Portrait = TSoftObjectPtr<UTexture2D>(ToPath(Media->Portrait));
+		Assets.Montage = TSoftObjectPtr<UAnimMontage>(ToPath(Media->Montage));
+	}
+	return Assets;
 }
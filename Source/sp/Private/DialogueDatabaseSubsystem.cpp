@@ -0,0 +1,302 @@
+#include "DialogueDatabaseSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "DialogueManager.h"
+#include "DialogueStats.h"
+#include "DialogueTriggerComponent.h"
+
+UDialogueDatabaseSubsystem* UDialogueDatabaseSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UDialogueDatabaseSubsystem>() : nullptr;
+}
+
+bool UDialogueDatabaseSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDialogueDatabaseSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ChapterStates.SetNum(Chapters.Num());
+	for (int32 ChapterIndex = 0; ChapterIndex < Chapters.Num(); ++ChapterIndex)
+	{
+		for (const FString& File : Chapters[ChapterIndex].Files)
+		{
+			const FString Key = UDialogueGraphSubsystem::NormalizePath(File);
+			if (const int32* Existing = ChapterByFile.Find(Key))
+			{
+				UE_LOG(LogDialogue, Warning, TEXT("DialogueDatabase: %s is listed in chapters %s and %s, keeping the first"),
+					*File, *Chapters[*Existing].Name.ToString(), *Chapters[ChapterIndex].Name.ToString());
+				continue;
+			}
+			ChapterByFile.Add(Key, ChapterIndex);
+		}
+	}
+
+	if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
+	{
+		GraphReloadedHandle = GraphSubsystem->OnGraphReloaded.AddUObject(this, &UDialogueDatabaseSubsystem::HandleGraphReloaded);
+	}
+}
+
+void UDialogueDatabaseSubsystem::Deinitialize()
+{
+	if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
+	{
+		GraphSubsystem->OnGraphReloaded.Remove(GraphReloadedHandle);
+		for (FChapterState& State : ChapterStates)
+		{
+			GraphSubsystem->CancelLoad(State.LoadHandle);
+		}
+	}
+	GraphReloadedHandle.Reset();
+	ChapterStates.Empty();
+	ChapterByFile.Empty();
+	Triggers.Empty();
+	SET_MEMORY_STAT(STAT_DialogueResidentMemory, 0);
+	Super::Deinitialize();
+}
+
+TStatId UDialogueDatabaseSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDialogueDatabaseSubsystem, STATGROUP_Tickables);
+}
+
+int32 UDialogueDatabaseSubsystem::FindChapter(const FString& RelativePath) const
+{
+	if (ChapterByFile.Num() == 0) return INDEX_NONE;
+	const int32* Found = ChapterByFile.Find(UDialogueGraphSubsystem::NormalizePath(RelativePath));
+	return Found ? *Found : INDEX_NONE;
+}
+
+void UDialogueDatabaseSubsystem::RegisterTrigger(UDialogueTriggerComponent* Trigger)
+{
+	if (!Trigger) return;
+	Triggers.AddUnique(Trigger);
+
+	// A trigger spawned next to the player shouldn't wait a full interval for its chapter
+	TimeSinceUpdate = UpdateInterval;
+}
+
+void UDialogueDatabaseSubsystem::UnregisterTrigger(UDialogueTriggerComponent* Trigger)
+{
+	Triggers.RemoveSwap(Trigger);
+}
+
+void UDialogueDatabaseSubsystem::RequestChapter(FName Chapter)
+{
+	const int32 ChapterIndex = Chapters.IndexOfByPredicate([Chapter](const FDialogueChapter& Entry) { return Entry.Name == Chapter; });
+	if (ChapterIndex == INDEX_NONE)
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("DialogueDatabase: no chapter named %s"), *Chapter.ToString());
+		return;
+	}
+
+	MarkWanted(ChapterIndex);
+	PageIn(ChapterIndex);
+}
+
+bool UDialogueDatabaseSubsystem::IsChapterResident(FName Chapter) const
+{
+	const int32 ChapterIndex = Chapters.IndexOfByPredicate([Chapter](const FDialogueChapter& Entry) { return Entry.Name == Chapter; });
+	return ChapterStates.IsValidIndex(ChapterIndex) && ChapterStates[ChapterIndex].IsResident();
+}
+
+int64 UDialogueDatabaseSubsystem::GetResidentBytes() const
+{
+	int64 Bytes = 0;
+	for (const FChapterState& State : ChapterStates)
+	{
+		Bytes += State.Bytes;
+	}
+	return Bytes;
+}
+
+void UDialogueDatabaseSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) return;
+	TimeSinceUpdate = 0.f;
+
+	UpdateResidency();
+}
+
+void UDialogueDatabaseSubsystem::MarkWanted(int32 ChapterIndex)
+{
+	if (!ChapterStates.IsValidIndex(ChapterIndex)) return;
+
+	FChapterState& State = ChapterStates[ChapterIndex];
+	State.bWanted = true;
+	if (const UWorld* World = GetWorld())
+	{
+		State.LastWantedTime = World->GetTimeSeconds();
+	}
+}
+
+void UDialogueDatabaseSubsystem::UpdateResidency()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	for (FChapterState& State : ChapterStates)
+	{
+		State.bWanted = false;
+	}
+
+	TArray<FVector, TInlineAllocator<4>> Players;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (!PC) continue;
+
+		if (const APawn* Pawn = PC->GetPawn())
+		{
+			Players.Add(Pawn->GetActorLocation());
+		}
+
+		// A running conversation needs its own file and every file it can jump to next
+		const UDialogueManager* DM = PC->FindComponentByClass<UDialogueManager>();
+		const FDialogueGraph* Graph = DM ? DM->GetActiveGraph().Get() : nullptr;
+		if (Graph && DM->GetCurrentNode())
+		{
+			MarkWanted(FindChapter(Graph->SourcePath));
+			for (const FDialogueExternalLink& Link : Graph->ExternalLinks)
+			{
+				MarkWanted(FindChapter(FString(Graph->GetString(Link.File))));
+			}
+		}
+	}
+
+	// Players walking up to an NPC
+	const float MaxDistanceSquared = FMath::Square(PageInDistance);
+	for (int32 Index = Triggers.Num() - 1; Index >= 0; --Index)
+	{
+		const UDialogueTriggerComponent* Trigger = Triggers[Index].Get();
+		if (!Trigger)
+		{
+			Triggers.RemoveAtSwap(Index);
+			continue;
+		}
+
+		const int32 ChapterIndex = FindChapter(Trigger->GetDialogueFilePath());
+		if (ChapterIndex == INDEX_NONE || ChapterStates[ChapterIndex].bWanted) continue;
+
+		const FVector Location = Trigger->GetComponentLocation();
+		for (const FVector& Player : Players)
+		{
+			if (FVector::DistSquared(Player, Location) <= MaxDistanceSquared)
+			{
+				MarkWanted(ChapterIndex);
+				break;
+			}
+		}
+	}
+
+	for (int32 ChapterIndex = 0; ChapterIndex < ChapterStates.Num(); ++ChapterIndex)
+	{
+		if (ChapterStates[ChapterIndex].bWanted)
+		{
+			PageIn(ChapterIndex);
+		}
+	}
+
+	EnforceBudget();
+}
+
+void UDialogueDatabaseSubsystem::PageIn(int32 ChapterIndex)
+{
+	FChapterState& State = ChapterStates[ChapterIndex];
+	if (State.IsResident() || State.LoadHandle.IsValid()) return;
+
+	UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this);
+	if (!GraphSubsystem) return;
+
+	UE_LOG(LogDialogue, Verbose, TEXT("DialogueDatabase: paging in chapter %s"), *Chapters[ChapterIndex].Name.ToString());
+
+	// Files a trigger or conversation already holds join the batch without being parsed again
+	State.LoadHandle = GraphSubsystem->LoadGraphsAsync(Chapters[ChapterIndex].Files,
+		FOnDialogueGraphsLoaded::CreateUObject(this, &UDialogueDatabaseSubsystem::HandleChapterLoaded, ChapterIndex));
+}
+
+void UDialogueDatabaseSubsystem::HandleChapterLoaded(const TArray<FDialogueGraphRef>& Graphs, int32 ChapterIndex)
+{
+	if (!ChapterStates.IsValidIndex(ChapterIndex)) return;
+
+	FChapterState& State = ChapterStates[ChapterIndex];
+	State.LoadHandle.Reset();
+	State.Graphs.Reset(Graphs.Num());
+	State.Bytes = 0;
+	for (const FDialogueGraphRef& Graph : Graphs)
+	{
+		if (Graph)
+		{
+			State.Bytes += sizeof(FDialogueGraph) + Graph->GetAllocatedSize();
+			State.Graphs.Add(Graph);
+		}
+	}
+
+	UE_LOG(LogDialogue, Log, TEXT("DialogueDatabase: chapter %s resident, %d files, %.1f KB"),
+		*Chapters[ChapterIndex].Name.ToString(), State.Graphs.Num(), State.Bytes / 1024.0);
+
+	EnforceBudget();
+}
+
+void UDialogueDatabaseSubsystem::EnforceBudget()
+{
+	const int64 BudgetBytes = int64(MemoryBudgetMB) * 1024 * 1024;
+	int64 ResidentBytes = GetResidentBytes();
+
+	// Least recently wanted first; chapters wanted right now are never evicted, even over budget
+	while (ResidentBytes > BudgetBytes)
+	{
+		int32 Oldest = INDEX_NONE;
+		for (int32 ChapterIndex = 0; ChapterIndex < ChapterStates.Num(); ++ChapterIndex)
+		{
+			const FChapterState& State = ChapterStates[ChapterIndex];
+			if (State.IsResident() && !State.bWanted
+				&& (Oldest == INDEX_NONE || State.LastWantedTime < ChapterStates[Oldest].LastWantedTime))
+			{
+				Oldest = ChapterIndex;
+			}
+		}
+		if (Oldest == INDEX_NONE) break;
+
+		ResidentBytes -= ChapterStates[Oldest].Bytes;
+		Evict(Oldest);
+	}
+
+	SET_MEMORY_STAT(STAT_DialogueResidentMemory, ResidentBytes);
+}
+
+void UDialogueDatabaseSubsystem::Evict(int32 ChapterIndex)
+{
+	FChapterState& State = ChapterStates[ChapterIndex];
+	UE_LOG(LogDialogue, Verbose, TEXT("DialogueDatabase: evicting chapter %s (%.1f KB)"),
+		*Chapters[ChapterIndex].Name.ToString(), State.Bytes / 1024.0);
+
+	// Only our references go; graphs still used by a trigger or conversation live on until released
+	State.Graphs.Reset();
+	State.Bytes = 0;
+}
+
+void UDialogueDatabaseSubsystem::HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph)
+{
+	const int32 ChapterIndex = FindChapter(Path);
+	if (ChapterIndex == INDEX_NONE) return;
+
+	FChapterState& State = ChapterStates[ChapterIndex];
+	for (FDialogueGraphRef& Graph : State.Graphs)
+	{
+		if (Graph == OldGraph)
+		{
+			State.Bytes += int64(NewGraph->GetAllocatedSize()) - int64(OldGraph->GetAllocatedSize());
+			Graph = NewGraph;
+		}
+	}
+}
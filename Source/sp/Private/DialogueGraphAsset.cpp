@@ -0,0 +1,152 @@
+#include "DialogueGraphAsset.h"
+#include "DialogueDataLoader.h"
+#include "DialogueStats.h"
+#include "Serialization/Archive.h"
+
+#if WITH_EDITORONLY_DATA
+#include "EditorFramework/AssetImportData.h"
+#endif
+
+namespace DialogueGraphAssetFormat
+{
+	// Bump when the binary layout below changes
+	enum : int32
+	{
+		Initial = 1,
+		NodeAssets,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+}
+
+// Binary layout of the authored structs. Conditions and effects are compiled
+// when the runtime graph is built (see BuildGraph).
+template <typename T, typename Fn>
+static void SerializeArray(FArchive& Ar, TArray<T>& Array, Fn&& SerializeItem)
+{
+	int32 Num = Array.Num();
+	Ar << Num;
+	if (Ar.IsLoading())
+	{
+		if (Num < 0 || Ar.IsError())
+		{
+			Ar.SetError();
+			return;
+		}
+		Array.SetNum(Num);
+	}
+	for (T& Item : Array)
+	{
+		SerializeItem(Ar, Item);
+	}
+}
+
+static void SerializeAltLine(FArchive& Ar, FDialogueAltLine& Line)
+{
+	Ar << Line.Condition;
+	Ar << Line.Text;
+}
+
+static void SerializeAltText(FArchive& Ar, FDialogueAltText& AltText)
+{
+	Ar << AltText.Condition;
+	Ar << AltText.Text;
+}
+
+static void SerializeEffect(FArchive& Ar, FDialogueEffect& Effect)
+{
+	Ar << Effect.Attribute;
+	uint8 Op = static_cast<uint8>(Effect.Operation);
+	Ar << Op;
+	Effect.Operation = static_cast<EDialogueEffectOp>(Op);
+	Ar << Effect.Value;
+}
+
+static void SerializeChoice(FArchive& Ar, FDialogueChoice& Choice)
+{
+	Ar << Choice.Text;
+	SerializeArray(Ar, Choice.AltTexts, SerializeAltText);
+	Ar << Choice.Requirements;
+	SerializeArray(Ar, Choice.Effects, SerializeEffect);
+	Ar << Choice.NextNodeID;
+	Ar << Choice.FailureNodeID;
+}
+
+static void SerializeNode(FArchive& Ar, FDialogueNode& Node, int32 Format)
+{
+	Ar << Node.ID;
+	Ar << Node.Speaker;
+	Ar << Node.BaseLine;
+	SerializeArray(Ar, Node.AltLines, SerializeAltLine);
+	SerializeArray(Ar, Node.AppendLines, SerializeAltLine);
+	SerializeArray(Ar, Node.Choices, SerializeChoice);
+	Ar << Node.NextNodeID;
+
+	if (Format >= DialogueGraphAssetFormat::NodeAssets)
+	{
+		Ar << Node.Assets.VoiceOver;
+		Ar << Node.Assets.Portrait;
+		Ar << Node.Assets.Montage;
+	}
+}
+
+void UDialogueGraphAsset::PostInitProperties()
+{
+#if WITH_EDITORONLY_DATA
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad))
+	{
+		AssetImportData = NewObject<UAssetImportData>(this, TEXT("AssetImportData"));
+	}
+#endif
+	Super::PostInitProperties();
+}
+
+void UDialogueGraphAsset::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Reference collection and similar passes don't need the node block
+	if (!Ar.IsLoading() && !Ar.IsSaving()) return;
+
+	int32 Format = DialogueGraphAssetFormat::Latest;
+	Ar << Format;
+	if (Ar.IsLoading() && Format > DialogueGraphAssetFormat::Latest)
+	{
+		UE_LOG(LogDialogue, Error, TEXT("%s: dialogue graph saved with a newer format (%d)"), *GetPathName(), Format);
+		Ar.SetError();
+		return;
+	}
+
+	SerializeArray(Ar, Nodes, [Format](FArchive& NodeAr, FDialogueNode& Node) { SerializeNode(NodeAr, Node, Format); });
+
+	if (Ar.IsLoading() && Ar.IsError())
+	{
+		UE_LOG(LogDialogue, Error, TEXT("%s: corrupt dialogue graph data"), *GetPathName());
+		Nodes.Empty();
+	}
+}
+
+void UDialogueGraphAsset::SetNodes(TMap<FString, FDialogueNode>&& InNodes)
+{
+	Nodes.Reset(InNodes.Num());
+	for (TPair<FString, FDialogueNode>& Pair : InNodes)
+	{
+		Nodes.Add(MoveTemp(Pair.Value));
+	}
+	InNodes.Empty();
+
+	// Stable order keeps the saved asset diffable across reimports
+	Nodes.Sort([](const FDialogueNode& A, const FDialogueNode& B) { return A.ID < B.ID; });
+}
+
+FDialogueGraphRef UDialogueGraphAsset::BuildGraph() const
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueLoad);
+
+	TSharedRef<FDialogueGraph, ESPMode::ThreadSafe> Graph = MakeShared<FDialogueGraph, ESPMode::ThreadSafe>();
+	Graph->SourcePath = GetPathName();
+	// The asset keeps its nodes, so the builder gets a copy to move from
+	UDialogueDataLoader::BuildGraph(TArray<FDialogueNode>(Nodes), *Graph);
+	return Graph;
+}
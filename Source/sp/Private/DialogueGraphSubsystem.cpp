@@ -0,0 +1,547 @@
+#include "DialogueGraphSubsystem.h"
+#include "Async/Async.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Misc/Paths.h"
+#include "DialogueDataLoader.h"
+#include "DialogueDatabaseSubsystem.h"
+#include "DialogueGraphAsset.h"
+#include "DialogueStats.h"
+#include "DialogueTriggerComponent.h"
+
+#if WITH_EDITOR
+#include "DirectoryWatcherModule.h"
+#include "IDirectoryWatcher.h"
+#include "Modules/ModuleManager.h"
+#endif
+
+UDialogueGraphSubsystem* UDialogueGraphSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UDialogueGraphSubsystem>() : nullptr;
+}
+
+void UDialogueGraphSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	WorldInitializedActorsHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UDialogueGraphSubsystem::HandleWorldInitializedActors);
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UDialogueGraphSubsystem::HandleWorldCleanup);
+
+#if WITH_EDITOR
+	// Writers edit JSON while PIE runs; pick up their saves
+	if (FModuleManager::Get().ModuleExists(TEXT("DirectoryWatcher")))
+	{
+		FDirectoryWatcherModule& DirectoryWatcher = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+		if (IDirectoryWatcher* Watcher = DirectoryWatcher.Get())
+		{
+			Watcher->RegisterDirectoryChangedCallback_Handle(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()),
+				IDirectoryWatcher::FDirectoryChanged::CreateUObject(this, &UDialogueGraphSubsystem::HandleContentFilesChanged),
+				DirectoryWatcherHandle);
+		}
+	}
+#endif
+}
+
+void UDialogueGraphSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(WorldInitializedActorsHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+#if WITH_EDITOR
+	if (FDirectoryWatcherModule* DirectoryWatcher = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")))
+	{
+		if (IDirectoryWatcher* Watcher = DirectoryWatcher->Get())
+		{
+			Watcher->UnregisterDirectoryChangedCallback_Handle(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()), DirectoryWatcherHandle);
+		}
+	}
+	DirectoryWatcherHandle.Reset();
+#endif
+
+	// Workers still running will find us gone and drop their result.
+	// Outstanding handles keep their graphs alive; we just forget about them.
+	for (auto& Pair : PendingLoads)
+	{
+		Pair.Value->bAbandoned = true;
+	}
+	PendingLoads.Empty();
+	for (auto& Pair : AssetRequests)
+	{
+		if (Pair.Value.IsValid()) Pair.Value->CancelHandle();
+	}
+	AssetRequests.Empty();
+	RequestPaths.Empty();
+	Batches.Empty();
+	WorldPreloads.Empty();
+	Graphs.Empty();
+	Super::Deinitialize();
+}
+
+FDialogueGraphRef UDialogueGraphSubsystem::LoadGraph(const FString& RelativePath)
+{
+	const FString Key = NormalizePath(RelativePath);
+	if (FDialogueGraphRef Existing = FindGraph(Key))
+	{
+		return Existing;
+	}
+
+	PruneExpired();
+
+	FDialogueGraphRef Graph = ParseGraph(Key);
+	if (Graph.IsValid())
+	{
+		Graphs.Add(Key, Graph);
+	}
+	return Graph;
+}
+
+FDialogueLoadHandle UDialogueGraphSubsystem::LoadGraphAsync(const FString& RelativePath, FOnDialogueGraphLoaded OnLoaded)
+{
+	const FString Key = NormalizePath(RelativePath);
+	if (FDialogueGraphRef Existing = FindGraph(Key))
+	{
+		OnLoaded.ExecuteIfBound(Existing);
+		return FDialogueLoadHandle();
+	}
+
+	FDialogueLoadHandle Handle;
+	Handle.Id = NextRequestId++;
+	RequestPaths.Add(Handle.Id, Key);
+
+	// Join the parse already in flight for this file, if any
+	if (TSharedRef<FPendingLoad, ESPMode::ThreadSafe>* Pending = PendingLoads.Find(Key))
+	{
+		(*Pending)->bAbandoned = false;
+		(*Pending)->Callbacks.Emplace(Handle.Id, MoveTemp(OnLoaded));
+		return Handle;
+	}
+
+	TSharedRef<FPendingLoad, ESPMode::ThreadSafe> Pending = MakeShared<FPendingLoad, ESPMode::ThreadSafe>();
+	Pending->Callbacks.Emplace(Handle.Id, MoveTemp(OnLoaded));
+	PendingLoads.Add(Key, Pending);
+	StartWorker(Key, Pending);
+	return Handle;
+}
+
+FDialogueLoadHandle UDialogueGraphSubsystem::LoadGraphsAsync(const TArray<FString>& RelativePaths, FOnDialogueGraphsLoaded OnAllLoaded)
+{
+	struct FBatchState
+	{
+		TArray<FDialogueGraphRef> Results;
+		int32 Remaining = 0;
+		FOnDialogueGraphsLoaded OnAllLoaded;
+	};
+
+	TSharedRef<FBatchState> Batch = MakeShared<FBatchState>();
+	Batch->Results.SetNum(RelativePaths.Num());
+	Batch->Remaining = RelativePaths.Num();
+	Batch->OnAllLoaded = MoveTemp(OnAllLoaded);
+
+	if (RelativePaths.Num() == 0)
+	{
+		Batch->OnAllLoaded.ExecuteIfBound(Batch->Results);
+		return FDialogueLoadHandle();
+	}
+
+	FDialogueLoadHandle BatchHandle;
+	BatchHandle.Id = NextRequestId++;
+
+	// Each file gets its own worker, so the whole batch parses in parallel
+	TArray<FDialogueLoadHandle> SubHandles;
+	for (int32 Index = 0; Index < RelativePaths.Num(); ++Index)
+	{
+		const uint32 BatchId = BatchHandle.Id;
+		FDialogueLoadHandle SubHandle = LoadGraphAsync(RelativePaths[Index], FOnDialogueGraphLoaded::CreateWeakLambda(this,
+			[this, Batch, Index, BatchId](FDialogueGraphRef Graph)
+			{
+				Batch->Results[Index] = Graph;
+				if (--Batch->Remaining == 0)
+				{
+					Batches.Remove(BatchId);
+					Batch->OnAllLoaded.ExecuteIfBound(Batch->Results);
+				}
+			}));
+
+		if (SubHandle.IsValid())
+		{
+			SubHandles.Add(SubHandle);
+		}
+	}
+
+	// Everything may already have been cached, in which case the batch is complete
+	if (Batch->Remaining == 0)
+	{
+		return FDialogueLoadHandle();
+	}
+
+	Batches.Add(BatchHandle.Id, MoveTemp(SubHandles));
+	return BatchHandle;
+}
+
+FDialogueGraphRef UDialogueGraphSubsystem::GetGraphForAsset(const UDialogueGraphAsset* Asset)
+{
+	if (!Asset) return nullptr;
+
+	const FString Key = Asset->GetPathName();
+	if (FDialogueGraphRef Existing = FindGraph(Key))
+	{
+		return Existing;
+	}
+
+	PruneExpired();
+
+	FDialogueGraphRef Graph = Asset->BuildGraph();
+	Graphs.Add(Key, Graph);
+	return Graph;
+}
+
+FDialogueLoadHandle UDialogueGraphSubsystem::LoadGraphAssetAsync(const TSoftObjectPtr<UDialogueGraphAsset>& Asset, FOnDialogueGraphLoaded OnLoaded)
+{
+	if (const UDialogueGraphAsset* Loaded = Asset.Get())
+	{
+		OnLoaded.ExecuteIfBound(GetGraphForAsset(Loaded));
+		return FDialogueLoadHandle();
+	}
+
+	FDialogueLoadHandle Handle;
+	Handle.Id = NextRequestId++;
+	const uint32 Id = Handle.Id;
+
+	TSharedPtr<FStreamableHandle> Streamable = UAssetManager::GetStreamableManager().RequestAsyncLoad(Asset.ToSoftObjectPath(),
+		FStreamableDelegate::CreateWeakLambda(this, [this, Asset, Id, OnLoaded]()
+		{
+			AssetRequests.Remove(Id);
+			const UDialogueGraphAsset* LoadedAsset = Asset.Get();
+			if (!LoadedAsset)
+			{
+				UE_LOG(LogDialogue, Error, TEXT("DialogueGraphSubsystem: failed to load %s"), *Asset.ToString());
+			}
+			OnLoaded.ExecuteIfBound(LoadedAsset ? GetGraphForAsset(LoadedAsset) : nullptr);
+		}));
+
+	// The delegate may already have run if the asset was loaded in the meantime
+	if (!Streamable.IsValid() || Streamable->HasLoadCompleted())
+	{
+		return FDialogueLoadHandle();
+	}
+
+	AssetRequests.Add(Id, Streamable);
+	return Handle;
+}
+
+void UDialogueGraphSubsystem::CancelLoad(FDialogueLoadHandle& Handle)
+{
+	if (!Handle.IsValid()) return;
+
+	TSharedPtr<FStreamableHandle> Streamable;
+	if (AssetRequests.RemoveAndCopyValue(Handle.Id, Streamable) && Streamable.IsValid())
+	{
+		// Cancelling drops the completion delegate
+		Streamable->CancelHandle();
+	}
+
+	TArray<FDialogueLoadHandle> SubHandles;
+	if (Batches.RemoveAndCopyValue(Handle.Id, SubHandles))
+	{
+		for (FDialogueLoadHandle& SubHandle : SubHandles)
+		{
+			CancelLoad(SubHandle);
+		}
+	}
+
+	FString Key;
+	if (RequestPaths.RemoveAndCopyValue(Handle.Id, Key))
+	{
+		if (TSharedRef<FPendingLoad, ESPMode::ThreadSafe>* Pending = PendingLoads.Find(Key))
+		{
+			const uint32 Id = Handle.Id;
+			(*Pending)->Callbacks.RemoveAll([Id](const TPair<uint32, FOnDialogueGraphLoaded>& Entry) { return Entry.Key == Id; });
+			if ((*Pending)->Callbacks.Num() == 0)
+			{
+				(*Pending)->bAbandoned = true;
+			}
+		}
+	}
+
+	Handle.Reset();
+}
+
+void UDialogueGraphSubsystem::StartWorker(const FString& Key, const TSharedRef<FPendingLoad, ESPMode::ThreadSafe>& Pending)
+{
+	TWeakObjectPtr<UDialogueGraphSubsystem> WeakThis(this);
+	TSharedRef<FPendingLoad, ESPMode::ThreadSafe> PendingRef = Pending;
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Key, PendingRef]()
+	{
+		// File I/O, JSON parsing and condition compilation all happen off the game thread
+		const bool bSkipped = PendingRef->bAbandoned.load();
+		FDialogueGraphRef Graph = bSkipped ? nullptr : ParseGraph(Key);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Key, Graph, bSkipped]()
+		{
+			if (UDialogueGraphSubsystem* This = WeakThis.Get())
+			{
+				This->FinishAsyncLoad(Key, Graph, bSkipped);
+			}
+		});
+	});
+}
+
+void UDialogueGraphSubsystem::FinishAsyncLoad(const FString& Key, FDialogueGraphRef Graph, bool bSkipped)
+{
+	TSharedRef<FPendingLoad, ESPMode::ThreadSafe>* PendingPtr = PendingLoads.Find(Key);
+	if (!PendingPtr) return;
+	TSharedRef<FPendingLoad, ESPMode::ThreadSafe> Pending = *PendingPtr;
+
+	// Someone asked for the file again after the worker had already given up on it
+	if (bSkipped && Pending->Callbacks.Num() > 0)
+	{
+		StartWorker(Key, Pending);
+		return;
+	}
+	PendingLoads.Remove(Key);
+
+	if (Graph.IsValid())
+	{
+		// A synchronous LoadGraph may have beaten us to it; keep a single copy
+		if (FDialogueGraphRef Existing = FindGraph(Key))
+		{
+			Graph = Existing;
+		}
+		else
+		{
+			PruneExpired();
+			Graphs.Add(Key, Graph);
+		}
+	}
+
+	// Callbacks may issue new requests, so work from a local copy
+	TArray<TPair<uint32, FOnDialogueGraphLoaded>> Callbacks = MoveTemp(Pending->Callbacks);
+	for (TPair<uint32, FOnDialogueGraphLoaded>& Entry : Callbacks)
+	{
+		RequestPaths.Remove(Entry.Key);
+		Entry.Value.ExecuteIfBound(Graph);
+	}
+}
+
+void UDialogueGraphSubsystem::HandleWorldInitializedActors(const FActorsInitializedParams& Params)
+{
+	UWorld* World = Params.World;
+	if (!World || !World->IsGameWorld() || World->GetGameInstance() != GetGameInstance()) return;
+
+	// Files of database chapters are paged in as players get close instead
+	const UDialogueDatabaseSubsystem* Database = World->GetSubsystem<UDialogueDatabaseSubsystem>();
+
+	TSet<FString> Paths;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		TInlineComponentArray<UDialogueTriggerComponent*> Triggers(*It);
+		for (const UDialogueTriggerComponent* Trigger : Triggers)
+		{
+			// Triggers using an imported asset stream it through the asset manager instead
+			if (Trigger->GetDialogueAsset().IsNull() && !Trigger->GetDialogueFilePath().IsEmpty()
+				&& !(Database && Database->IsPaged(Trigger->GetDialogueFilePath())))
+			{
+				Paths.Add(NormalizePath(Trigger->GetDialogueFilePath()));
+			}
+		}
+	}
+	if (Paths.Num() == 0) return;
+
+	// Triggers ask for their graphs in BeginPlay right after this and join the loads already in flight
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumFiles = Paths.Num();
+	const TObjectKey<UWorld> WorldKey(World);
+	LoadGraphsAsync(Paths.Array(), FOnDialogueGraphsLoaded::CreateWeakLambda(this, [this, WorldKey, StartTime, NumFiles](const TArray<FDialogueGraphRef>& Loaded)
+	{
+		// Pinned until the world is cleaned up; a world torn down before the batch finished gets nothing
+		if (WorldKey.ResolveObjectPtr())
+		{
+			TArray<FDialogueGraphRef>& Pinned = WorldPreloads.FindOrAdd(WorldKey);
+			for (const FDialogueGraphRef& Graph : Loaded)
+			{
+				if (Graph.IsValid()) Pinned.AddUnique(Graph);
+			}
+		}
+
+		UE_LOG(LogDialogue, Log, TEXT("DialogueGraphSubsystem: preloaded %d level dialogue files in %.1f ms"),
+			NumFiles, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}));
+}
+
+void UDialogueGraphSubsystem::HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	WorldPreloads.Remove(TObjectKey<UWorld>(World));
+}
+
+FDialogueGraphRef UDialogueGraphSubsystem::FindGraph(const FString& RelativePath) const
+{
+	const TWeakPtr<const FDialogueGraph, ESPMode::ThreadSafe>* Found = Graphs.Find(NormalizePath(RelativePath));
+	return Found ? Found->Pin() : nullptr;
+}
+
+int32 UDialogueGraphSubsystem::GetNumLoadedGraphs() const
+{
+	int32 Num = 0;
+	for (const auto& Pair : Graphs)
+	{
+		if (Pair.Value.IsValid()) ++Num;
+	}
+	return Num;
+}
+
+FDialogueGraphRef UDialogueGraphSubsystem::ParseGraph(const FString& RelativePath)
+{
+	return ParseGraphAtPath(FPaths::ProjectContentDir() / RelativePath, RelativePath);
+}
+
+FDialogueGraphRef UDialogueGraphSubsystem::ParseGraphAtPath(const FString& FullPath, const FString& SourcePath, const FDialogueGraph* Previous)
+{
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueLoad);
+
+	TMap<FString, FDialogueNode> ParsedNodes;
+	if (!UDialogueDataLoader::ParseDialogueFileAtPath(FullPath, ParsedNodes))
+	{
+		return nullptr;
+	}
+
+	// Keep the previous graph's order for the nodes it has, so their indices stay put
+	TArray<FDialogueNode> AuthoredNodes;
+	AuthoredNodes.Reserve(ParsedNodes.Num());
+	if (Previous)
+	{
+		for (int32 Index = 0; Index < Previous->NumNodes(); ++Index)
+		{
+			FDialogueNode Node;
+			if (ParsedNodes.RemoveAndCopyValue(FString(Previous->GetNodeId(Index)), Node))
+			{
+				AuthoredNodes.Add(MoveTemp(Node));
+			}
+		}
+	}
+
+	// Sorted so node indices don't depend on hash order
+	ParsedNodes.KeySort(TLess<FString>());
+	for (TPair<FString, FDialogueNode>& Pair : ParsedNodes)
+	{
+		AuthoredNodes.Add(MoveTemp(Pair.Value));
+	}
+
+	TSharedRef<FDialogueGraph, ESPMode::ThreadSafe> Graph = MakeShared<FDialogueGraph, ESPMode::ThreadSafe>();
+	Graph->SourcePath = SourcePath;
+	UDialogueDataLoader::BuildGraph(MoveTemp(AuthoredNodes), *Graph);
+	return Graph;
+}
+
+void UDialogueGraphSubsystem::ReloadGraph(const FString& RelativePath)
+{
+	const FString Key = NormalizePath(RelativePath);
+	FDialogueGraphRef OldGraph = FindGraph(Key);
+	if (!OldGraph) return;
+
+	TWeakObjectPtr<UDialogueGraphSubsystem> WeakThis(this);
+	const double StartTime = FPlatformTime::Seconds();
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Key, OldGraph, StartTime]()
+	{
+		FDialogueGraphRef NewGraph = ParseGraphAtPath(FPaths::ProjectContentDir() / Key, Key, OldGraph.Get());
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Key, OldGraph, NewGraph, StartTime]()
+		{
+			if (UDialogueGraphSubsystem* This = WeakThis.Get())
+			{
+				This->FinishReload(Key, OldGraph, NewGraph, StartTime);
+			}
+		});
+	});
+}
+
+void UDialogueGraphSubsystem::FinishReload(const FString& Key, FDialogueGraphRef OldGraph, FDialogueGraphRef NewGraph, double StartTime)
+{
+	if (!NewGraph)
+	{
+		UE_LOG(LogDialogue, Error, TEXT("DialogueGraphSubsystem: reload of %s failed, keeping the running version"), *Key);
+		return;
+	}
+
+	// Another reload or a fresh load replaced the graph in the meantime
+	if (FindGraph(Key) != OldGraph) return;
+
+	int32 NumChanged = 0;
+	int32 NumAdded = 0;
+	for (int32 Index = 0; Index < NewGraph->NumNodes(); ++Index)
+	{
+		const int32 OldIndex = OldGraph->FindNodeIndex(FString(NewGraph->GetNodeId(Index)));
+		if (OldIndex == INDEX_NONE)
+		{
+			++NumAdded;
+		}
+		else if (OldGraph->HashNode(OldIndex) != NewGraph->HashNode(Index))
+		{
+			++NumChanged;
+		}
+	}
+	const int32 NumRemoved = OldGraph->NumNodes() - (NewGraph->NumNodes() - NumAdded);
+
+	if (NumChanged == 0 && NumAdded == 0 && NumRemoved == 0)
+	{
+		UE_LOG(LogDialogue, Log, TEXT("DialogueGraphSubsystem: %s saved without changes"), *Key);
+		return;
+	}
+
+	Graphs.Add(Key, NewGraph);
+	for (TPair<TObjectKey<UWorld>, TArray<FDialogueGraphRef>>& Preload : WorldPreloads)
+	{
+		for (FDialogueGraphRef& Pinned : Preload.Value)
+		{
+			if (Pinned == OldGraph) Pinned = NewGraph;
+		}
+	}
+	OnGraphReloaded.Broadcast(Key, OldGraph, NewGraph);
+
+	UE_LOG(LogDialogue, Log, TEXT("DialogueGraphSubsystem: reloaded %s (%d changed, %d added, %d removed) in %.1f ms"),
+		*Key, NumChanged, NumAdded, NumRemoved, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+#if WITH_EDITOR
+void UDialogueGraphSubsystem::HandleContentFilesChanged(const TArray<FFileChangeData>& Changes)
+{
+	const FString ContentDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir());
+
+	// Editors often write a file more than once per save
+	TSet<FString> Changed;
+	for (const FFileChangeData& Change : Changes)
+	{
+		if (Change.Action == FFileChangeData::FCA_Removed || !Change.Filename.EndsWith(TEXT(".json"))) continue;
+
+		FString RelativePath = FPaths::ConvertRelativePathToFull(Change.Filename);
+		if (FPaths::MakePathRelativeTo(RelativePath, *ContentDir))
+		{
+			Changed.Add(NormalizePath(RelativePath));
+		}
+	}
+
+	for (const FString& Path : Changed)
+	{
+		ReloadGraph(Path);
+	}
+}
+#endif
+
+FString UDialogueGraphSubsystem::NormalizePath(const FString& RelativePath)
+{
+	FString Path = RelativePath;
+	FPaths::NormalizeFilename(Path);
+	return Path;
+}
+
+void UDialogueGraphSubsystem::PruneExpired()
+{
+	for (auto It = Graphs.CreateIterator(); It; ++It)
+	{
+		if (!It->Value.IsValid()) It.RemoveCurrent();
+	}
+}
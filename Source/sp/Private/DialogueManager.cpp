@@ -1,487 +1,917 @@
 #include "DialogueManager.h"
-#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
+#include "DialogueGraphAsset.h"
 #include "DialogueDataLoader.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueStats.h"
+#include "Misc/Paths.h"
+#include "Misc/StringBuilder.h"
 
 UDialogueManager::UDialogueManager()
+    : StatePublisher(MakeShared<FDialogueStatePublisher, ESPMode::ThreadSafe>())
 {
     PrimaryComponentTick.bCanEverTick = false;
+    SetIsReplicatedByDefault(true);
+}
+
+void UDialogueManager::PostInitProperties()
+{
+    Super::PostInitProperties();
+
+    // Not in the constructor: initializing properties copies the whole struct from the archetype,
+    // which would point every Blueprint instance at the template's manager
+    ReplicatedState.Owner = this;
+}
+
+void UDialogueManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    // The manager sits on the player controller; only its owner follows the dialogue
+    DOREPLIFETIME_CONDITION(UDialogueManager, ReplicatedGraphPath, COND_OwnerOnly);
+    DOREPLIFETIME_CONDITION(UDialogueManager, ReplicatedNodeIndex, COND_OwnerOnly);
+    DOREPLIFETIME_CONDITION(UDialogueManager, ReplicatedState, COND_OwnerOnly);
 }
 
 void UDialogueManager::BeginPlay()
 {
     Super::BeginPlay();
 
-    if (!DialogueJSONPath.IsEmpty())
+    if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
     {
-        bool bSuccess = LoadDialogueFromJSON(DialogueJSONPath);
-        if (!bSuccess && GEngine)
-        {
-            GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red,
-                FString::Printf(TEXT("Failed to load dialogue JSON at: %s"), *DialogueJSONPath));
-        } else
+        GraphReloadedHandle = GraphSubsystem->OnGraphReloaded.AddUObject(this, &UDialogueManager::HandleGraphReloaded);
+    }
+
+    if (!DialogueAsset.IsNull())
+    {
+        if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
         {
-            // Set as own dialogue map for a start
-            ActiveDialogueMap = &OwnDialogueMap;
+            OwnGraphLoadHandle = GraphSubsystem->LoadGraphAssetAsync(DialogueAsset,
+                FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueManager::HandleOwnGraphLoaded));
         }
+    } else if (!DialogueJSONPath.IsEmpty())
+    {
+        LoadDialogueFromJSONAsync(DialogueJSONPath);
     } else
     {
-        if (GEngine)
-        {
-            GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow,
-            TEXT("DialogueJSONPath is not set!"));
-        }
+        UE_LOG(LogDialogue, Log, TEXT("DialogueManager: no DialogueAsset or DialogueJSONPath set, waiting for a trigger's graph."));
     }
 }
 
-void UDialogueManager::StartDialogue(const FString& NodeID, const TMap<FString, FDialogueNode>* InDialogueMap)
+void UDialogueManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    // Replace self's dialogue map with the incoming one, usually an NPC's
-    if (InDialogueMap)
+    if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
     {
-        ActiveDialogueMap = InDialogueMap;
-    } else if (!ActiveDialogueMap)
+        GraphSubsystem->CancelLoad(OwnGraphLoadHandle);
+        GraphSubsystem->OnGraphReloaded.Remove(GraphReloadedHandle);
+    }
+    GraphReloadedHandle.Reset();
+    PendingStartNodeID.Reset();
+    CancelLinkLoad();
+
+    // A session cut off mid-conversation is usually the one worth replaying
+    SaveRecording();
+    bStepQueued = false;
+    CancelSpeculation();
+    AssetPrefetcher.Reset();
+    Super::EndPlay(EndPlayReason);
+}
+
+void UDialogueManager::StartDialogue(const FString& NodeID, FDialogueGraphRef InGraph)
+{
+    // The server's manager starts it too; the first node arrives through replication
+    if (IsNetClient()) return;
+
+    CancelLinkLoad();
+
+    // Replace self's dialogue graph with the incoming one, usually an NPC's
+    if (InGraph)
     {
-        ActiveDialogueMap = &OwnDialogueMap;
+        SwitchGraph(MoveTemp(InGraph));
+        PendingStartNodeID.Reset();
+    } else if (!Session.GetGraph())
+    {
+        SwitchGraph(OwnGraph);
+    }
+
+    const FDialogueGraphRef& ActiveGraph = Session.GetGraph();
+
+    // Own graph still loading: start once it is ready
+    if (!ActiveGraph && OwnGraphLoadHandle.IsValid())
+    {
+        PendingStartNodeID = NodeID;
+        return;
     }
     
+    UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager: StartDialogue(%s)"), *NodeID);
+    TRACE_BOOKMARK(TEXT("Dialogue start: %s"), *NodeID);
+
+    const int32 NodeIndex = ActiveGraph ? ActiveGraph->FindNodeIndex(NodeID) : INDEX_NONE;
+    if (NodeIndex == INDEX_NONE)
+    {
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: node '%s' not found."), *NodeID);
+    }
+
+    if (bRecordDialogues && ActiveGraph)
+    {
+        SaveRecording();
+        Recording = MakeUnique<FDialogueRecording>();
+        Recording->GraphPath = ActiveGraph->SourcePath;
+        Recording->GraphHash = ActiveGraph->GetContentHash();
+        Recording->StartNodeID = NodeID;
+        Recording->bShowLockedChoices = bShowLockedChoices;
+        Recording->SetInitialState(Session.GetState());
+        RecordInput(EDialogueRecordedInput::Start);
+    }
+
+    // Keep the requested id even if it doesn't resolve, so the failure is visible
     CurrentNodeID = NodeID;
-    UE_LOG(LogTemp, Warning, TEXT("DialogueManager: StartDialogue(), NodeID."));
+    EnterNode(NodeIndex);
+}
 
-    const FDialogueNode* Node = GetCurrentNode();   // This reads from active dialogue map
-    FString Speaker = Node ? Node->Speaker : TEXT("???");
-    FString Line = GetCurrentLine();
+void UDialogueManager::EnterNode(int32 NodeIndex)
+{
+    // Effects of the choice that led here, applied directly or swapped in from a speculated branch
+    PublishState();
 
-    OnDialogueUpdated.Broadcast(Speaker, Line);
+    Session.EnterNode(NodeIndex);
+    const FDialogueGraphRef& ActiveGraph = Session.GetGraph();
+    if (Session.IsActive())
+    {
+        CurrentNodeID = FString(ActiveGraph->GetNodeId(NodeIndex));
+    }
+    if (IsNetServer())
+    {
+        ReplicatedGraphPath = ActiveGraph ? ActiveGraph->SourcePath : FString();
+        ReplicatedNodeIndex = Session.IsActive() ? NodeIndex : INDEX_NONE;
+    }
+    LaunchSpeculation();
 
-    TArray<FDialogueChoice> Choices = GetAvailableChoices();
-    OnChoicesUpdated.Broadcast(Choices);
+    // A dedicated server never shows or plays dialogue media
+    if (Session.IsActive() && !IsRunningDedicatedServer())
+    {
+        AssetPrefetcher.MaxHops = PrefetchHops;
+        AssetPrefetcher.BudgetBytes = int64(PrefetchBudgetMB) * 1024 * 1024;
+        AssetPrefetcher.Update(*ActiveGraph, NodeIndex);
+    }
+
+    OnDialogueUpdated.Broadcast(GetCurrentSpeaker(), GetCurrentLine());
+
+    if (OnChoicesUpdated.IsBound())
+    {
+        FillChoices(BroadcastChoices);
+        OnChoicesUpdated.Broadcast(BroadcastChoices);
+    }
+
+    RecordOutcome();
+    QueueStep();
 }
 
-void UDialogueManager::SetActiveDialogueMap(const TMap<FString, FDialogueNode>* InDialogueMap)
+void UDialogueManager::FollowLink(int32 Link)
 {
-    if (InDialogueMap)
-        ActiveDialogueMap = InDialogueMap;
-    else
-        ActiveDialogueMap = &OwnDialogueMap; // fallback
+    if (!FDialogueGraph::IsExternalLink(Link))
+    {
+        EnterNode(Link);
+        return;
+    }
+
+    const FDialogueGraph& ActiveGraph = *Session.GetGraph();
+    const FDialogueExternalLink& External = ActiveGraph.GetExternalLink(Link);
+    const FString File(ActiveGraph.GetString(External.File));
+    PendingLinkNodeID = FString(ActiveGraph.GetString(External.Node));
+    UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager: following link to %s:%s"), *File, *PendingLinkNodeID);
+
+    // The speculated branches and prefetched media belong to the file being left
+    CancelSpeculation();
+
+    UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this);
+    if (!GraphSubsystem)
+    {
+        HandleLinkedGraphLoaded(UDialogueGraphSubsystem::ParseGraph(File));
+        return;
+    }
+
+    // Runs the callback right away if the file is resident, e.g. paged in by the dialogue database
+    GraphSubsystem->CancelLoad(LinkLoadHandle);
+    LinkLoadHandle = GraphSubsystem->LoadGraphAsync(File,
+        FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueManager::HandleLinkedGraphLoaded));
 }
 
-const FDialogueNode* UDialogueManager::GetCurrentNode() const
+void UDialogueManager::HandleLinkedGraphLoaded(FDialogueGraphRef Graph)
 {
-    if (CurrentNodeID.IsEmpty())
+    LinkLoadHandle.Reset();
+    const FString NodeID = MoveTemp(PendingLinkNodeID);
+    PendingLinkNodeID.Reset();
+
+    const int32 NodeIndex = Graph ? Graph->FindNodeIndex(NodeID) : INDEX_NONE;
+    if (NodeIndex == INDEX_NONE)
     {
-        UE_LOG(LogTemp, Warning, TEXT("GetCurrentNode() was called but CurrentNodeID is empty."));
-        return nullptr;
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: linked node '%s' could not be loaded, ending the dialogue."), *NodeID);
+        FinishDialogue();
+        return;
     }
-    if (!ActiveDialogueMap) return nullptr;
 
-    const FDialogueNode* Node = ActiveDialogueMap->Find(CurrentNodeID);
-    return Node;
+    SwitchGraph(MoveTemp(Graph));
+    EnterNode(NodeIndex);
 }
 
-FString UDialogueManager::GetCurrentLine() const
+void UDialogueManager::CancelLinkLoad()
 {
-    const FDialogueNode* Node = GetCurrentNode();    
-    if (!Node)
-        return FString("Node not found!");
+    if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
+    {
+        GraphSubsystem->CancelLoad(LinkLoadHandle);
+    }
+    LinkLoadHandle.Reset();
+    PendingLinkNodeID.Reset();
+}
 
-    // Check alt lines (replacement)
-    for (const FDialogueAltLine& Alt : Node->AltLines)
+void UDialogueManager::QueueStep()
+{
+    if (bStepQueued || !OnDialogueStep.IsBound()) return;
+
+    UWorld* World = GetWorld();
+    if (!World)
     {
-        if (Alt.Condition.IsEmpty())
-            continue;
+        bStepQueued = true;
+        BroadcastStep();
+        return;
+    }
 
-        if (EvaluateConditionString(Alt.Condition))
-        {
-            // Found a replacement alt line
-            FString Result = Alt.Text;
-
-            // Append any append lines that match
-            for (const FDialogueAltLine& App : Node->AppendLines)
-            {
-                if (App.Condition.IsEmpty())
-                    continue;
-                if (EvaluateConditionString(App.Condition))
-                {
-                    Result += " ";
-                    Result += App.Text;
-                }
-            }
-
-            return Result;
-        }
+    // Several node changes in one frame (auto-advance, scripted jumps) produce a single UI update
+    bStepQueued = true;
+    World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &UDialogueManager::BroadcastStep));
+}
+
+void UDialogueManager::BroadcastStep()
+{
+    // Cancelled because the dialogue ended in the meantime
+    if (!bStepQueued) return;
+    bStepQueued = false;
+
+    if (!GetCurrentNode()) return;
+
+    FillStep(Step);
+    OnDialogueStep.Broadcast(Step);
+}
+
+void UDialogueManager::FillStep(FDialogueStep& Out) const
+{
+    Out.NodeID = CurrentNodeID;
+    Out.Speaker = GetCurrentSpeaker();
+    Out.Line = GetCurrentLine();
+    FillChoices(Out.Choices);
+    Out.Assets = GetCurrentAssets();
+}
+
+void UDialogueManager::FinishDialogue()
+{
+    CancelLinkLoad();
+    bStepQueued = false;
+    Session.End();
+    if (IsNetServer())
+    {
+        ReplicatedNodeIndex = INDEX_NONE;
     }
+    CancelSpeculation();
+    AssetPrefetcher.Reset();
+
+    // Effects of the last choice
+    PublishState();
+    RecordOutcome();
+    SaveRecording();
+    TRACE_BOOKMARK(TEXT("Dialogue end: %s"), *CurrentNodeID);
+    OnDialogueEnded.Broadcast();
+}
+
+void UDialogueManager::LaunchSpeculation()
+{
+    CancelSpeculation();
 
-    // No replacement found; use BaseLine and append appendLines that match
-    FString Base = Node->BaseLine;
-    for (const FDialogueAltLine& App : Node->AppendLines)
+    // Clients never resolve a step ahead of the server
+    if (bSpeculateSuccessors && GetCurrentNode() && !IsNetClient())
     {
-        if (App.Condition.IsEmpty())
-            continue;
-        if (EvaluateConditionString(App.Condition))
-        {
-            Base += " ";
-            Base += App.Text;
-        }
+        Speculation = FDialogueSpeculation::Launch(Session.GetGraph(), Session.GetNodeIndex(), Session.GetState(), bShowLockedChoices);
     }
+}
 
-    return Base;
+void UDialogueManager::CancelSpeculation()
+{
+    if (Speculation)
+    {
+        Speculation->Cancel();
+        Speculation.Reset();
+    }
+}
+
+bool UDialogueManager::TryEnterSpeculatedBranch(int32 ChoiceIndex, bool bFailure)
+{
+    // Never wait for the worker; resolving on the spot is no slower than before
+    if (!Speculation || !Speculation->IsReady()) return false;
+
+    const int32 Target = Session.AdoptSpeculated(*Speculation, ChoiceIndex, bFailure, bShowLockedChoices);
+    if (Target == INDEX_NONE) return false;
+
+    EnterNode(Target);
+    return true;
+}
+
+void UDialogueManager::SwitchGraph(FDialogueGraphRef InGraph)
+{
+    // Node indices, cached results and resolved text are all per graph
+    Session.SetGraph(MoveTemp(InGraph));
+    CancelSpeculation();
+    AssetPrefetcher.Reset();
+}
+
+void UDialogueManager::SetActiveGraph(FDialogueGraphRef InGraph)
+{
+    SwitchGraph(InGraph ? MoveTemp(InGraph) : OwnGraph); // own graph as fallback
+}
+
+FString UDialogueManager::GetCurrentSpeaker() const
+{
+    return GetCurrentNode() ? Session.GetSpeaker() : FString(TEXT("???"));
+}
+
+FString UDialogueManager::GetCurrentLine() const
+{
+    if (!GetCurrentNode())
+        return FString("Node not found!");
+
+    return Session.GetLine();
+}
+
+FDialogueNodeAssets UDialogueManager::GetCurrentAssets() const
+{
+    const FDialogueGraphRef& ActiveGraph = Session.GetGraph();
+    return ActiveGraph ? UDialogueDataLoader::GetNodeAssets(*ActiveGraph, Session.GetNodeIndex()) : FDialogueNodeAssets();
+}
+
+TConstArrayView<FDialogueResolvedChoice> UDialogueManager::GetResolvedChoices() const
+{
+    return Session.GetChoices(bShowLockedChoices);
 }
 
 TArray<FDialogueChoice> UDialogueManager::GetAvailableChoices() const
 {
     TArray<FDialogueChoice> Result;
+    FillChoices(Result);
+    return Result;
+}
 
-    const FDialogueNode* Node = GetCurrentNode();
-    if (!Node) return Result;
-
-    for (const FDialogueChoice& Choice : Node->Choices)
+void UDialogueManager::FillChoices(TArray<FDialogueChoice>& Out) const
+{
+    const TConstArrayView<FDialogueResolvedChoice> Resolved = GetResolvedChoices();
+    const FDialogueGraph* ActiveGraph = Session.GetGraph().Get();
+
+    // Only what the UI needs; alt texts, requirements and effects stay compiled in the graph and
+    // their source text isn't kept, so those fields are left empty (documented on GetAvailableChoices)
+    TStringBuilder<256> Text;
+    Out.SetNum(Resolved.Num());
+    for (int32 Index = 0; Index < Resolved.Num(); ++Index)
     {
-        // Check requirements (all must pass). Empty requirements => unlocked.
-        bool bUnlocked = true;
-        for (const FString& Req : Choice.Requirements)
+        const FDialogueGraphChoice& Choice = Session.GetAuthoredChoice(Resolved[Index]);
+        FDialogueChoice& Entry = Out[Index];
+
+        // Reset + Append keeps each string's buffer from the last step
+        Text.Reset();
+        Session.AppendChoiceText(Resolved[Index], Text);
+        Entry.Text.Reset();
+        Entry.Text.Append(Text.GetData(), Text.Len());
+        Entry.NextNodeID.Reset();
+        if (FDialogueGraph::IsExternalLink(Choice.Next))
         {
-            if (!Req.IsEmpty() && !EvaluateConditionString(Req))
-            {
-                bUnlocked = false;
-                break;
-            }
+            Entry.NextNodeID = ActiveGraph->GetLinkId(Choice.Next);
         }
-
-        // If not unlocked, we skip adding it to available list (alternatively you could add disabled entries)
-        if (!bUnlocked) continue;
-
-        // Resolve alt text for choice
-        FString FinalText = Choice.Text;
-        for (const FDialogueAltText& AltText : Choice.AltTexts)
+        else if (Choice.Next != INDEX_NONE)
         {
-            if (!AltText.Condition.IsEmpty() && EvaluateConditionString(AltText.Condition))
-            {
-                FinalText = AltText.Text;
-                break;
-            }
+            const FStringView NextId = ActiveGraph->GetNodeId(Choice.Next);
+            Entry.NextNodeID.Append(NextId.GetData(), NextId.Len());
         }
-
-        FDialogueChoice Resolved = Choice;
-        Resolved.Text = FinalText;
-        Result.Add(Resolved);
+        Entry.FailureNodeID.Reset();
+        if (FDialogueGraph::IsExternalLink(Choice.Failure))
+        {
+            Entry.FailureNodeID = ActiveGraph->GetLinkId(Choice.Failure);
+        }
+        else if (Choice.Failure != INDEX_NONE)
+        {
+            const FStringView FailureId = ActiveGraph->GetNodeId(Choice.Failure);
+            Entry.FailureNodeID.Append(FailureId.GetData(), FailureId.Len());
+        }
+        Entry.bLocked = Resolved[Index].bLocked;
     }
-
-    return Result;
 }
 
 void UDialogueManager::SelectChoice(int32 ChoiceIndex)
 {
-    UE_LOG(LogTemp, Warning, TEXT("DialogueManager::SelectChoice(%d)  CurrentNode=%s"), ChoiceIndex, *CurrentNodeID);
+    UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager::SelectChoice(%d)  CurrentNode=%s"), ChoiceIndex, *CurrentNodeID);
+
+    // Still moving to another file
+    if (LinkLoadHandle.IsValid()) return;
+
+    if (IsNetClient())
+    {
+        Server_SelectChoice(Session.GetNodeIndex(), ChoiceIndex);
+        return;
+    }
+
+    const TConstArrayView<FDialogueResolvedChoice> Available = GetResolvedChoices();
+    if (!Available.IsValidIndex(ChoiceIndex)) return;
 
-    TArray<FDialogueChoice> Choices = GetAvailableChoices();
-    if (!Choices.IsValidIndex(ChoiceIndex)) return;
+    RecordInput(EDialogueRecordedInput::SelectChoice, ChoiceIndex);
 
-    const FDialogueChoice& Choice = Choices[ChoiceIndex];
+    // Locked choices are only listed with bShowLockedChoices; they lead to the failure branch if there is one
+    const FDialogueResolvedChoice Resolved = Available[ChoiceIndex];
+    if (TryEnterSpeculatedBranch(Resolved.ChoiceIndex, Resolved.bLocked)) return;
 
-    // Apply effects
-    ApplyEffects(Choice.Effects);
+    // Applies the effects of an unlocked choice
+    const int32 Link = Session.TakeChoice(Resolved);
 
     // Advance to next node
-    if (!Choice.NextNodeID.IsEmpty())
+    if (Link != INDEX_NONE)
     {
-        CurrentNodeID = Choice.NextNodeID;
-        StartDialogue(CurrentNodeID);
+        FollowLink(Link);
     }
-    else
+    else if (!Resolved.bLocked)
     {
         // No next node - end of dialogue
-        if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 4.f, FColor::Cyan, TEXT("Dialogue end."));
-        OnDialogueEnded.Broadcast();
+        FinishDialogue();
+    }
+    else
+    {
+        // Locked with nowhere to fail to: stay on the node, and show it again so a UI that reacted
+        // to the click isn't left waiting for a step
+        UE_LOG(LogDialogue, Log, TEXT("DialogueManager: choice %d of '%s' is locked and has no failure branch"), ChoiceIndex, *CurrentNodeID);
+        QueueStep();
     }
 }
 
 void UDialogueManager::AdvanceDialogue()
 {    
-    const FDialogueNode* Node = GetCurrentNode();
+    if (LinkLoadHandle.IsValid()) return;
+
+    if (IsNetClient())
+    {
+        Server_AdvanceDialogue(Session.GetNodeIndex());
+        return;
+    }
+
+    const FDialogueGraphNode* Node = GetCurrentNode();
     if (!Node)
     {
-        if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Red, TEXT("AdvanceDialogue: current node not found"));
+        UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager::AdvanceDialogue: current node not found"));
         return;
     }
 
-    // If current node has no choices but has a NextNodeID, jump to it.
-    if (Node->Choices.Num() == 0)
+    RecordInput(EDialogueRecordedInput::Advance);
+
+    // If current node has no choices but has a next node, jump to it.
+    if (Node->Choices.Num == 0)
     {
-        if (!Node->NextNodeID.IsEmpty())
+        if (Node->Next != INDEX_NONE)
         {
-            StartDialogue(Node->NextNodeID);
+            if (TryEnterSpeculatedBranch(INDEX_NONE, false)) return;
+            FollowLink(Node->Next);
             return;
         }
         else
         {
-            // If no choice and no NextNodeID, we assume it is the end
-            if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Cyan, TEXT("AdvanceDialogue: end of dialogue"));
-            OnDialogueEnded.Broadcast();
+            // If no choice and no next node, we assume it is the end
+            FinishDialogue();
             return;
         }
     }
 
-    // If current node has choices, prompt player to choose
-    if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Yellow, TEXT("AdvanceDialogue: node has choices — press a number key"));
+    // If current node has choices, the player has to pick one
+    UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager::AdvanceDialogue: node '%s' has choices"), *CurrentNodeID);
 }
 
-bool UDialogueManager::LoadDialogueFromJSON(const FString& RelativePath)
+bool UDialogueManager::Server_SelectChoice_Validate(int32 NodeIndex, int32 ChoiceIndex)
 {
-    TMap<FString, FDialogueNode> Temp;
-    UDialogueDataLoader* Loader = NewObject<UDialogueDataLoader>(this);
-    if (!Loader) return false;
+    return NodeIndex >= INDEX_NONE && ChoiceIndex >= 0;
+}
 
-    const bool bOK = Loader->LoadDialogueFromFile(RelativePath, Temp);
-    if (!bOK) return false;
+void UDialogueManager::Server_SelectChoice_Implementation(int32 NodeIndex, int32 ChoiceIndex)
+{
+    if (!Session.IsActive() || NodeIndex != Session.GetNodeIndex())
+    {
+        UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager: dropped choice %d made on node %d, current node is %d"), ChoiceIndex, NodeIndex, Session.GetNodeIndex());
+        return;
+    }
+    if (!GetResolvedChoices().IsValidIndex(ChoiceIndex))
+    {
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: client selected choice %d on node '%s', which isn't available"), ChoiceIndex, *CurrentNodeID);
+        return;
+    }
 
-    OwnDialogueMap = MoveTemp(Temp);
-    return true;
+    SelectChoice(ChoiceIndex);
 }
 
-bool UDialogueManager::EvaluateConditionString(const FString& Condition) const
+bool UDialogueManager::Server_AdvanceDialogue_Validate(int32 NodeIndex)
 {
-    if (Condition.IsEmpty()) return false;
+    return NodeIndex >= INDEX_NONE;
+}
 
-    // Handle OR groups split by "||"
-    TArray<FString> OrParts;
-    SplitBySubstring(Condition, TEXT("||"), OrParts);
+void UDialogueManager::Server_AdvanceDialogue_Implementation(int32 NodeIndex)
+{
+    if (!Session.IsActive() || NodeIndex != Session.GetNodeIndex())
+    {
+        UE_LOG(LogDialogue, Verbose, TEXT("DialogueManager: dropped advance from node %d, current node is %d"), NodeIndex, Session.GetNodeIndex());
+        return;
+    }
+
+    AdvanceDialogue();
+}
+
+void UDialogueManager::RecordInput(EDialogueRecordedInput Input, int32 ChoiceIndex)
+{
+    if (!Recording) return;
+
+    FDialogueRecordedStep& RecordedStep = Recording->Steps.AddDefaulted_GetRef();
+    RecordedStep.Input = Input;
+    RecordedStep.ChoiceIndex = ChoiceIndex;
+
+    // Inputs that change nothing (a locked choice without a failure branch) keep the outcome from before them;
+    // the node the input leads to overwrites it once entered
+    RecordOutcome();
+}
+
+void UDialogueManager::RecordOutcome()
+{
+    if (!Recording || Recording->Steps.Num() == 0) return;
 
-    for (const FString& OrPartRaw : OrParts)
+    FDialogueRecordedStep& RecordedStep = Recording->Steps.Last();
+    RecordedStep.NodeIndex = Session.IsActive() ? Session.GetNodeIndex() : INDEX_NONE;
+    RecordedStep.LineHash = FDialogueRecording::HashLine(Session.IsActive() ? Session.GetLine() : FString());
+    RecordedStep.StateHash = FDialogueRecording::HashState(Session.GetState());
+}
+
+void UDialogueManager::SaveRecording()
+{
+    if (!Recording) return;
+
+    const FString Name = FPaths::GetBaseFilename(Recording->GraphPath) + FDateTime::Now().ToString(TEXT("_%Y%m%d_%H%M%S_%s"));
+    LastRecordingPath = FPaths::ProjectSavedDir() / TEXT("DialogueRecordings") / Name + TEXT(".dlgrec");
+    if (Recording->SaveToFile(LastRecordingPath))
+    {
+        UE_LOG(LogDialogue, Log, TEXT("DialogueManager: recorded %d steps to %s"), Recording->Steps.Num(), *LastRecordingPath);
+    }
+    else
     {
-        // Each OrPart may contain && clauses
-        TArray<FString> AndParts;
-        SplitBySubstring(OrPartRaw, TEXT("&&"), AndParts);
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: can't write %s"), *LastRecordingPath);
+    }
+    Recording.Reset();
+}
 
-        bool bAndAllTrue = true;
-        for (FString AndPart : AndParts)
-        {
-            FString Expr = Trim(AndPart);
-            if (Expr.IsEmpty()) continue;
-            if (!EvaluateSingleExpression(Expr))
-            {
-                bAndAllTrue = false;
-                break;
-            }
-        }
+void UDialogueManager::SetState(const FDialogueState& InState)
+{
+    // Successors resolved against the old state are no good, whatever its version said
+    CancelSpeculation();
+    Session.SetState(InState);
+    PublishState();
+
+    if (Session.IsActive())
+    {
+        LaunchSpeculation();
+        QueueStep();
+    }
+}
+
+void UDialogueManager::PublishState()
+{
+    StatePublisher->Publish(Session.GetState());
+    if (IsNetServer())
+    {
+        ReplicatedState.Update(Session.GetState());
+    }
+}
 
-        if (bAndAllTrue)
+void UDialogueManager::HandleReplicatedAttribute(FName Attribute, const FDialogueValue& Value)
+{
+    FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const int32 Slot = Value.Type == EDialogueValueType::None ? Registry.Find(Attribute) : Registry.FindOrAdd(Attribute, Value.Type);
+    if (Slot == INDEX_NONE)
+    {
+        if (Value.Type != EDialogueValueType::None)
         {
-            // One OR branch succeeded
-            return true;
+            UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: replicated attribute doesn't match the local declarations: %s"), *Registry.DescribeRejection(Attribute, Value.Type));
         }
+        return;
     }
 
-    // No OR branch succeeded
-    return false;
+    Session.SetValue(Slot, Value);
+    StatePublisher->Publish(Session.GetState());
+
+    // Node changes re-resolve in OnRep_ReplicatedNodeIndex, which runs after the attributes of the same update;
+    // this covers changes made on the server while the node stays
+    if (Session.IsActive())
+    {
+        QueueStep();
+    }
 }
 
-bool UDialogueManager::EvaluateSingleExpression(const FString& Expr) const
+void UDialogueManager::OnRep_ReplicatedGraphPath()
 {
-    // Find comparator
-    static const TArray<FString> Comparators = { TEXT("=="), TEXT("!="), TEXT(">="), TEXT("<="), TEXT(">"), TEXT("<") };
+    const FDialogueGraphRef& ActiveGraph = Session.GetGraph();
+    if (ReplicatedGraphPath.IsEmpty() || (ActiveGraph && ActiveGraph->SourcePath == ReplicatedGraphPath))
+    {
+        ApplyReplicatedNode();
+        return;
+    }
 
-    int32 FoundPos = INDEX_NONE;
-    FString FoundComp;
+    UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this);
+    if (!GraphSubsystem) return;
 
-    for (const FString& Comp : Comparators)
+    // Asset graphs report their object path, file graphs their path under Content
+    GraphSubsystem->CancelLoad(LinkLoadHandle);
+    const FOnDialogueGraphLoaded OnLoaded = FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueManager::HandleReplicatedGraphLoaded);
+    LinkLoadHandle = ReplicatedGraphPath.StartsWith(TEXT("/"))
+        ? GraphSubsystem->LoadGraphAssetAsync(TSoftObjectPtr<UDialogueGraphAsset>(FSoftObjectPath(ReplicatedGraphPath)), OnLoaded)
+        : GraphSubsystem->LoadGraphAsync(ReplicatedGraphPath, OnLoaded);
+}
+
+void UDialogueManager::HandleReplicatedGraphLoaded(FDialogueGraphRef Graph)
+{
+    LinkLoadHandle.Reset();
+    if (!Graph)
+    {
+        UE_LOG(LogDialogue, Error, TEXT("DialogueManager: failed to load %s, which the server is using"), *ReplicatedGraphPath);
+        return;
+    }
+
+    SwitchGraph(MoveTemp(Graph));
+    ApplyReplicatedNode();
+}
+
+void UDialogueManager::OnRep_ReplicatedNodeIndex()
+{
+    ApplyReplicatedNode();
+}
+
+void UDialogueManager::ApplyReplicatedNode()
+{
+    // Waiting for the graph; the node is applied once it has loaded
+    const FDialogueGraphRef& ActiveGraph = Session.GetGraph();
+    if (LinkLoadHandle.IsValid() || !ActiveGraph || ActiveGraph->SourcePath != ReplicatedGraphPath) return;
+
+    if (ReplicatedNodeIndex == INDEX_NONE)
     {
-        int32 Pos = Expr.Find(Comp, ESearchCase::IgnoreCase, ESearchDir::FromStart);
-        if (Pos != INDEX_NONE)
+        if (Session.IsActive())
         {
-            FoundPos = Pos;
-            FoundComp = Comp;
-            break;
+            FinishDialogue();
         }
+        return;
+    }
+
+    if (!Session.IsActive() || ReplicatedNodeIndex != Session.GetNodeIndex())
+    {
+        EnterNode(ReplicatedNodeIndex);
+    }
+}
+
+bool UDialogueManager::LoadDialogueFromJSON(const FString& RelativePath)
+{
+    // Share the graph with every other user of the same file when a game instance is around
+    UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this);
+    FDialogueGraphRef Graph = GraphSubsystem ? GraphSubsystem->LoadGraph(RelativePath) : UDialogueGraphSubsystem::ParseGraph(RelativePath);
+    if (!Graph) return false;
+
+    OwnGraph = MoveTemp(Graph);
+    return true;
+}
+
+void UDialogueManager::LoadDialogueFromJSONAsync(const FString& RelativePath)
+{
+    UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this);
+    if (!GraphSubsystem)
+    {
+        HandleOwnGraphLoaded(UDialogueGraphSubsystem::ParseGraph(RelativePath));
+        return;
     }
 
-    if (FoundPos == INDEX_NONE)
+    GraphSubsystem->CancelLoad(OwnGraphLoadHandle);
+    OwnGraphLoadHandle = GraphSubsystem->LoadGraphAsync(RelativePath,
+        FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueManager::HandleOwnGraphLoaded));
+}
+
+void UDialogueManager::HandleOwnGraphLoaded(FDialogueGraphRef Graph)
+{
+    OwnGraphLoadHandle.Reset();
+    if (!Graph)
     {
-        // If no comparator found, treat as boolean/flag check (e.g., "FlagName" or "flag == true")
-        FString Key = Trim(Expr);
-        bool bVal = false;
-        const bool* FoundFlag = Flags.Find(Key);
-        if (FoundFlag) return *FoundFlag;
-        // also check equality to string 'true'
-        if (Key.Equals(TEXT("true"), ESearchCase::IgnoreCase)) return true;
-        if (Key.Equals(TEXT("false"), ESearchCase::IgnoreCase)) return false;
-        return false;
+        UE_LOG(LogDialogue, Error, TEXT("DialogueManager: failed to load %s"),
+            DialogueAsset.IsNull() ? *DialogueJSONPath : *DialogueAsset.ToString());
+        PendingStartNodeID.Reset();
+        return;
     }
 
-    FString Left = Trim(Expr.Left(FoundPos));
-    FString Right = Trim(Expr.Mid(FoundPos + FoundComp.Len()));
+    OwnGraph = MoveTemp(Graph);
 
-    // Remove surrounding quotes on Right if present
-    if (Right.StartsWith("\"") && Right.EndsWith("\"") && Right.Len() >= 2)
+    // Set as own dialogue graph for a start
+    if (!Session.GetGraph())
     {
-        Right = Right.Mid(1, Right.Len() - 2);
+        SwitchGraph(OwnGraph);
     }
 
-    // Handle left attribute cases
-    // trust (int)
-    if (Left.Equals(TEXT("trust"), ESearchCase::IgnoreCase))
+    if (!PendingStartNodeID.IsEmpty())
     {
-        int32 RightInt = FCString::Atoi(*Right);
-        if (FoundComp == "==") return Trust == RightInt;
-        if (FoundComp == "!=") return Trust != RightInt;
-        if (FoundComp == ">=") return Trust >= RightInt;
-        if (FoundComp == "<=") return Trust <= RightInt;
-        if (FoundComp == ">") return Trust > RightInt;
-        if (FoundComp == "<") return Trust < RightInt;
-        return false;
+        const FString NodeID = MoveTemp(PendingStartNodeID);
+        PendingStartNodeID.Reset();
+        StartDialogue(NodeID);
     }
+}
 
-    // last_topic (string)
-    if (Left.Equals(TEXT("last_topic"), ESearchCase::IgnoreCase))
+void UDialogueManager::HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph)
+{
+    if (OwnGraph == OldGraph)
     {
-        if (FoundComp == "==") return LastTopic == Right;
-        if (FoundComp == "!=") return LastTopic != Right;
-        // numeric comparisons for strings not supported
-        return false;
+        OwnGraph = NewGraph;
     }
+    if (Session.GetGraph() != OldGraph) return;
 
-    // skill.<name>
-    if (Left.StartsWith(TEXT("skill."), ESearchCase::IgnoreCase))
+    // Steps so far were taken on the old graph, and node indices and the content hash of a graph
+    // reloaded in place don't match a fresh load of the file, so the recording couldn't be replayed
+    if (Recording)
     {
-        FString SkillName = Left.RightChop(6); // remove "skill."
-        const int32* Found = Skills.Find(SkillName);
-        int32 SkillValue = Found ? *Found : 0;
-        int32 RightInt = FCString::Atoi(*Right);
-        if (FoundComp == "==") return SkillValue == RightInt;
-        if (FoundComp == "!=") return SkillValue != RightInt;
-        if (FoundComp == ">=") return SkillValue >= RightInt;
-        if (FoundComp == "<=") return SkillValue <= RightInt;
-        if (FoundComp == ">") return SkillValue > RightInt;
-        if (FoundComp == "<") return SkillValue < RightInt;
-        return false;
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: %s was reloaded, dropping the recording of this conversation."), *Path);
+        Recording.Reset();
     }
 
-    // flags (boolean)
+    const bool bWasActive = Session.IsActive();
+    SwitchGraph(NewGraph);
+
+    const int32 NodeIndex = NewGraph->FindNodeIndex(CurrentNodeID);
+    if (!bWasActive)
     {
-        const bool* Found = Flags.Find(Left);
-        if (Found)
-        {
-            bool RightBool = Right.Equals(TEXT("true"), ESearchCase::IgnoreCase);
-            if (FoundComp == "==") return *Found == RightBool;
-            if (FoundComp == "!=") return *Found != RightBool;
-        }
+        // Keep the last node readable, as before the reload
+        Session.EnterNode(NodeIndex);
+        Session.End();
+        return;
     }
 
-    // fallback: try compare as integers (Left may be an int attr you add later)
-    int32 LeftVal = 0;
-    const int32* Lfound = nullptr;
-    // no general int map in header, so fallback false
-    return false;
+    if (NodeIndex == INDEX_NONE)
+    {
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: node '%s' was removed from %s, ending the dialogue."), *CurrentNodeID, *Path);
+        FinishDialogue();
+        return;
+    }
+
+    // Re-enter so the UI shows the edited line and choices
+    EnterNode(NodeIndex);
+}
+
+int32 UDialogueManager::GetIntAttribute(FName Attribute) const
+{
+    return Session.GetState().GetInt(FDialogueAttributeRegistry::Get().Find(Attribute));
+}
+
+void UDialogueManager::SetIntAttribute(FName Attribute, int32 Value)
+{
+    SetAttribute(Attribute, FDialogueValue::MakeInt(Value));
+}
+
+float UDialogueManager::GetFloatAttribute(FName Attribute) const
+{
+    return Session.GetState().GetFloat(FDialogueAttributeRegistry::Get().Find(Attribute));
+}
+
+void UDialogueManager::SetFloatAttribute(FName Attribute, float Value)
+{
+    SetAttribute(Attribute, FDialogueValue::MakeFloat(Value));
+}
+
+bool UDialogueManager::GetBoolAttribute(FName Attribute) const
+{
+    return Session.GetState().GetBool(FDialogueAttributeRegistry::Get().Find(Attribute));
+}
+
+void UDialogueManager::SetBoolAttribute(FName Attribute, bool bValue)
+{
+    SetAttribute(Attribute, FDialogueValue::MakeBool(bValue));
+}
+
+FName UDialogueManager::GetNameAttribute(FName Attribute) const
+{
+    return Session.GetState().GetName(FDialogueAttributeRegistry::Get().Find(Attribute));
+}
+
+void UDialogueManager::SetNameAttribute(FName Attribute, FName Value)
+{
+    SetAttribute(Attribute, FDialogueValue::MakeName(Value));
+}
+
+static const TCHAR* SkillPrefix = TEXT("skill.");
+
+int32 UDialogueManager::GetTrust() const
+{
+    return GetIntAttribute(TEXT("trust"));
+}
+
+void UDialogueManager::SetTrust(int32 Value)
+{
+    SetIntAttribute(TEXT("trust"), Value);
+}
+
+FString UDialogueManager::GetLastTopic() const
+{
+    const FName Topic = GetNameAttribute(TEXT("last_topic"));
+    return Topic.IsNone() ? FString() : Topic.ToString();
+}
+
+void UDialogueManager::SetLastTopic(const FString& Value)
+{
+    SetNameAttribute(TEXT("last_topic"), FName(*Value));
 }
 
-void UDialogueManager::ApplyEffects(const TArray<FDialogueEffect>& Effects)
+TMap<FString, int32> UDialogueManager::GetSkills() const
 {
-    for (const FDialogueEffect& Eff : Effects)
+    const FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const TArray<FDialogueValue>& Values = Session.GetState().GetValues();
+
+    TMap<FString, int32> Result;
+    for (int32 Slot = 0; Slot < Values.Num(); ++Slot)
     {
-        if (Eff.Attribute.Equals(TEXT("trust"), ESearchCase::IgnoreCase))
-        {
-            if (Eff.Operation == EDialogueEffectOp::Add)
-            {
-                int32 Delta = FCString::Atoi(*Eff.Value);
-                Trust += Delta;
-            }
-            else if (Eff.Operation == EDialogueEffectOp::Set)
-            {
-                Trust = FCString::Atoi(*Eff.Value);
-            }
-        }
-        else if (Eff.Attribute.Equals(TEXT("last_topic"), ESearchCase::IgnoreCase))
-        {
-            if (Eff.Operation == EDialogueEffectOp::Set)
-            {
-                LastTopic = Eff.Value;
-            }
-            else if (Eff.Operation == EDialogueEffectOp::Add)
-            {
-                // treat Add on strings as Set
-                LastTopic = Eff.Value;
-            }
-        }
-        else
+        const FString Name = Registry.GetName(Slot).ToString();
+        if (Values[Slot].Type != EDialogueValueType::None && Name.StartsWith(SkillPrefix, ESearchCase::IgnoreCase))
         {
-            // Generic attribute handling:
-            // If it's a flag, treat Set/Toggle
-            if (Eff.Operation == EDialogueEffectOp::Toggle)
-            {
-                bool* Found = Flags.Find(Eff.Attribute);
-                if (Found)
-                {
-                    *Found = !(*Found);
-                }
-                else
-                {
-                    Flags.Add(Eff.Attribute, true);
-                }
-            }
-            else if (Eff.Operation == EDialogueEffectOp::Set)
-            {
-                // try boolean value
-                if (Eff.Value.Equals(TEXT("true"), ESearchCase::IgnoreCase) || Eff.Value.Equals(TEXT("false"), ESearchCase::IgnoreCase))
-                {
-                    Flags.Add(Eff.Attribute, Eff.Value.Equals(TEXT("true"), ESearchCase::IgnoreCase));
-                }
-                else
-                {
-                    // assume string attribute - for now only last_topic uses string; you can expand with a map
-                }
-            }
-            else if (Eff.Operation == EDialogueEffectOp::Add)
-            {
-                // support skill increments (e.g., skill.observation)
-                if (Eff.Attribute.StartsWith(TEXT("skill."), ESearchCase::IgnoreCase))
-                {
-                    FString SkillName = Eff.Attribute.RightChop(6);
-                    int32 Delta = FCString::Atoi(*Eff.Value);
-                    int32& ValRef = Skills.FindOrAdd(SkillName);
-                    ValRef += Delta;
-                }
-            }
+            Result.Add(Name.RightChop(FCString::Strlen(SkillPrefix)), Session.GetState().GetInt(Slot));
         }
     }
+    return Result;
 }
 
-void UDialogueManager::SplitBySubstring(const FString& Input, const FString& Separator, TArray<FString>& Out) const
+void UDialogueManager::SetSkills(const TMap<FString, int32>& Value)
 {
-    Out.Empty();
-
-    if (Separator.IsEmpty())
+    for (const TPair<FString, int32>& Skill : GetSkills())
     {
-        Out.Add(Input);
-        return;
+        if (!Value.Contains(Skill.Key)) SetIntAttribute(FName(*(FString(SkillPrefix) + Skill.Key)), 0);
     }
-
-    int32 Start = 0;
-    while (true)
+    for (const TPair<FString, int32>& Skill : Value)
     {
-        int32 Found = Input.Find(Separator, ESearchCase::IgnoreCase, ESearchDir::FromStart, Start);
-        if (Found == INDEX_NONE)
-        {
-            Out.Add(Input.Mid(Start));
-            break;
-        }
+        SetIntAttribute(FName(*(FString(SkillPrefix) + Skill.Key)), Skill.Value);
+    }
+}
 
-        Out.Add(Input.Mid(Start, Found - Start));
-        Start = Found + Separator.Len();
-        if (Start >= Input.Len())
+TMap<FString, bool> UDialogueManager::GetFlags() const
+{
+    const FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const TArray<FDialogueValue>& Values = Session.GetState().GetValues();
+
+    TMap<FString, bool> Result;
+    for (int32 Slot = 0; Slot < Values.Num(); ++Slot)
+    {
+        if (Values[Slot].Type == EDialogueValueType::Bool)
         {
-            Out.Add(TEXT(""));
-            break;
+            Result.Add(Registry.GetName(Slot).ToString(), Values[Slot].Int != 0);
         }
     }
+    return Result;
+}
 
-    // Trim each part
-    for (FString& S : Out) S = Trim(S);
+void UDialogueManager::SetFlags(const TMap<FString, bool>& Value)
+{
+    for (const TPair<FString, bool>& Flag : GetFlags())
+    {
+        if (!Value.Contains(Flag.Key)) SetBoolAttribute(FName(*Flag.Key), false);
+    }
+    for (const TPair<FString, bool>& Flag : Value)
+    {
+        SetBoolAttribute(FName(*Flag.Key), Flag.Value);
+    }
 }
 
-FString UDialogueManager::Trim(const FString& In) const
+void UDialogueManager::SetAttribute(FName Attribute, const FDialogueValue& Value)
 {
-    FString Out = In;
-    Out.TrimStartInline();
-    Out.TrimEndInline();
-    return Out;
+    if (IsNetClient())
+    {
+        UE_LOG(LogDialogue, Warning, TEXT("DialogueManager: '%s' can only be set on the server"), *Attribute.ToString());
+        return;
+    }
+
+    FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+    const int32 Slot = Registry.FindOrAdd(Attribute, Value.Type);
+    if (Slot == INDEX_NONE)
+    {
+        UE_LOG(LogDialogue, Error, TEXT("DialogueManager: can't set attribute: %s"), *Registry.DescribeRejection(Attribute, Value.Type));
+        return;
+    }
+
+    // Keep numbers in the slot's own type so conditions read them consistently
+    const EDialogueValueType SlotType = Registry.GetType(Slot);
+    if (SlotType == EDialogueValueType::Int && Value.Type == EDialogueValueType::Float)
+    {
+        Session.SetValue(Slot, FDialogueValue::MakeInt(static_cast<int32>(Value.Float)));
+    }
+    else if (SlotType == EDialogueValueType::Float && Value.Type == EDialogueValueType::Int)
+    {
+        Session.SetValue(Slot, FDialogueValue::MakeFloat(static_cast<float>(Value.Int)));
+    }
+    else
+    {
+        Session.SetValue(Slot, Value);
+    }
+    PublishState();
 }
@@ -0,0 +1,225 @@
+#include "DialogueProximitySubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "Components/BoxComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "DialogueTriggerComponent.h"
+
+UDialogueProximitySubsystem* UDialogueProximitySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UDialogueProximitySubsystem>() : nullptr;
+}
+
+bool UDialogueProximitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDialogueProximitySubsystem::Deinitialize()
+{
+	for (FVolume& Volume : Volumes)
+	{
+		if (UBoxComponent* Box = Volume.Box.Get())
+		{
+			Box->TransformUpdated.Remove(Volume.TransformHandle);
+		}
+	}
+	Volumes.Empty();
+	Cells.Empty();
+	PawnVolumes.Empty();
+	Super::Deinitialize();
+}
+
+TStatId UDialogueProximitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDialogueProximitySubsystem, STATGROUP_Tickables);
+}
+
+int32 UDialogueProximitySubsystem::Register(UDialogueTriggerComponent* Trigger, UBoxComponent* Box)
+{
+	if (!Trigger || !Box) return INDEX_NONE;
+
+	FVolume Volume;
+	Volume.Trigger = Trigger;
+	Volume.Box = Box;
+	const int32 VolumeId = Volumes.Add(MoveTemp(Volume));
+
+	// Moving NPCs re-bin their box on the next update instead of being re-checked every time
+	Volumes[VolumeId].TransformHandle = Box->TransformUpdated.AddWeakLambda(this,
+		[this, VolumeId](USceneComponent*, EUpdateTransformFlags, ETeleportType) { HandleBoxMoved(VolumeId); });
+
+	Bin(VolumeId);
+	return VolumeId;
+}
+
+void UDialogueProximitySubsystem::Unregister(int32 VolumeId)
+{
+	if (!Volumes.IsValidIndex(VolumeId)) return;
+
+	if (UBoxComponent* Box = Volumes[VolumeId].Box.Get())
+	{
+		Box->TransformUpdated.Remove(Volumes[VolumeId].TransformHandle);
+	}
+	Unbin(VolumeId);
+	Volumes.RemoveAt(VolumeId);
+
+	// Forget it without an exit notification; the trigger is going away
+	for (auto& Pair : PawnVolumes)
+	{
+		Pair.Value.RemoveSingle(VolumeId);
+	}
+}
+
+FIntVector UDialogueProximitySubsystem::ToCell(const FVector& Location) const
+{
+	const double Size = FMath::Max(CellSize, 1.f);
+	return FIntVector(FMath::FloorToInt(Location.X / Size), FMath::FloorToInt(Location.Y / Size), FMath::FloorToInt(Location.Z / Size));
+}
+
+void UDialogueProximitySubsystem::Bin(int32 VolumeId)
+{
+	FVolume& Volume = Volumes[VolumeId];
+	const UBoxComponent* Box = Volume.Box.Get();
+	if (!Box) return;
+
+	Volume.Transform = Box->GetComponentTransform();
+	Volume.Extent = Box->GetUnscaledBoxExtent();
+	Volume.bDirty = false;
+
+	const FBox Bounds = FBox(-Volume.Extent, Volume.Extent).TransformBy(Volume.Transform);
+	Volume.MinCell = ToCell(Bounds.Min);
+	Volume.MaxCell = ToCell(Bounds.Max);
+
+	for (int32 X = Volume.MinCell.X; X <= Volume.MaxCell.X; ++X)
+	for (int32 Y = Volume.MinCell.Y; Y <= Volume.MaxCell.Y; ++Y)
+	for (int32 Z = Volume.MinCell.Z; Z <= Volume.MaxCell.Z; ++Z)
+	{
+		Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(VolumeId);
+	}
+}
+
+void UDialogueProximitySubsystem::Unbin(int32 VolumeId)
+{
+	const FVolume& Volume = Volumes[VolumeId];
+	for (int32 X = Volume.MinCell.X; X <= Volume.MaxCell.X; ++X)
+	for (int32 Y = Volume.MinCell.Y; Y <= Volume.MaxCell.Y; ++Y)
+	for (int32 Z = Volume.MinCell.Z; Z <= Volume.MaxCell.Z; ++Z)
+	{
+		const FIntVector Cell(X, Y, Z);
+		if (TArray<int32>* Entries = Cells.Find(Cell))
+		{
+			Entries->RemoveSingleSwap(VolumeId);
+			if (Entries->Num() == 0) Cells.Remove(Cell);
+		}
+	}
+}
+
+void UDialogueProximitySubsystem::HandleBoxMoved(int32 VolumeId)
+{
+	if (Volumes.IsValidIndex(VolumeId))
+	{
+		Volumes[VolumeId].bDirty = true;
+	}
+}
+
+void UDialogueProximitySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) return;
+	TimeSinceUpdate = 0.f;
+
+	for (auto It = Volumes.CreateIterator(); It; ++It)
+	{
+		if (It->bDirty)
+		{
+			Unbin(It.GetIndex());
+			Bin(It.GetIndex());
+		}
+	}
+
+	UpdatePlayers();
+}
+
+void UDialogueProximitySubsystem::UpdatePlayers()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	TArray<int32> Inside;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APawn* Pawn = It->IsValid() ? (*It)->GetPawn() : nullptr;
+		if (!Pawn) continue;
+
+		// Test the pawn's collision cylinder, like an overlap against its capsule would
+		float Radius = 0.f;
+		float HalfHeight = 0.f;
+		Pawn->GetSimpleCollisionCylinder(Radius, HalfHeight);
+		const FVector Location = Pawn->GetActorLocation();
+		const FVector PawnExtent(Radius, Radius, HalfHeight);
+
+		const FIntVector MinCell = ToCell(Location - PawnExtent);
+		const FIntVector MaxCell = ToCell(Location + PawnExtent);
+		const uint32 Stamp = NextQueryStamp++;
+
+		Inside.Reset();
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+		{
+			const TArray<int32>* Entries = Cells.Find(FIntVector(X, Y, Z));
+			if (!Entries) continue;
+
+			for (const int32 VolumeId : *Entries)
+			{
+				FVolume& Volume = Volumes[VolumeId];
+				if (Volume.QueryStamp == Stamp) continue;
+				Volume.QueryStamp = Stamp;
+
+				// Pawn centre in box space against the box grown by the pawn's size
+				const FVector Local = Volume.Transform.InverseTransformPosition(Location);
+				const FVector Scale = Volume.Transform.GetScale3D().GetAbs();
+				const FVector Grown = Volume.Extent + PawnExtent / Scale.ComponentMax(FVector(UE_KINDA_SMALL_NUMBER));
+				if (FMath::Abs(Local.X) <= Grown.X && FMath::Abs(Local.Y) <= Grown.Y && FMath::Abs(Local.Z) <= Grown.Z)
+				{
+					Inside.Add(VolumeId);
+				}
+			}
+		}
+		Inside.Sort();
+
+		TArray<int32>& Previous = PawnVolumes.FindOrAdd(Pawn);
+
+		// Notify after updating our own state, since a notification may unregister volumes
+		TArray<TWeakObjectPtr<UDialogueTriggerComponent>, TInlineAllocator<4>> Entered;
+		TArray<TWeakObjectPtr<UDialogueTriggerComponent>, TInlineAllocator<4>> Exited;
+		for (const int32 VolumeId : Inside)
+		{
+			if (Algo::BinarySearch(Previous, VolumeId) == INDEX_NONE) Entered.Add(Volumes[VolumeId].Trigger);
+		}
+		for (const int32 VolumeId : Previous)
+		{
+			if (Algo::BinarySearch(Inside, VolumeId) == INDEX_NONE && Volumes.IsValidIndex(VolumeId)) Exited.Add(Volumes[VolumeId].Trigger);
+		}
+		Previous = Inside;
+
+		for (const TWeakObjectPtr<UDialogueTriggerComponent>& Trigger : Exited)
+		{
+			if (Trigger.IsValid()) Trigger->HandlePlayerExit(Pawn);
+		}
+		for (const TWeakObjectPtr<UDialogueTriggerComponent>& Trigger : Entered)
+		{
+			if (Trigger.IsValid()) Trigger->HandlePlayerEnter(Pawn);
+		}
+	}
+
+	// Drop pawns that are gone
+	for (auto It = PawnVolumes.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid()) It.RemoveCurrent();
+	}
+}
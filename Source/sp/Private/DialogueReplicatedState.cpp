@@ -0,0 +1,95 @@
+#include "DialogueReplicatedState.h"
+#include "DialogueManager.h"
+
+bool FDialogueReplicatedAttribute::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+    Ar << Attribute;
+
+    uint8 Type = static_cast<uint8>(Value.Type);
+    Ar.SerializeBits(&Type, 3);
+    if (Ar.IsLoading())
+    {
+        Value = FDialogueValue();
+        Value.Type = static_cast<EDialogueValueType>(Type);
+    }
+
+    switch (Value.Type)
+    {
+    case EDialogueValueType::Int:
+    {
+        // Zigzag so small negative values stay small too
+        uint32 Packed = (static_cast<uint32>(Value.Int) << 1) ^ static_cast<uint32>(Value.Int >> 31);
+        Ar.SerializeIntPacked(Packed);
+        Value.Int = static_cast<int32>((Packed >> 1) ^ (0u - (Packed & 1u)));
+        break;
+    }
+    case EDialogueValueType::Bool:
+    {
+        uint8 bSet = Value.Int != 0 ? 1 : 0;
+        Ar.SerializeBits(&bSet, 1);
+        Value.Int = bSet;
+        break;
+    }
+    case EDialogueValueType::Float:
+        Ar << Value.Float;
+        break;
+    case EDialogueValueType::Name:
+        Ar << Value.Name;
+        break;
+    default:
+        break;
+    }
+
+    bOutSuccess = !Ar.IsError();
+    return true;
+}
+
+void FDialogueReplicatedAttribute::PostReplicatedAdd(const FDialogueReplicatedState& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->HandleReplicatedAttribute(Attribute, Value);
+    }
+}
+
+void FDialogueReplicatedAttribute::PostReplicatedChange(const FDialogueReplicatedState& InArraySerializer)
+{
+    if (InArraySerializer.Owner)
+    {
+        InArraySerializer.Owner->HandleReplicatedAttribute(Attribute, Value);
+    }
+}
+
+void FDialogueReplicatedState::Update(const FDialogueState& State)
+{
+    const TArray<FDialogueValue>& Values = State.GetValues();
+    const FDialogueAttributeRegistry& Registry = FDialogueAttributeRegistry::Get();
+
+    // A Reset empties the state; slots past its end read as unset
+    const FDialogueValue Unset;
+    const int32 NumSlots = FMath::Max(Values.Num(), ItemBySlot.Num());
+    for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        const FDialogueValue& Value = Values.IsValidIndex(Slot) ? Values[Slot] : Unset;
+        const int32 ItemIndex = ItemBySlot.IsValidIndex(Slot) ? ItemBySlot[Slot] : INDEX_NONE;
+        if (ItemIndex == INDEX_NONE)
+        {
+            if (Value.Type == EDialogueValueType::None) continue;
+
+            while (ItemBySlot.Num() <= Slot)
+            {
+                ItemBySlot.Add(INDEX_NONE);
+            }
+            FDialogueReplicatedAttribute& Item = Items.AddDefaulted_GetRef();
+            Item.Attribute = Registry.GetName(Slot);
+            Item.Value = Value;
+            ItemBySlot[Slot] = Items.Num() - 1;
+            MarkItemDirty(Item);
+        }
+        else if (Items[ItemIndex].Value != Value)
+        {
+            Items[ItemIndex].Value = Value;
+            MarkItemDirty(Items[ItemIndex]);
+        }
+    }
+}
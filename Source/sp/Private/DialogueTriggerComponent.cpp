@@ -3,10 +3,13 @@
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/PlayerController.h"
-#include "Kismet/GameplayStatics.h"
 #include "DialogueManager.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueDatabaseSubsystem.h"
+#include "DialogueProximitySubsystem.h"
+#include "DialogueStats.h"
 #include "spPlayerController.h"
-#include "Engine/Engine.h"
+#include "spBaseNPC.h"
 
 UDialogueTriggerComponent::UDialogueTriggerComponent()
 {
@@ -27,29 +30,125 @@ void UDialogueTriggerComponent::BeginPlay()
 	AActor* Owner = GetOwner();
 	if (!Owner)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("DialogueTriggerComponent: No owner found."));
+		UE_LOG(LogDialogue, Warning, TEXT("DialogueTriggerComponent: No owner found."));
 		return;
 	}
 
+	UDialogueProximitySubsystem* Proximity = bUseProximityGrid ? UDialogueProximitySubsystem::Get(this) : nullptr;
+	if (TriggerBox && Proximity)
+	{
+		// The grid does the detection; keep the box out of the physics scene
+		TriggerBox->SetGenerateOverlapEvents(false);
+		TriggerBox->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		ProximityVolumeId = Proximity->Register(this, TriggerBox);
+	}
 	// TriggerBox BoxComponent should be already created, not bind it to the event
-	if (TriggerBox)
+	else if (TriggerBox)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("DialogueTriggerComponent: TriggerBox exists!"));
+		UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: binding overlaps of %s"), *TriggerBox->GetName());
 		TriggerBox->OnComponentBeginOverlap.AddDynamic(this, &UDialogueTriggerComponent::OnOverlapBegin);
+		TriggerBox->OnComponentEndOverlap.AddDynamic(this, &UDialogueTriggerComponent::OnOverlapEnd);
 	}
 	else
 	{
-		UE_LOG(LogTemp, Error, TEXT("DialogueTriggerComponent: TriggerBox is null!"));
+		UE_LOG(LogDialogue, Error, TEXT("DialogueTriggerComponent: TriggerBox is null!"));
+	}
+
+	// Load dialogue data off the game thread (shared with every other trigger using the same file)
+	if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
+	{
+		GraphReloadedHandle = GraphSubsystem->OnGraphReloaded.AddUObject(this, &UDialogueTriggerComponent::HandleGraphReloaded);
+
+		if (!DialogueAsset.IsNull())
+		{
+			GraphLoadHandle = GraphSubsystem->LoadGraphAssetAsync(DialogueAsset,
+				FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueTriggerComponent::HandleGraphLoaded));
+		}
+		else if (UDialogueDatabaseSubsystem* Database = UDialogueDatabaseSubsystem::Get(this);
+			Database && !DialogueFilePath.IsEmpty() && Database->IsPaged(DialogueFilePath))
+		{
+			// The database pages the chapter in as players approach
+			bPagedGraph = true;
+			Database->RegisterTrigger(this);
+		}
+		else if (!DialogueFilePath.IsEmpty())
+		{
+			GraphLoadHandle = GraphSubsystem->LoadGraphAsync(DialogueFilePath,
+				FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueTriggerComponent::HandleGraphLoaded));
+		}
+	}
+}
+
+void UDialogueTriggerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this))
+	{
+		GraphSubsystem->CancelLoad(GraphLoadHandle);
+		GraphSubsystem->OnGraphReloaded.Remove(GraphReloadedHandle);
 	}
+	GraphReloadedHandle.Reset();
+	PendingPlayer.Reset();
 
-	// Load dialogue data (using the loader class)
-	if (!DialogueFilePath.IsEmpty())
+	if (bPagedGraph)
 	{
-		UDialogueDataLoader* Loader = NewObject<UDialogueDataLoader>(this);
-		if (Loader)
+		if (UDialogueDatabaseSubsystem* Database = UDialogueDatabaseSubsystem::Get(this))
 		{
-			Loader->LoadDialogueFromFile(DialogueFilePath, DialogueData);
+			Database->UnregisterTrigger(this);
 		}
+		bPagedGraph = false;
+	}
+
+	if (ProximityVolumeId != INDEX_NONE)
+	{
+		if (UDialogueProximitySubsystem* Proximity = UDialogueProximitySubsystem::Get(this))
+		{
+			Proximity->Unregister(ProximityVolumeId);
+		}
+		ProximityVolumeId = INDEX_NONE;
+	}
+
+	// Release our reference; the graph is freed once no one else uses it
+	DialogueGraph.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+void UDialogueTriggerComponent::HandleGraphLoaded(FDialogueGraphRef Graph)
+{
+	GraphLoadHandle.Reset();
+	DialogueGraph = Graph;
+	if (!DialogueGraph)
+	{
+		UE_LOG(LogDialogue, Error, TEXT("DialogueTriggerComponent: failed to load %s"),
+			DialogueAsset.IsNull() ? *DialogueFilePath : *DialogueAsset.ToString());
+	}
+
+	// Someone was already waiting in the trigger
+	if (ACharacter* PlayerChar = PendingPlayer.Get())
+	{
+		PendingPlayer.Reset();
+		if (DialogueGraph)
+		{
+			BeginDialogueFor(PlayerChar);
+		}
+	}
+}
+
+void UDialogueTriggerComponent::LoadPagedGraph()
+{
+	UDialogueGraphSubsystem* GraphSubsystem = UDialogueGraphSubsystem::Get(this);
+	if (!GraphSubsystem || DialogueGraph || GraphLoadHandle.IsValid()) return;
+
+	// Immediate when the chapter is resident; otherwise the player waits for one parse
+	GraphLoadHandle = GraphSubsystem->LoadGraphAsync(DialogueFilePath,
+		FOnDialogueGraphLoaded::CreateUObject(this, &UDialogueTriggerComponent::HandleGraphLoaded));
+}
+
+void UDialogueTriggerComponent::HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph)
+{
+	// Node ids are what we keep (StartingNodeID), so nothing else needs remapping
+	if (DialogueGraph == OldGraph)
+	{
+		DialogueGraph = NewGraph;
 	}
 }
 
@@ -58,14 +157,29 @@ void UDialogueTriggerComponent::OnOverlapBegin(
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex,
 	bool bFromSweep, const FHitResult& SweepResult)
 {
-    // Quick visual debug so we know the function fired
-	if (GEngine)
+	UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: overlap of %s by %s"), *OverlappedComp->GetName(), *GetNameSafe(OtherActor));
+
+	HandlePlayerEnter(OtherActor);
+}
+
+void UDialogueTriggerComponent::OnOverlapEnd(
+	UPrimitiveComponent* OverlappedComp, AActor* OtherActor,
+	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	HandlePlayerExit(OtherActor);
+}
+
+void UDialogueTriggerComponent::HandlePlayerExit(AActor* OtherActor)
+{
+	// Left before the graph finished loading: don't pull them back into a dialogue
+	if (OtherActor && PendingPlayer.Get() == OtherActor)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 3.f, FColor::Red, TEXT("DialogueTriggerComponent::OnOverlapBegin"));
+		PendingPlayer.Reset();
 	}
-	
-	UE_LOG(LogTemp, Warning, TEXT("Overlap fired by: %s"), *OverlappedComp->GetName());
+}
 
+void UDialogueTriggerComponent::HandlePlayerEnter(AActor* OtherActor)
+{
 	if (!OtherActor || OtherActor == GetOwner()) return;
 
 	// Only trigger the following logic if it is player character overlapping it
@@ -79,13 +193,61 @@ void UDialogueTriggerComponent::OnOverlapBegin(
 	UDialogueManager* DM = PC->FindComponentByClass<UDialogueManager>();
 	if (!DM)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("DialogueTriggerComponent: DialogueManager not found on PlayerController"));
+		UE_LOG(LogDialogue, Warning, TEXT("DialogueTriggerComponent: DialogueManager not found on PlayerController"));
 		return;
 	}
 
-	if (DialogueData.Num() <= 0)
+	if (bPagedGraph)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("DialogueTriggerComponent: DialogueData empty, cannot start dialogue."));
+		LoadPagedGraph();
+	}
+
+	// One conversation per trigger: the NPC is busy until the current one ends
+	if (IsBusyWith(PlayerChar)) return;
+
+	// Dialogue must not start before its graph is ready; start it when the load finishes
+	if (GraphLoadHandle.IsValid())
+	{
+		UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: dialogue still loading, starting once ready."));
+		PendingPlayer = PlayerChar;
+		return;
+	}
+
+	BeginDialogueFor(PlayerChar);
+}
+
+bool UDialogueTriggerComponent::IsBusyWith(const ACharacter* PlayerChar) const
+{
+	const AActor* Other = nullptr;
+	if (const APlayerController* PC = DialogueController.Get())
+	{
+		Other = PC != PlayerChar->GetController() ? PC : nullptr;
+	}
+	else if (const ACharacter* Pending = PendingPlayer.Get())
+	{
+		Other = Pending != PlayerChar ? Pending : nullptr;
+	}
+
+	if (Other)
+	{
+		UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: %s is talking to %s, ignoring %s."),
+			*GetNameSafe(GetOwner()), *GetNameSafe(Other), *GetNameSafe(PlayerChar));
+	}
+	return Other != nullptr;
+}
+
+void UDialogueTriggerComponent::BeginDialogueFor(ACharacter* PlayerChar)
+{
+	APlayerController* PC = PlayerChar ? Cast<APlayerController>(PlayerChar->GetController()) : nullptr;
+	UDialogueManager* DM = PC ? PC->FindComponentByClass<UDialogueManager>() : nullptr;
+	if (!DM) return;
+
+	// The end of the running conversation is only tracked for one player
+	if (DialogueController.IsValid()) return;
+
+	if (!DialogueGraph || DialogueGraph->NumNodes() <= 0)
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("DialogueTriggerComponent: DialogueGraph empty, cannot start dialogue."));
 		return;
 	}
 
@@ -109,36 +271,56 @@ void UDialogueTriggerComponent::OnOverlapBegin(
 	}
 
 	// Preparation 3: bind dialogue end handler to DM's dialogue end event
+	DialoguePlayer = PlayerChar;
+	DialogueController = PC;
 	DM->OnDialogueEnded.AddDynamic(this, &UDialogueTriggerComponent::HandleDialogueEnded);
 
-	UE_LOG(LogTemp, Log, TEXT("DialogueTriggerComponent: Starting dialogue."));
+	// Preparation 4: keep the speaking NPC at full tick and animation rate
+	if (AspBaseNPC* NPC = Cast<AspBaseNPC>(GetOwner()))
+	{
+		NPC->SetInConversation(true);
+	}
+
+	UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: Starting dialogue."));
     // Start dialogue (use the node id defined in the json we want to use)
-	DM->StartDialogue(StartingNodeID, &DialogueData);
+	DM->StartDialogue(StartingNodeID, DialogueGraph);
 }
 
 void UDialogueTriggerComponent::HandleDialogueEnded()
 {
-	UE_LOG(LogTemp, Log, TEXT("DialogueTriggerComponent: HandleDialogueEnded called."));
+	UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: HandleDialogueEnded called."));
 
 	// Unbind from DialogueManager on the player controller (safe remove)
-	APlayerController* PC = UGameplayStatics::GetPlayerController(this, 0);
-	if (PC)
+	if (APlayerController* PC = DialogueController.Get())
 	{
 		if (UDialogueManager* DM = PC->FindComponentByClass<UDialogueManager>())
 		{
 			DM->OnDialogueEnded.RemoveDynamic(this, &UDialogueTriggerComponent::HandleDialogueEnded);
-			UE_LOG(LogTemp, Log, TEXT("DialogueTriggerComponent: Unbound from DM %p"), DM);
+			UE_LOG(LogDialogue, Verbose, TEXT("DialogueTriggerComponent: Unbound from DM %p"), DM);
 		}
 	}
 
 	// Restore movement
-	if (ACharacter* PlayerChar = UGameplayStatics::GetPlayerCharacter(this, 0))
+	if (ACharacter* PlayerChar = DialoguePlayer.Get())
 	{
 		if (PlayerChar->GetCharacterMovement())
 		{
 			PlayerChar->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
 		}
 	}
+	DialoguePlayer.Reset();
+	DialogueController.Reset();
+
+	if (AspBaseNPC* NPC = Cast<AspBaseNPC>(GetOwner()))
+	{
+		NPC->SetInConversation(false);
+	}
+
+	// Let the database decide whether the graph stays in memory
+	if (bPagedGraph)
+	{
+		DialogueGraph.Reset();
+	}
     // UI mode resume will be done in spPlayerController
 }
 
@@ -147,6 +329,7 @@ void UDialogueTriggerComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
 	if (TriggerBox)
 	{
 		TriggerBox->OnComponentBeginOverlap.RemoveAll(this);
+		TriggerBox->OnComponentEndOverlap.RemoveAll(this);
 		TriggerBox->DestroyComponent();
 		TriggerBox = nullptr;
 	}
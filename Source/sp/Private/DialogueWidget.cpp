@@ -3,6 +3,8 @@
 
 #include "DialogueWidget.h"
 #include "spPlayerController.h"
+#include "Components/PanelWidget.h"
+#include "DialogueStats.h"
 
 void UDialogueWidget::ShowWidget(bool bShow)
 {
@@ -11,6 +13,8 @@ void UDialogueWidget::ShowWidget(bool bShow)
 
 void UDialogueWidget::UpdateDialogue(const FString& Line, const TArray<FDialogueChoice>& Choices)
 {
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueUpdateUI);
+
 	// Update C++ visible properties (these are BlueprintReadOnly)
 	CurrentLine = FText::FromString(Line);
 	CurrentChoices = Choices;
@@ -19,9 +23,92 @@ void UDialogueWidget::UpdateDialogue(const FString& Line, const TArray<FDialogue
 	OnDialogueUpdated_BP();
 }
 
+void UDialogueWidget::SetChoiceContainer(UPanelWidget* Container)
+{
+	if (Container == ChoiceContainer) return;
+
+	for (UUserWidget* Button : ChoiceButtons)
+	{
+		if (Button) Button->RemoveFromParent();
+	}
+	ChoiceButtons.Reset();
+
+	// Force a full refresh on the next step, in whichever mode
+	CurrentChoices.Reset();
+	CurrentLine = FText::GetEmpty();
+	CurrentSpeaker = FText::GetEmpty();
+
+	ChoiceContainer = Container;
+}
+
+void UDialogueWidget::ApplyStep(const FDialogueStep& Step)
+{
+	if (!ChoiceContainer || !ChoiceButtonClass)
+	{
+		// No button pool: let the Blueprint rebuild everything
+		CurrentSpeaker = FText::FromString(Step.Speaker);
+		UpdateDialogue(Step.Line, Step.Choices);
+		return;
+	}
+
+	DIALOGUE_SCOPE_CYCLE_COUNTER(STAT_DialogueUpdateUI);
+
+	const bool bLineChanged = !CurrentSpeaker.ToString().Equals(Step.Speaker, ESearchCase::CaseSensitive)
+		|| !CurrentLine.ToString().Equals(Step.Line, ESearchCase::CaseSensitive);
+	if (bLineChanged)
+	{
+		CurrentSpeaker = FText::FromString(Step.Speaker);
+		CurrentLine = FText::FromString(Step.Line);
+	}
+
+	// Only create the buttons we don't have yet
+	while (ChoiceButtons.Num() < Step.Choices.Num())
+	{
+		UUserWidget* Button = CreateWidget<UUserWidget>(this, ChoiceButtonClass);
+		ChoiceContainer->AddChild(Button);
+		ChoiceButtons.Add(Button);
+	}
+
+	for (int32 Index = 0; Index < ChoiceButtons.Num(); ++Index)
+	{
+		UUserWidget* Button = ChoiceButtons[Index];
+		if (!Step.Choices.IsValidIndex(Index))
+		{
+			Button->SetVisibility(ESlateVisibility::Collapsed);
+			continue;
+		}
+
+		const FDialogueChoice& Choice = Step.Choices[Index];
+		const bool bWasShown = CurrentChoices.IsValidIndex(Index);
+		if (!bWasShown)
+		{
+			Button->SetVisibility(ESlateVisibility::Visible);
+		}
+		if (!bWasShown || !IsSameChoice(CurrentChoices[Index], Choice))
+		{
+			OnChoiceButtonUpdated_BP(Button, Index, Choice);
+		}
+	}
+
+	CurrentChoices = Step.Choices;
+
+	if (bLineChanged)
+	{
+		OnLineUpdated_BP();
+	}
+}
+
+bool UDialogueWidget::IsSameChoice(const FDialogueChoice& A, const FDialogueChoice& B)
+{
+	return A.bLocked == B.bLocked
+		&& A.Text.Equals(B.Text, ESearchCase::CaseSensitive)
+		&& A.NextNodeID == B.NextNodeID
+		&& A.FailureNodeID == B.FailureNodeID;
+}
+
 void UDialogueWidget::NotifyChoiceSelected(int32 ChoiceIndex)
 {
-	UE_LOG(LogTemp, Warning, TEXT("DialogueWidget: NotifyChoiceSelected(%d)"), ChoiceIndex);
+	UE_LOG(LogDialogue, Verbose, TEXT("DialogueWidget: NotifyChoiceSelected(%d)"), ChoiceIndex);
 	
 	// Call the BP event (Blueprint will handle UI → controller hookup)
 	OnChoiceSelected(ChoiceIndex);
@@ -31,8 +118,9 @@ void UDialogueWidget::NotifyChoiceSelected(int32 ChoiceIndex)
 		if (UDialogueManager* DM = PC->FindComponentByClass<UDialogueManager>())
 		{
 			DM->SelectChoice(ChoiceIndex);
+			return;
 		}
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("DialogueWidget: No DialogueManager found on owning player"));
+	UE_LOG(LogDialogue, Warning, TEXT("DialogueWidget: No DialogueManager found on owning player"));
 }
@@ -0,0 +1,139 @@
+#include "NPCSignificanceSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "spBaseNPC.h"
+
+UNPCSignificanceSubsystem* UNPCSignificanceSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UNPCSignificanceSubsystem>() : nullptr;
+}
+
+bool UNPCSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UNPCSignificanceSubsystem::Deinitialize()
+{
+	NPCs.Empty();
+	Super::Deinitialize();
+}
+
+TStatId UNPCSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNPCSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UNPCSignificanceSubsystem::Register(AspBaseNPC* NPC)
+{
+	if (!NPC) return;
+	NPCs.AddUnique(NPC);
+
+	// Rank newcomers promptly so a freshly spawned crowd doesn't run a frame at full rate for long
+	RequestUpdate();
+}
+
+void UNPCSignificanceSubsystem::Unregister(AspBaseNPC* NPC)
+{
+	NPCs.RemoveSwap(NPC);
+}
+
+void UNPCSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) return;
+	TimeSinceUpdate = 0.f;
+
+	UpdateSignificance();
+}
+
+void UNPCSignificanceSubsystem::UpdateSignificance()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	// Every player's view point (pawn eyes on a server)
+	TArray<FVector, TInlineAllocator<4>> Viewers;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PC = It->Get())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PC->GetPlayerViewPoint(Location, Rotation);
+			Viewers.Add(Location);
+		}
+	}
+
+	struct FRanked
+	{
+		AspBaseNPC* NPC;
+		float Score;
+		bool bInRange;
+	};
+	TArray<FRanked> Ranked;
+	Ranked.Reserve(NPCs.Num());
+
+	const float MaxDistanceSquared = FMath::Square(MaxSignificantDistance);
+	for (int32 Index = NPCs.Num() - 1; Index >= 0; --Index)
+	{
+		AspBaseNPC* NPC = NPCs[Index].Get();
+		if (!NPC)
+		{
+			NPCs.RemoveAtSwap(Index);
+			continue;
+		}
+
+		float DistanceSquared = MaxDistanceSquared * 4.f;
+		const FVector Location = NPC->GetActorLocation();
+		for (const FVector& Viewer : Viewers)
+		{
+			DistanceSquared = FMath::Min(DistanceSquared, static_cast<float>(FVector::DistSquared(Viewer, Location)));
+		}
+
+		// Closer is more significant; on-screen counts four times as much as off-screen.
+		// NPCs in a conversation always come first.
+		const USkeletalMeshComponent* Mesh = NPC->GetMesh();
+		const bool bVisible = Mesh && Mesh->WasRecentlyRendered(0.5f);
+		float Score = (bVisible ? 1.f : 0.25f) / (1.f + FMath::Sqrt(DistanceSquared) / 1000.f);
+		if (NPC->IsInConversation())
+		{
+			Score += 1000.f;
+		}
+
+		Ranked.Add({ NPC, Score, DistanceSquared <= MaxDistanceSquared || NPC->IsInConversation() });
+	}
+
+	Ranked.Sort([](const FRanked& A, const FRanked& B) { return A.Score > B.Score; });
+
+	int32 NumFull = 0;
+	int32 NumReduced = 0;
+	for (const FRanked& Entry : Ranked)
+	{
+		ENPCSignificanceTier Tier;
+		if (Entry.NPC->IsInConversation() || (Entry.bInRange && NumFull < MaxFullRateNPCs))
+		{
+			Tier = ENPCSignificanceTier::Full;
+			++NumFull;
+		}
+		else if (Entry.bInRange && NumReduced < MaxReducedRateNPCs)
+		{
+			Tier = ENPCSignificanceTier::Reduced;
+			++NumReduced;
+		}
+		else
+		{
+			const USkeletalMeshComponent* Mesh = Entry.NPC->GetMesh();
+			Tier = Mesh && Mesh->WasRecentlyRendered(0.5f) ? ENPCSignificanceTier::Minimal : ENPCSignificanceTier::Dormant;
+		}
+
+		const float TickInterval = Tier == ENPCSignificanceTier::Reduced ? ReducedTickInterval
+			: Tier == ENPCSignificanceTier::Minimal ? MinimalTickInterval
+			: 0.f;
+		Entry.NPC->SetSignificanceTier(Tier, TickInterval);
+	}
+}
@@ -0,0 +1,179 @@
+#include "DialogueDataLoader.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DialogueDataLoaderTests
+{
+	// Write Json to a file of its own and parse it the way the game loads dialogue
+	bool Parse(const TCHAR* Name, const FString& Json, TMap<FString, FDialogueNode>& OutNodes)
+	{
+		const FString Path = FPaths::AutomationTransientDir() / Name + TEXT(".json");
+		FFileHelper::SaveStringToFile(Json, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+		const bool bParsed = UDialogueDataLoader::ParseDialogueFileAtPath(Path, OutNodes);
+		IFileManager::Get().Delete(*Path);
+		return bParsed;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueDataLoaderParseTest, "Project.Dialogue.DataLoader.Parse",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueDataLoaderParseTest::RunTest(const FString& Parameters)
+{
+	const FString Json = TEXT(R"json(
+{
+	"start": {
+		"Speaker": "Luka",
+		"BaseLine": "Hello.",
+		"AltLines": [ { "Condition": "trust <= -1", "Text": "What now?" } ],
+		"AppendLines": [ { "Condition": "Clue_Cinema_MainDoor", "Text": "The door was open." } ],
+		"Choices": [
+			{
+				"Text": "Ask.",
+				"AltTexts": [ { "Condition": "trust >= 2", "Text": "Ask, kindly." } ],
+				"Requirements": [ "trust >= 1", "skill.observation >= 1" ],
+				"Effects": [
+					{ "Attribute": "trust", "Operation": "Add", "Value": 1 },
+					{ "Attribute": "Clue_Cinema_MainDoor", "Operation": "Toggle" },
+					{ "Attribute": "last_topic", "Value": "autonomy" }
+				],
+				"NextNodeID": "end",
+				"FailureNodeID": "refused"
+			}
+		],
+		"Assets": { "VoiceOver": "/Game/Audio/VO_Luka_01.VO_Luka_01" },
+		"Notes": { "Author": "someone", "Tags": [ "a", { "b": [ 1, 2 ] } ] }
+	},
+	"end": { "speaker": "Luka", "baseline": "Bye.", "NextNodeID": null }
+}
+)json");
+
+	TMap<FString, FDialogueNode> Nodes;
+	if (!TestTrue(TEXT("file parses"), DialogueDataLoaderTests::Parse(TEXT("DialogueDataLoaderParse"), Json, Nodes))) return false;
+	TestEqual(TEXT("node count"), Nodes.Num(), 2);
+
+	const FDialogueNode* Start = Nodes.Find(TEXT("start"));
+	if (!TestNotNull(TEXT("start node"), Start)) return false;
+	TestEqual(TEXT("id comes from the key"), Start->ID, FString(TEXT("start")));
+	TestEqual(TEXT("speaker"), Start->Speaker, FString(TEXT("Luka")));
+	TestEqual(TEXT("base line"), Start->BaseLine, FString(TEXT("Hello.")));
+	if (TestEqual(TEXT("alt lines"), Start->AltLines.Num(), 1))
+	{
+		TestEqual(TEXT("alt line condition"), Start->AltLines[0].Condition, FString(TEXT("trust <= -1")));
+		TestEqual(TEXT("alt line text"), Start->AltLines[0].Text, FString(TEXT("What now?")));
+	}
+	TestEqual(TEXT("append lines"), Start->AppendLines.Num(), 1);
+	TestFalse(TEXT("voice-over"), Start->Assets.VoiceOver.IsNull());
+	TestTrue(TEXT("no portrait"), Start->Assets.Portrait.IsNull());
+
+	if (TestEqual(TEXT("choices"), Start->Choices.Num(), 1))
+	{
+		const FDialogueChoice& Choice = Start->Choices[0];
+		TestEqual(TEXT("choice text"), Choice.Text, FString(TEXT("Ask.")));
+		TestEqual(TEXT("choice alt texts"), Choice.AltTexts.Num(), 1);
+		TestEqual(TEXT("requirements"), Choice.Requirements.Num(), 2);
+		TestEqual(TEXT("next"), Choice.NextNodeID, FString(TEXT("end")));
+		TestEqual(TEXT("failure"), Choice.FailureNodeID, FString(TEXT("refused")));
+		if (TestEqual(TEXT("effects"), Choice.Effects.Num(), 3))
+		{
+			TestTrue(TEXT("Add operation"), Choice.Effects[0].Operation == EDialogueEffectOp::Add);
+			TestEqual(TEXT("number value read as text"), Choice.Effects[0].Value, FString(TEXT("1")));
+			TestTrue(TEXT("Toggle operation"), Choice.Effects[1].Operation == EDialogueEffectOp::Toggle);
+			TestTrue(TEXT("operation defaults to Set"), Choice.Effects[2].Operation == EDialogueEffectOp::Set);
+		}
+	}
+
+	const FDialogueNode* End = Nodes.Find(TEXT("end"));
+	if (!TestNotNull(TEXT("end node"), End)) return false;
+	TestEqual(TEXT("field names match case-insensitively"), End->BaseLine, FString(TEXT("Bye.")));
+	TestTrue(TEXT("null reads as empty"), End->NextNodeID.IsEmpty());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueDataLoaderMismatchTest, "Project.Dialogue.DataLoader.Mismatch",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueDataLoaderMismatchTest::RunTest(const FString& Parameters)
+{
+	const FString Json = TEXT(R"json(
+{
+	"start": {
+		"BaseLine": "Hello.",
+		"Choices": "not an array",
+		"AltLines": [ "not an object", { "Condition": "true", "Text": "Kept." } ],
+		"Speaker": [ "not", "a", "string" ],
+		"NextNodeID": "end"
+	},
+	"broken": 42,
+	"end": { "BaseLine": "First." },
+	"end": { "BaseLine": "Second." }
+}
+)json");
+
+	// Wrong types are reported and skipped; the rest of the file still loads
+	AddExpectedError(TEXT("'Choices' should be an array"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("an object, ignored"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("'Speaker' should be a string"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("'broken' is not a node object"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("node 'end' is defined twice"), EAutomationExpectedErrorFlags::Contains, 1);
+
+	TMap<FString, FDialogueNode> Nodes;
+	if (!TestTrue(TEXT("file parses"), DialogueDataLoaderTests::Parse(TEXT("DialogueDataLoaderMismatch"), Json, Nodes))) return false;
+	TestEqual(TEXT("the skipped value isn't a node"), Nodes.Num(), 2);
+
+	const FDialogueNode* Start = Nodes.Find(TEXT("start"));
+	if (!TestNotNull(TEXT("start node"), Start)) return false;
+	TestEqual(TEXT("fields after a skipped value are read"), Start->NextNodeID, FString(TEXT("end")));
+	TestEqual(TEXT("mistyped choices are left empty"), Start->Choices.Num(), 0);
+	TestEqual(TEXT("mistyped speaker is left empty"), Start->Speaker, FString());
+	if (TestEqual(TEXT("only the well-formed alt line is kept"), Start->AltLines.Num(), 1))
+	{
+		TestEqual(TEXT("kept alt line"), Start->AltLines[0].Text, FString(TEXT("Kept.")));
+	}
+
+	const FDialogueNode* End = Nodes.Find(TEXT("end"));
+	if (TestNotNull(TEXT("end node"), End))
+	{
+		TestEqual(TEXT("the last definition wins"), End->BaseLine, FString(TEXT("Second.")));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDialogueDataLoaderSyntaxTest, "Project.Dialogue.DataLoader.SyntaxErrors",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDialogueDataLoaderSyntaxTest::RunTest(const FString& Parameters)
+{
+	const TCHAR* Broken[] =
+	{
+		TEXT(" "),
+		TEXT("[ { \"BaseLine\": \"Hello.\" } ]"),
+		TEXT("{ \"start\": { \"BaseLine\": \"Hello.\" }"),
+		TEXT("{ \"start\": { \"BaseLine\" \"Hello.\" } }"),
+		TEXT("{ \"start\": { \"Choices\": [ { \"Text\": \"Ask.\" ] } }"),
+	};
+
+	// Each file logs where it went wrong, then that it failed as a whole
+	AddExpectedError(TEXT("DialogueDataLoaderSyntax"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Broken); ++Index)
+	{
+		TMap<FString, FDialogueNode> Nodes;
+		Nodes.Add(TEXT("stale"));
+		const bool bParsed = DialogueDataLoaderTests::Parse(*FString::Printf(TEXT("DialogueDataLoaderSyntax%d"), Index), Broken[Index], Nodes);
+		TestFalse(FString::Printf(TEXT("'%s' is rejected"), Broken[Index]), bParsed);
+		TestEqual(FString::Printf(TEXT("'%s' leaves no nodes"), Broken[Index]), Nodes.Num(), 0);
+	}
+
+	TMap<FString, FDialogueNode> Nodes;
+	AddExpectedError(TEXT("Failed to load dialogue JSON"), EAutomationExpectedErrorFlags::Contains, 1);
+	TestFalse(TEXT("a missing file is rejected"),
+		UDialogueDataLoader::ParseDialogueFileAtPath(FPaths::AutomationTransientDir() / TEXT("DialogueDataLoaderMissing.json"), Nodes));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -6,7 +6,8 @@
 // Sets default values
 AspBaseNPC::AspBaseNPC()
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Set this character to call Tick() every frame. UNPCSignificanceSubsystem slows it down or turns it off
+	// for NPCs far from the player.
 	PrimaryActorTick.bCanEverTick = true;
 
 	// basic mesh offset for characters
@@ -18,7 +19,24 @@ AspBaseNPC::AspBaseNPC()
 void AspBaseNPC::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	DefaultAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+	if (!bIgnoreSignificance)
+	{
+		if (UNPCSignificanceSubsystem* Significance = UNPCSignificanceSubsystem::Get(this))
+		{
+			Significance->Register(this);
+		}
+	}
+}
+
+void AspBaseNPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNPCSignificanceSubsystem* Significance = UNPCSignificanceSubsystem::Get(this))
+	{
+		Significance->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -35,3 +53,63 @@ void AspBaseNPC::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent
 
 }
 
+
+void AspBaseNPC::SetSignificanceTier(ENPCSignificanceTier Tier, float TickInterval)
+{
+	if (Tier == SignificanceTier && TickInterval == SignificanceTickInterval) return;
+	SignificanceTier = Tier;
+	SignificanceTickInterval = TickInterval;
+
+	USkeletalMeshComponent* MeshComp = GetMesh();
+	switch (Tier)
+	{
+	case ENPCSignificanceTier::Full:
+		SetActorTickEnabled(true);
+		SetActorTickInterval(0.f);
+		MeshComp->SetComponentTickEnabled(true);
+		MeshComp->SetComponentTickInterval(0.f);
+		MeshComp->bEnableUpdateRateOptimizations = false;
+		MeshComp->VisibilityBasedAnimTickOption = DefaultAnimTickOption;
+		break;
+
+	case ENPCSignificanceTier::Reduced:
+		SetActorTickEnabled(true);
+		SetActorTickInterval(TickInterval);
+		MeshComp->SetComponentTickEnabled(true);
+		MeshComp->SetComponentTickInterval(TickInterval);
+		MeshComp->bEnableUpdateRateOptimizations = true;
+		MeshComp->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		break;
+
+	case ENPCSignificanceTier::Minimal:
+		SetActorTickEnabled(false);
+		MeshComp->SetComponentTickEnabled(true);
+		MeshComp->SetComponentTickInterval(TickInterval);
+		MeshComp->bEnableUpdateRateOptimizations = true;
+		MeshComp->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+		break;
+
+	case ENPCSignificanceTier::Dormant:
+		// Still rendered if the camera turns around; the next ranking wakes it up
+		SetActorTickEnabled(false);
+		MeshComp->SetComponentTickEnabled(false);
+		break;
+	}
+}
+
+void AspBaseNPC::SetInConversation(bool bInConversation)
+{
+	if (bIsInConversation == bInConversation) return;
+	bIsInConversation = bInConversation;
+
+	if (bIgnoreSignificance) return;
+	if (bInConversation)
+	{
+		// Don't wait for the next ranking to wake up the NPC being talked to
+		SetSignificanceTier(ENPCSignificanceTier::Full, 0.f);
+	}
+	else if (UNPCSignificanceSubsystem* Significance = UNPCSignificanceSubsystem::Get(this))
+	{
+		Significance->RequestUpdate();
+	}
+}
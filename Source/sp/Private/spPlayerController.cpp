@@ -7,6 +7,7 @@
 #include "Engine/Engine.h"
 #include "InputCoreTypes.h" // for EKeys
 #include "Blueprint/UserWidget.h"
+#include "DialogueStats.h"
 
 AspPlayerController::AspPlayerController()
 {
@@ -65,17 +66,13 @@ void AspPlayerController::HandleDialogueEnded()
 	}
 }
 
-void AspPlayerController::HandleOnDialogueUpdated(const FString& Speaker, const FString& Line)
+void AspPlayerController::HandleDialogueStep(const FDialogueStep& Step)
 {
-	UpdateDialogueUI();
-}
-
-void AspPlayerController::HandleOnChoicesUpdated(const TArray<FDialogueChoice>& Choices)
-{
-	// Rebuild the choice buttons
+	// One resolved payload per step; the widget only touches what changed
 	if (UDialogueWidget* DW = Cast<UDialogueWidget>(DialogueWidgetInstance))
 	{
-		DW->UpdateDialogue(DW->CurrentLine.ToString(), Choices);
+		DW->ShowWidget(true);
+		DW->ApplyStep(Step);
 	}
 }
 
@@ -83,16 +80,12 @@ void AspPlayerController::SelectChoiceByIndex(int32 Index)
 {
 	if (UDialogueManager* DM = FindComponentByClass<UDialogueManager>())
 	{
-		// Print what player is attempting to select
-		if (GEngine)
-			GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Blue, FString::Printf(TEXT("Trying choice %d"), Index));
-
+		UE_LOG(LogDialogue, Verbose, TEXT("spPlayerController: trying choice %d"), Index);
 		DM->SelectChoice(Index);
 	}
 	else
 	{
-		if (GEngine)
-			GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("No DialogueManager component found on PlayerController"));
+		UE_LOG(LogDialogue, Warning, TEXT("spPlayerController: no DialogueManager component found on PlayerController"));
 	}
 }
 
@@ -104,17 +97,16 @@ void AspPlayerController::UpdateDialogueUI()
 	if (!DW) return;
 
 	// Example data pull
-	const FDialogueNode* CurrentNode = DialogueManager->GetCurrentNode();
-	if (!CurrentNode)
+	if (!DialogueManager->GetCurrentNode())
 	{
 		DW->ShowWidget(false);
 		return;
 	}
 
-	// Pass speaker + text + choices to widget
+	// Pass resolved speaker + line + choices to widget
+	DialogueManager->FillStep(UIStep);
 	DW->ShowWidget(true);
-	DW->CurrentSpeaker = FText::FromString(CurrentNode->Speaker);
-	DW->UpdateDialogue(CurrentNode->BaseLine, CurrentNode->Choices);
+	DW->ApplyStep(UIStep);
 }
 
 void AspPlayerController::BeginPlay()
@@ -135,8 +127,7 @@ void AspPlayerController::BeginPlay()
 	{
 		// Bind a delegate to handle necessary processes after a dialogue ends
 		DialogueManager->OnDialogueEnded.AddDynamic(this, &AspPlayerController::HandleDialogueEnded);
-		// Bind update delegates so UI refreshes automatically
-		DialogueManager->OnDialogueUpdated.AddDynamic(this, &AspPlayerController::HandleOnDialogueUpdated);
-		DialogueManager->OnChoicesUpdated.AddDynamic(this, &AspPlayerController::HandleOnChoicesUpdated);
+		// Bind the step delegate so UI refreshes automatically, once per step
+		DialogueManager->OnDialogueStep.AddDynamic(this, &AspPlayerController::HandleDialogueStep);
     }
 }
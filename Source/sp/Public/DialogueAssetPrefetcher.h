@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+#include "DialogueGraph.h"
+
+struct FStreamableHandle;
+
+// Keeps the media of the nodes near the current one streamed in.
+// Every Update walks the graph up to MaxHops links from the current node and requests the
+// voice-over, portrait and montage of each node reached, nearest first. Once the loaded assets
+// take BudgetBytes, farther ones are not requested (or released if already held). Assets still
+// loading count with their size on disk. Assets that leave the window are released.
+class SP_API FDialogueAssetPrefetcher
+{
+public:
+    // Links past the current node to look ahead; 0 only loads the current node's assets
+    int32 MaxHops = 2;
+
+    // Loaded size the window may take. The current node's assets are loaded regardless.
+    int64 BudgetBytes = 64 * 1024 * 1024;
+
+    ~FDialogueAssetPrefetcher() { Reset(); }
+
+    // Move the window to NodeIndex of Graph
+    void Update(const FDialogueGraph& Graph, int32 NodeIndex);
+
+    // Release everything
+    void Reset();
+
+    // Measured size of the assets that finished loading
+    int64 GetLoadedBytes() const;
+
+    int32 NumRequests() const { return Entries.Num(); }
+
+private:
+    struct FEntry
+    {
+        TSharedPtr<FStreamableHandle> Handle;
+
+        // Resource size once loaded, INDEX_NONE until measured
+        int64 Bytes = INDEX_NONE;
+
+        // Counted against the budget until Bytes is measured
+        int64 EstimatedBytes = 0;
+
+        // Update that last wanted this asset
+        uint32 Stamp = 0;
+    };
+
+    static void Release(FEntry& Entry);
+
+    // Package size on disk from the asset registry, or a guess if the registry doesn't know it
+    static int64 EstimateBytes(const FSoftObjectPath& Path);
+
+    TMap<FSoftObjectPath, FEntry> Entries;
+    uint32 NextStamp = 1;
+
+    // Scratch for Update: nodes in walk order with their distance, and assets wanted nearest first
+    TArray<TPair<int32, int32>> Walk;
+    TArray<TPair<FSoftObjectPath, int32>> Wanted;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DialogueGraph.h"
+#include "DialogueCrowdSubsystem.generated.h"
+
+// Identifies a crowd conversation. Stale once the conversation ends and its slot is reused.
+struct FDialogueConversationHandle
+{
+    int32 Index = INDEX_NONE;
+    uint32 Serial = 0;
+
+    bool IsSet() const { return Index != INDEX_NONE; }
+    bool operator==(const FDialogueConversationHandle& Other) const { return Index == Other.Index && Serial == Other.Serial; }
+};
+
+// One ambient NPC-to-NPC conversation: plain data, stepped by UDialogueCrowdSubsystem.
+// Choices are picked at random among the unlocked ones; effects only touch the local state.
+struct FDialogueConversation
+{
+    FDialogueGraphRef Graph;
+    int32 NodeIndex = INDEX_NONE;
+    FDialogueState State;
+    FRandomStream Random;
+
+    // Seconds until the current line is done
+    float TimeLeft = 0.f;
+
+    // Bumped every time the slot is reused
+    uint32 Serial = 0;
+    bool bActive = false;
+    bool bEnded = false;
+};
+
+// A conversation moved to a new line or ended during the last tick
+struct FDialogueCrowdEvent
+{
+    FDialogueConversationHandle Handle;
+
+    // Graph and node the conversation entered; INDEX_NONE node when it ended.
+    // The graph stays valid while the event is being handled.
+    const FDialogueGraph* Graph = nullptr;
+    int32 NodeIndex = INDEX_NONE;
+
+    bool HasEnded() const { return NodeIndex == INDEX_NONE; }
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDialogueCrowdEvents, TConstArrayView<FDialogueCrowdEvent>);
+
+/**
+ * Runs background chatter between NPCs off the same graphs the player uses, without a
+ * UDialogueManager per conversation. Conversations are plain structs in one pooled array and are
+ * stepped in parallel every tick; each line lasts LineSeconds plus SecondsPerCharacter per character
+ * of its base line. Everything that happened in a tick is delivered as one batch on the game thread
+ * through OnEvents, instead of per-conversation delegates.
+ */
+UCLASS(Config=Game)
+class SP_API UDialogueCrowdSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UDialogueCrowdSubsystem* Get(const UObject* WorldContextObject);
+
+    UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+    float LineSeconds = 1.5f;
+
+    UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+    float SecondsPerCharacter = 0.04f;
+
+    // Conversations per parallel task
+    UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+    int32 MinBatchSize = 256;
+
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual bool IsTickable() const override { return NumActive > 0; }
+
+    // Start a conversation at NodeID of Graph with a copy of InitialState (empty if null).
+    // Returns an unset handle if the node doesn't exist.
+    FDialogueConversationHandle Start(FDialogueGraphRef Graph, const FString& NodeID, const FDialogueState* InitialState = nullptr, int32 Seed = 0);
+
+    // End a conversation without an event
+    void Stop(FDialogueConversationHandle Handle);
+
+    bool IsRunning(FDialogueConversationHandle Handle) const { return Find(Handle) != nullptr; }
+
+    // Current line and speaker, resolved against the conversation's own state. Only call for the
+    // conversations that are actually shown (e.g. near the player).
+    FString GetLine(FDialogueConversationHandle Handle) const;
+    FString GetSpeaker(FDialogueConversationHandle Handle) const;
+
+    int32 NumConversations() const { return NumActive; }
+
+    // Batch of line changes and endings from the last tick
+    FOnDialogueCrowdEvents OnEvents;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    const FDialogueConversation* Find(FDialogueConversationHandle Handle) const;
+
+    // Enter NodeIndex, or end the conversation on INDEX_NONE. Runs on worker threads.
+    void Enter(FDialogueConversation& Conversation, int32 NodeIndex) const;
+
+    // Pick the next node after the current line. Runs on worker threads.
+    int32 ChooseNext(FDialogueConversation& Conversation) const;
+
+    void Release(int32 Index);
+
+    // Move conversations on an edited graph to its rebuilt version, by node id
+    void HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph);
+
+    FDelegateHandle GraphReloadedHandle;
+
+    TArray<FDialogueConversation> Conversations;
+    TArray<int32> FreeSlots;
+    int32 NumActive = 0;
+
+    // Per-task event lists and the merged batch, reused across ticks
+    TArray<TArray<FDialogueCrowdEvent>> TaskEvents;
+    TArray<FDialogueCrowdEvent> Events;
+};
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "DialogueNode.h"
+#include "DialogueState.h"
+#include "DialogueGraph.h"
 #include "DialogueDataLoader.generated.h"
 
 /**
@@ -21,4 +23,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Dialogue")
 	bool LoadDialogueFromFile(const FString& RelativePath, TMap<FString, FDialogueNode>& OutNodes);
 
+	// Same as LoadDialogueFromFile, without needing a loader object. Safe to call from worker threads.
+	static bool ParseDialogueFile(const FString& RelativePath, TMap<FString, FDialogueNode>& OutNodes);
+
+	// Parse a dialogue file given its full path on disk (editor import, tools).
+	// Nodes are filled straight from the JSON tokens; problems are logged as path(line:column).
+	static bool ParseDialogueFileAtPath(const FString& FullPath, TMap<FString, FDialogueNode>& OutNodes);
+
+	static EDialogueStateOp ToStateOp(EDialogueEffectOp Op);
+
+	// Build Graph from authored nodes through the core FDialogueGraphBuilder. Set Graph.SourcePath first;
+	// returns how many conditions, effects or links were dropped. The nodes' text is moved into the
+	// builder rather than copied, so Nodes is emptied; pass a copy to keep them.
+	static int32 BuildGraph(TArray<FDialogueNode>&& Nodes, FDialogueGraph& Graph);
+
+	// Media of a graph node as soft references, empty if the node has none
+	static FDialogueNodeAssets GetNodeAssets(const FDialogueGraph& Graph, int32 NodeIndex);
+
 };
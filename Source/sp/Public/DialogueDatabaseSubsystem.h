@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DialogueGraph.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueDatabaseSubsystem.generated.h"
+
+class UDialogueTriggerComponent;
+
+// A group of dialogue files that is paged in and out together
+USTRUCT()
+struct FDialogueChapter
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	FName Name;
+
+	// Relative paths under Content, e.g. "Dialogues/luka_session_02.json"
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	TArray<FString> Files;
+};
+
+/**
+ * Keeps the dialogue of large games resident by chapter instead of by level. Files listed in a
+ * chapter are not preloaded with their level; every UpdateInterval seconds a chapter is wanted if
+ * one of its triggers is within PageInDistance of a player, or a player's conversation is in one
+ * of its files or links into one. Wanted chapters are loaded as one parallel batch.
+ *
+ * The database holds its own references to the graphs of resident chapters. Once they take more
+ * than MemoryBudgetMB, the chapters wanted least recently are dropped. Triggers and managers
+ * hold their own references too, so a running conversation never loses its graph; the memory
+ * is freed when the last of them lets go.
+ */
+UCLASS(Config=Game)
+class SP_API UDialogueDatabaseSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UDialogueDatabaseSubsystem* Get(const UObject* WorldContextObject);
+
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	TArray<FDialogueChapter> Chapters;
+
+	// Seconds between residency updates
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	float UpdateInterval = 0.5f;
+
+	// A chapter is paged in once a player is this close to one of its triggers, in cm
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	float PageInDistance = 3000.f;
+
+	// Graph memory resident chapters may take before the least recently wanted are dropped, in MB
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	int32 MemoryBudgetMB = 32;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return ChapterStates.Num() > 0; }
+
+	// Chapter RelativePath belongs to, INDEX_NONE if it isn't paged
+	int32 FindChapter(const FString& RelativePath) const;
+	bool IsPaged(const FString& RelativePath) const { return FindChapter(RelativePath) != INDEX_NONE; }
+
+	// Triggers using a paged file register so the database knows where its chapter is needed
+	void RegisterTrigger(UDialogueTriggerComponent* Trigger);
+	void UnregisterTrigger(UDialogueTriggerComponent* Trigger);
+
+	// Page a chapter in now, e.g. ahead of a scripted scene. It stays until it is evicted.
+	UFUNCTION(BlueprintCallable, Category="Dialogue")
+	void RequestChapter(FName Chapter);
+
+	UFUNCTION(BlueprintCallable, Category="Dialogue")
+	bool IsChapterResident(FName Chapter) const;
+
+	// Graph memory held by resident chapters
+	int64 GetResidentBytes() const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FChapterState
+	{
+		// Graphs of the chapter's files while resident
+		TArray<FDialogueGraphRef> Graphs;
+		FDialogueLoadHandle LoadHandle;
+		int64 Bytes = 0;
+
+		// World time the chapter was last wanted
+		double LastWantedTime = -1.0;
+		bool bWanted = false;
+
+		bool IsResident() const { return Graphs.Num() > 0; }
+	};
+
+	// Mark chapters wanted by nearby triggers and running conversations, page them in and enforce the budget
+	void UpdateResidency();
+	void MarkWanted(int32 ChapterIndex);
+	void PageIn(int32 ChapterIndex);
+	void HandleChapterLoaded(const TArray<FDialogueGraphRef>& Graphs, int32 ChapterIndex);
+	void EnforceBudget();
+	void Evict(int32 ChapterIndex);
+
+	// Swap our reference when a resident file is edited in the editor
+	void HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph);
+
+	FDelegateHandle GraphReloadedHandle;
+
+	// Parallel to Chapters
+	TArray<FChapterState> ChapterStates;
+
+	// Normalized file path -> index into Chapters
+	TMap<FString, int32> ChapterByFile;
+
+	TArray<TWeakObjectPtr<UDialogueTriggerComponent>> Triggers;
+
+	float TimeSinceUpdate = 0.f;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "DialogueNode.h"
+#include "DialogueGraph.h"
+#include "DialogueGraphAsset.generated.h"
+
+class UAssetImportData;
+
+/**
+ * Dialogue graph imported from a dialogue JSON file (see UDialogueGraphFactory in the spEditor module).
+ * Nodes are saved as one compact binary block instead of tagged properties, so loading a cooked
+ * asset is a straight deserialize through the normal streaming pipeline, with no JSON work at runtime.
+ */
+UCLASS(BlueprintType)
+class SP_API UDialogueGraphAsset : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// Authored nodes. Transient because Serialize() writes them itself.
+	UPROPERTY(VisibleAnywhere, Transient, Category="Dialogue")
+	TArray<FDialogueNode> Nodes;
+
+#if WITH_EDITORONLY_DATA
+	// Source JSON file, used by reimport
+	UPROPERTY(VisibleAnywhere, Instanced, Category="Import Settings")
+	TObjectPtr<UAssetImportData> AssetImportData;
+#endif
+
+	virtual void PostInitProperties() override;
+	virtual void Serialize(FArchive& Ar) override;
+
+	// Replace the nodes with freshly parsed ones (import / reimport)
+	void SetNodes(TMap<FString, FDialogueNode>&& InNodes);
+
+	// Build a runtime graph from the nodes
+	FDialogueGraphRef BuildGraph() const;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include <atomic>
+#include "DialogueGraph.h"
+#include "DialogueGraphSubsystem.generated.h"
+
+struct FActorsInitializedParams;
+struct FStreamableHandle;
+class UDialogueGraphAsset;
+class UWorld;
+
+// Called on the game thread when an async load finishes. The graph is null if the file failed to load.
+DECLARE_DELEGATE_OneParam(FOnDialogueGraphLoaded, FDialogueGraphRef);
+
+// Called on the game thread when a batch finishes, with one graph (or null) per requested path
+DECLARE_DELEGATE_OneParam(FOnDialogueGraphsLoaded, const TArray<FDialogueGraphRef>&);
+
+// Broadcast on the game thread after a file's graph was rebuilt from disk: (path, old graph, new graph).
+// Holders of the old graph should switch to the new one and remap node indices by id.
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnDialogueGraphReloaded, const FString&, const FDialogueGraphRef&, const FDialogueGraphRef&);
+
+// Identifies a pending async load so its owner can cancel it
+struct FDialogueLoadHandle
+{
+	uint32 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Reset() { Id = 0; }
+};
+
+/**
+ * Loads each dialogue file once per game instance and hands out shared graph handles.
+ * The cache only holds weak references, so a graph is freed as soon as no trigger or manager uses it.
+ *
+ * Files can be loaded synchronously (LoadGraph) or on the thread pool (LoadGraphAsync / LoadGraphsAsync).
+ * Concurrent requests for the same file share one parse. When a game world finishes initializing its
+ * actors, every file referenced by its dialogue triggers is loaded as one parallel batch.
+ *
+ * In editor builds, JSON files under Content are watched: saving a file that is in use reparses it on
+ * a worker, diffs the result against the live graph by node id and hands the new graph to every
+ * holder through OnGraphReloaded, without reloading the level.
+ */
+UCLASS()
+class SP_API UDialogueGraphSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UDialogueGraphSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Shared graph for RelativePath, parsed on the calling thread on first use. Null if the file can't be loaded.
+	FDialogueGraphRef LoadGraph(const FString& RelativePath);
+
+	// Parse RelativePath on a worker thread and call OnLoaded on the game thread.
+	// If the graph is already loaded, OnLoaded runs immediately and the returned handle is invalid.
+	FDialogueLoadHandle LoadGraphAsync(const FString& RelativePath, FOnDialogueGraphLoaded OnLoaded);
+
+	// Load several files in parallel; OnAllLoaded runs once every one of them is done
+	FDialogueLoadHandle LoadGraphsAsync(const TArray<FString>& RelativePaths, FOnDialogueGraphsLoaded OnAllLoaded);
+
+	// Shared graph built from a loaded dialogue asset, cached like file graphs
+	FDialogueGraphRef GetGraphForAsset(const UDialogueGraphAsset* Asset);
+
+	// Stream Asset in through the asset manager and call OnLoaded with its graph on the game thread.
+	// If the asset is already in memory, OnLoaded runs immediately and the returned handle is invalid.
+	FDialogueLoadHandle LoadGraphAssetAsync(const TSoftObjectPtr<UDialogueGraphAsset>& Asset, FOnDialogueGraphLoaded OnLoaded);
+
+	// Drop a pending request (single or batch) so its callback never runs. Resets Handle.
+	void CancelLoad(FDialogueLoadHandle& Handle);
+
+	// Graph for RelativePath if something still holds it, otherwise null
+	FDialogueGraphRef FindGraph(const FString& RelativePath) const;
+
+	// Number of graphs currently alive
+	UFUNCTION(BlueprintCallable, Category="Dialogue")
+	int32 GetNumLoadedGraphs() const;
+
+	// Reparse a loaded file on a worker and swap in the new graph if any node changed.
+	// Does nothing if no one holds the file's graph.
+	void ReloadGraph(const FString& RelativePath);
+
+	FOnDialogueGraphReloaded OnGraphReloaded;
+
+	// Parse a dialogue file into a new graph without touching any cache.
+	// Thread-safe; used by the subsystem's workers and by code that runs without a game instance.
+	static FDialogueGraphRef ParseGraph(const FString& RelativePath);
+
+	// Same as ParseGraph for a file anywhere on disk; SourcePath is what the graph reports as its origin.
+	// With a Previous graph, nodes it also has keep their index and new ones go last.
+	static FDialogueGraphRef ParseGraphAtPath(const FString& FullPath, const FString& SourcePath, const FDialogueGraph* Previous = nullptr);
+
+	// Key a file is cached under; compare paths through this
+	static FString NormalizePath(const FString& RelativePath);
+
+private:
+	// Requests waiting on one in-flight parse
+	struct FPendingLoad
+	{
+		TArray<TPair<uint32, FOnDialogueGraphLoaded>> Callbacks;
+
+		// Set when every requester cancelled, so the worker can skip parsing
+		std::atomic<bool> bAbandoned { false };
+	};
+
+	void StartWorker(const FString& Key, const TSharedRef<FPendingLoad, ESPMode::ThreadSafe>& Pending);
+	void FinishAsyncLoad(const FString& Key, FDialogueGraphRef Graph, bool bSkipped);
+
+	// Kick off a batch load for every trigger placed in a freshly initialized game world
+	void HandleWorldInitializedActors(const FActorsInitializedParams& Params);
+
+	// Release the graphs preloaded for a world once it is torn down
+	void HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	// Drop entries whose graph has been freed
+	void PruneExpired();
+
+	void FinishReload(const FString& Key, FDialogueGraphRef OldGraph, FDialogueGraphRef NewGraph, double StartTime);
+
+#if WITH_EDITOR
+	void HandleContentFilesChanged(const TArray<struct FFileChangeData>& Changes);
+
+	FDelegateHandle DirectoryWatcherHandle;
+#endif
+
+	TMap<FString, TWeakPtr<const FDialogueGraph, ESPMode::ThreadSafe>> Graphs;
+
+	TMap<FString, TSharedRef<FPendingLoad, ESPMode::ThreadSafe>> PendingLoads;
+
+	// Request id -> path of its pending load, for cancellation
+	TMap<uint32, FString> RequestPaths;
+
+	// Request id -> streaming handle of a pending asset load
+	TMap<uint32, TSharedPtr<FStreamableHandle>> AssetRequests;
+
+	// Batch id -> its per-file requests
+	TMap<uint32, TArray<FDialogueLoadHandle>> Batches;
+
+	uint32 NextRequestId = 1;
+
+	// Graphs preloaded for each world's triggers. The cache only holds them weakly, so these keep
+	// them alive until the world goes away even if no trigger has taken its reference yet.
+	TMap<TObjectKey<UWorld>, TArray<FDialogueGraphRef>> WorldPreloads;
+
+	FDelegateHandle WorldInitializedActorsHandle;
+	FDelegateHandle WorldCleanupHandle;
+};
@@ -3,13 +3,59 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "DialogueNode.h"   // All structs related to a dialogue node
+#include "DialogueGraph.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueSession.h"
+#include "DialogueSpeculation.h"
+#include "DialogueAssetPrefetcher.h"
+#include "DialogueStateSnapshot.h"
+#include "DialogueReplicatedState.h"
+#include "DialogueRecording.h"
 #include "DialogueManager.generated.h"
 
+class UDialogueGraphAsset;
+
+// Everything the UI shows for one dialogue step, fully resolved
+USTRUCT(BlueprintType)
+struct SP_API FDialogueStep
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category="Dialogue")
+    FString NodeID;
+
+    UPROPERTY(BlueprintReadOnly, Category="Dialogue")
+    FString Speaker;
+
+    // Line with alt and append lines applied
+    UPROPERTY(BlueprintReadOnly, Category="Dialogue")
+    FString Line;
+
+    // Choices with alt texts applied, in selection order. Only Text, NextNodeID, FailureNodeID and
+    // bLocked are filled; AltTexts, Requirements and Effects stay empty (they are compiled into the graph).
+    UPROPERTY(BlueprintReadOnly, Category="Dialogue")
+    TArray<FDialogueChoice> Choices;
+
+    // Voice-over, portrait and montage of the node; usually already streamed in
+    UPROPERTY(BlueprintReadOnly, Category="Dialogue")
+    FDialogueNodeAssets Assets;
+};
+
 // Delegate for UI updates
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDialogueStep, const FDialogueStep&, Step);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDialogueUpdated, const FString&, Speaker, const FString&, Line);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChoicesUpdated, const TArray<FDialogueChoice>&, Choices);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDialogueEnded);
 
+/**
+ * Runs the dialogue of one player. Traversal, state and text resolution live in an FDialogueSession
+ * from the DialogueCore module; the manager adds what needs the engine around it: loading graphs,
+ * following links into other files, UI events, asset prefetch, recording and replication.
+ *
+ * In a networked game the server's manager is authoritative:
+ * clients send SelectChoice / AdvanceDialogue to it and follow the graph, node index and changed
+ * attributes it replicates, resolving text from their own copy of the graph.
+ */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SP_API UDialogueManager : public UActorComponent
 {
@@ -20,87 +66,335 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
-    // Holds nodes loaded by itself through its load json function
-    TMap<FString, FDialogueNode> OwnDialogueMap;
+    virtual void PostInitProperties() override;
+    virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
-    // A pointer to a dialogue map that will be loaded elsewhere, like an NPC
-    const TMap<FString, FDialogueNode>* ActiveDialogueMap = nullptr;
+    // Graph loaded by itself through its load json function
+    FDialogueGraphRef OwnGraph;
 
-    // Current node id
+    // Graph of the running dialogue, usually handed over by an NPC's trigger.
+    // Holding the handle keeps the graph alive for as long as the dialogue uses it.
+    const FDialogueGraphRef& GetActiveGraph() const { return Session.GetGraph(); }
+
+    // Current node id, kept for Blueprint and logs. Traversal uses GetCurrentNodeIndex.
     UPROPERTY(BlueprintReadOnly, Category="Dialogue")
     FString CurrentNodeID;
 
-    // Simple state
-    UPROPERTY(BlueprintReadWrite, Category="Dialogue")
-    int32 Trust = 0;
+    // Index of the current node in the active graph, INDEX_NONE if there is none
+    int32 GetCurrentNodeIndex() const { return Session.GetNodeIndex(); }
 
-    UPROPERTY(BlueprintReadWrite, Category="Dialogue")
-    FString LastTopic;
+    // Graph, node and state of the running dialogue, without the engine side
+    const FDialogueSession& GetSession() const { return Session; }
 
     // Relative path to JSON, e.g., "Dialogues/sample_dlg.json"
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue")
     FString DialogueJSONPath = TEXT("Dialogues/change_me.json");;
 
-    // Skills map (e.g., skill.observation -> int)
-    UPROPERTY(BlueprintReadWrite, Category="Dialogue")
-    TMap<FString,int32> Skills;
+    // Also list choices whose requirements fail, flagged as locked. Selecting one follows its failure branch if it has one.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue")
+    bool bShowLockedChoices = false;
+
+    // While a node is shown, resolve the nodes it leads to on a worker thread so that selecting a
+    // choice or advancing only swaps in the prepared result
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue")
+    bool bSpeculateSuccessors = true;
+
+    // Stream in the media of every node up to this many links ahead of the current one
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue|Assets", meta=(ClampMin="0"))
+    int32 PrefetchHops = 2;
+
+    // Memory the prefetched media may take, in MB. The current node's media is loaded regardless.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue|Assets", meta=(ClampMin="0"))
+    int32 PrefetchBudgetMB = 64;
+
+    // Record every dialogue (start state, inputs and a checksum of each step) to
+    // Saved/DialogueRecordings when it ends, for replay with the DialogueReplay commandlet
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue|Recording")
+    bool bRecordDialogues = false;
+
+    // File the last recording was written to
+    UPROPERTY(BlueprintReadOnly, Category="Dialogue|Recording")
+    FString LastRecordingPath;
+
+    // Imported dialogue graph asset; used instead of DialogueJSONPath when set
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue")
+    TSoftObjectPtr<UDialogueGraphAsset> DialogueAsset;
+
+    // Dialogue state blackboard (trust, last_topic, skills, flags and any attribute named in data).
+    // On network clients it mirrors the server's; the setters below only work on the server.
+    const FDialogueState& GetState() const { return Session.GetState(); }
+
+    // Snapshots of the state for other threads (AI, workers). Read them through an
+    // FDialogueStateReadScope; a snapshot is published after every change made through this manager.
+    FDialogueStatePublisherRef GetStatePublisher() const { return StatePublisher; }
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    int32 GetIntAttribute(FName Attribute) const;
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    void SetIntAttribute(FName Attribute, int32 Value);
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    float GetFloatAttribute(FName Attribute) const;
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    void SetFloatAttribute(FName Attribute, float Value);
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    bool GetBoolAttribute(FName Attribute) const;
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    void SetBoolAttribute(FName Attribute, bool bValue);
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    FName GetNameAttribute(FName Attribute) const;
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue|State")
+    void SetNameAttribute(FName Attribute, FName Value);
+
+private:
+    // The fixed state fields from before the blackboard. Kept so existing Blueprints load and keep
+    // working; they read and write the "trust", "last_topic", "skill.<name>" and bool attributes.
+    // Nothing is stored in the members themselves, so they are private: C++ goes through the getters
+    // and setters below, or better the attribute functions above.
+    UPROPERTY(BlueprintGetter=GetTrust, BlueprintSetter=SetTrust, Category="Dialogue|Deprecated",
+        meta=(AllowPrivateAccess="true", DeprecatedProperty, DeprecationMessage="Use Get/SetIntAttribute with \"trust\"."))
+    int32 Trust = 0;
+
+    UPROPERTY(BlueprintGetter=GetLastTopic, BlueprintSetter=SetLastTopic, Category="Dialogue|Deprecated",
+        meta=(AllowPrivateAccess="true", DeprecatedProperty, DeprecationMessage="Use Get/SetNameAttribute with \"last_topic\"."))
+    FString LastTopic;
+
+    // Keyed without the "skill." prefix, as before
+    UPROPERTY(BlueprintGetter=GetSkills, BlueprintSetter=SetSkills, Category="Dialogue|Deprecated",
+        meta=(AllowPrivateAccess="true", DeprecatedProperty, DeprecationMessage="Use Get/SetIntAttribute with \"skill.<name>\"."))
+    TMap<FString, int32> Skills;
+
+    UPROPERTY(BlueprintGetter=GetFlags, BlueprintSetter=SetFlags, Category="Dialogue|Deprecated",
+        meta=(AllowPrivateAccess="true", DeprecatedProperty, DeprecationMessage="Use Get/SetBoolAttribute."))
+    TMap<FString, bool> Flags;
+
+public:
+    UFUNCTION(BlueprintGetter)
+    int32 GetTrust() const;
+
+    UFUNCTION(BlueprintSetter)
+    void SetTrust(int32 Value);
+
+    UFUNCTION(BlueprintGetter)
+    FString GetLastTopic() const;
+
+    UFUNCTION(BlueprintSetter)
+    void SetLastTopic(const FString& Value);
 
-    // Flags map
-    UPROPERTY(BlueprintReadWrite, Category="Dialogue")
-    TMap<FString,bool> Flags;
+    UFUNCTION(BlueprintGetter)
+    TMap<FString, int32> GetSkills() const;
 
-    // Start dialogue at node, with optional external dialogue map pointer
+    // Skills missing from Value are set to 0, as removing them from the old map did
+    UFUNCTION(BlueprintSetter)
+    void SetSkills(const TMap<FString, int32>& Value);
+
+    UFUNCTION(BlueprintGetter)
+    TMap<FString, bool> GetFlags() const;
+
+    // Flags missing from Value are cleared
+    UFUNCTION(BlueprintSetter)
+    void SetFlags(const TMap<FString, bool>& Value);
+
+    // Replace the whole state, e.g. with the start state of a recording
+    void SetState(const FDialogueState& InState);
+
+    // Start dialogue at node, with optional external dialogue graph
     // Does not need to be blueprint callable so no UFUNCTION deco
-    void StartDialogue(const FString& NodeID, const TMap<FString, FDialogueNode>* InDialogueMap = nullptr);
+    void StartDialogue(const FString& NodeID, FDialogueGraphRef InGraph = nullptr);
 
-    void SetActiveDialogueMap(const TMap<FString, FDialogueNode>* InDialogueMap);
+    void SetActiveGraph(FDialogueGraphRef InGraph);
     
-    // Returns a pointer to the current node, or nullptr if not found
+    // Between entering a node and the end of the dialogue
+    bool IsDialogueActive() const { return Session.IsActive(); }
+
+    // Returns a pointer to the current node in the active graph, or nullptr if not found
     // No need for UFUNCTION decorator
-    const FDialogueNode* GetCurrentNode() const;
+    const FDialogueGraphNode* GetCurrentNode() const { return Session.GetNode(); }
+
+    UFUNCTION(BlueprintCallable, Category="Dialogue")
+    FString GetCurrentSpeaker() const;
     
     // Get display line (resolves alt + append)
     UFUNCTION(BlueprintCallable, Category="Dialogue")
     FString GetCurrentLine() const;
 
-    // Get list of choices (with resolved text and only unlocked)
+    // Voice-over, portrait and montage of the current node (empty if it has none)
+    UFUNCTION(BlueprintCallable, Category="Dialogue")
+    FDialogueNodeAssets GetCurrentAssets() const;
+
+    // Choices of the current node resolved against the current state, in display order.
+    // Refreshed in place when the node or state changes, so reading it doesn't allocate.
+    // The view is valid until the next call that changes the node, graph or state.
+    TConstArrayView<FDialogueResolvedChoice> GetResolvedChoices() const;
+
+    // Get list of choices (with resolved text and only unlocked, unless bShowLockedChoices).
+    // Copies into Blueprint structs; native code should prefer GetResolvedChoices.
+    // Only Text, NextNodeID, FailureNodeID and bLocked are filled: AltTexts, Requirements and Effects
+    // are compiled into the graph when it loads and always come back empty. The same goes for
+    // OnChoicesUpdated and OnDialogueStep.
     UFUNCTION(BlueprintCallable, Category="Dialogue")
     TArray<FDialogueChoice> GetAvailableChoices() const;
 
-    // Select a choice index (applies effects and advances)
+    // Select a choice by its index in GetResolvedChoices (applies effects and advances)
     UFUNCTION(BlueprintCallable, Category="Dialogue")
     void SelectChoice(int32 ChoiceIndex);
 
     UFUNCTION(BlueprintCallable, Category="Dialogue")
     void AdvanceDialogue();
 
+    // Client input, checked against the server's own node and state. NodeIndex is the node the
+    // client saw, so late or repeated clicks from an earlier node are dropped.
+    UFUNCTION(Server, Reliable, WithValidation)
+    void Server_SelectChoice(int32 NodeIndex, int32 ChoiceIndex);
+
+    UFUNCTION(Server, Reliable, WithValidation)
+    void Server_AdvanceDialogue(int32 NodeIndex);
+
+    // Store an attribute received from the server (called by ReplicatedState's items)
+    void HandleReplicatedAttribute(FName Attribute, const FDialogueValue& Value);
+
+    // Synchronous load into OwnGraph
     UFUNCTION(BlueprintCallable, Category="Dialogue")
     bool LoadDialogueFromJSON(const FString& RelativePath);
 
+    // Load into OwnGraph on a worker thread. A StartDialogue that needs OwnGraph waits for it.
+    void LoadDialogueFromJSONAsync(const FString& RelativePath);
+
+    // Fired once per frame at most, after the node or its choices changed. Prefer this over
+    // OnDialogueUpdated + OnChoicesUpdated, which fire separately on every node change.
+    UPROPERTY(BlueprintAssignable, Category="Dialogue")
+    FOnDialogueStep OnDialogueStep;
+
+    // Resolve the current node into Out, reusing its choice entries
+    void FillStep(FDialogueStep& Out) const;
+
     UPROPERTY(BlueprintAssignable, Category="Dialogue")
     FOnDialogueUpdated OnDialogueUpdated;
     
     UPROPERTY(BlueprintAssignable, Category="Dialogue")
     FOnDialogueEnded OnDialogueEnded;
 
+    // Choices filled like GetAvailableChoices
     UPROPERTY(BlueprintAssignable, Category="Dialogue")
     FOnChoicesUpdated OnChoicesUpdated;
 
 protected:
-    // Evaluate a full condition string. Supports "||" and "&&" (basic).
-    bool EvaluateConditionString(const FString& Condition) const;
+    // Make NodeIndex of the active graph current and broadcast its line and choices
+    void EnterNode(int32 NodeIndex);
+
+    // Enter the target of a link of the current node. Cross-file links load the other file
+    // on a worker and move the conversation to it; input is ignored until it arrives.
+    void FollowLink(int32 Link);
+
+    void HandleLinkedGraphLoaded(FDialogueGraphRef Graph);
+
+    // Switch the session to InGraph and drop everything tied to the previous one
+    void SwitchGraph(FDialogueGraphRef InGraph);
+
+    // Schedule OnDialogueStep for the next tick, unless one is already scheduled
+    void QueueStep();
+    void BroadcastStep();
+
+    // Drop any queued step and broadcast OnDialogueEnded
+    void FinishDialogue();
+
+    // Resolve the successors of the current node in the background
+    void LaunchSpeculation();
+    void CancelSpeculation();
+
+    // Enter the speculated branch for an authored choice of the current node (INDEX_NONE for its
+    // Next link), if one is ready and still matches the state. Returns false if the caller has to
+    // resolve the step itself.
+    bool TryEnterSpeculatedBranch(int32 ChoiceIndex, bool bFailure);
+
+    FDialogueSpeculationRef Speculation;
+
+    // Media of the nodes around the current one
+    FDialogueAssetPrefetcher AssetPrefetcher;
+
+    bool bStepQueued = false;
+
+    // Reused for OnDialogueStep
+    FDialogueStep Step;
+
+    // Copy the resolved choices into Blueprint structs, reusing Out's elements and their strings
+    void FillChoices(TArray<FDialogueChoice>& Out) const;
+
+    void HandleOwnGraphLoaded(FDialogueGraphRef Graph);
+
+    // Move to the rebuilt graph after its file was edited, staying on the current node if it still exists
+    void HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph);
+
+    FDelegateHandle GraphReloadedHandle;
+
+    // Pending async load of OwnGraph
+    FDialogueLoadHandle OwnGraphLoadHandle;
+
+    // Node requested while OwnGraph was still loading
+    FString PendingStartNodeID;
+
+    // Pending load of the file a cross-file link leads to, and the node to enter there.
+    // On clients, the load of the graph the server moved to.
+    FDialogueLoadHandle LinkLoadHandle;
+    FString PendingLinkNodeID;
+
+    void CancelLinkLoad();
+
+    // Writes a blackboard value by name, registering the attribute if needed (Blueprint setters)
+    void SetAttribute(FName Attribute, const FDialogueValue& Value);
+
+    // Graph, current node, state and the line and choices resolved for them
+    FDialogueSession Session;
+
+    // Make the current state visible to GetStatePublisher readers, and to clients on a server
+    void PublishState();
+
+    FDialogueStatePublisherRef StatePublisher;
+
+    // Reused for OnChoicesUpdated
+    TArray<FDialogueChoice> BroadcastChoices;
+
+    // Conversation being recorded while bRecordDialogues is set
+    TUniquePtr<FDialogueRecording> Recording;
+
+    void RecordInput(EDialogueRecordedInput Input, int32 ChoiceIndex = INDEX_NONE);
+
+    // Store the current node, line and state as the outcome of the last recorded input
+    void RecordOutcome();
+    void SaveRecording();
+
+    bool IsNetClient() const { return GetNetMode() == NM_Client; }
+    bool IsNetServer() const { return GetNetMode() == NM_DedicatedServer || GetNetMode() == NM_ListenServer; }
+
+    // What clients follow: SourcePath of the server's active graph, its current node (INDEX_NONE once
+    // the dialogue ended) and the attributes of its state. Each only goes out when it changes, so a
+    // step costs the node index plus whatever attributes the choice's effects touched.
+    UPROPERTY(ReplicatedUsing=OnRep_ReplicatedGraphPath)
+    FString ReplicatedGraphPath;
+
+    UPROPERTY(ReplicatedUsing=OnRep_ReplicatedNodeIndex)
+    int32 ReplicatedNodeIndex = INDEX_NONE;
+
+    UPROPERTY(Replicated)
+    FDialogueReplicatedState ReplicatedState;
 
-    // Evaluate a single expression like 'trust >= 1' or 'last_topic == "autonomy"'
-    bool EvaluateSingleExpression(const FString& Expr) const;
+    UFUNCTION()
+    void OnRep_ReplicatedGraphPath();
 
-    // Apply effects from a choice
-    void ApplyEffects(const TArray<FDialogueEffect>& Effects);
+    UFUNCTION()
+    void OnRep_ReplicatedNodeIndex();
 
-    // Helper: split by substring (works with multi-char separators)
-    void SplitBySubstring(const FString& Input, const FString& Separator, TArray<FString>& Out) const;
+    // Client: enter or leave the replicated node once its graph is loaded
+    void ApplyReplicatedNode();
 
-    // Helper: trim
-    FString Trim(const FString& In) const;
+    void HandleReplicatedGraphLoaded(FDialogueGraphRef Graph);
 };
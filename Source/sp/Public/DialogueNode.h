@@ -4,6 +4,10 @@
 #include "Engine/DataTable.h"
 #include "DialogueNode.generated.h"
 
+class UAnimMontage;
+class USoundBase;
+class UTexture2D;
+
 // Simple operation enum for effects
 UENUM(BlueprintType)
 enum class EDialogueEffectOp : uint8
@@ -60,7 +64,8 @@ struct SP_API FDialogueEffect
     FString Value;
 };
 
-// Choice structure authored by writers
+// Choice structure authored by writers. Choices handed to the UI by UDialogueManager only carry
+// Text, the links and bLocked; AltTexts, Requirements and Effects are authoring data.
 USTRUCT(BlueprintType)
 struct SP_API FDialogueChoice
 {
@@ -90,6 +95,29 @@ struct SP_API FDialogueChoice
     // (Optional) Node to go to if Requirements fail (failure branch)
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
     FString FailureNodeID;
+
+    // Set on choices handed to the UI when their requirements fail (see UDialogueManager::bShowLockedChoices)
+    UPROPERTY(BlueprintReadOnly, Transient, Category = "Dialogue")
+    bool bLocked = false;
+};
+
+// Media played or shown with a node. Soft references, streamed in ahead of time by the
+// dialogue manager (see UDialogueManager::PrefetchHops).
+USTRUCT(BlueprintType)
+struct SP_API FDialogueNodeAssets
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+    TSoftObjectPtr<USoundBase> VoiceOver;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+    TSoftObjectPtr<UTexture2D> Portrait;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+    TSoftObjectPtr<UAnimMontage> Montage;
+
+    bool IsEmpty() const { return VoiceOver.IsNull() && Portrait.IsNull() && Montage.IsNull(); }
 };
 
 // Top-level node (DataTable row)
@@ -125,4 +153,8 @@ struct SP_API FDialogueNode : public FTableRowBase
     // If present and Choices is empty, automatically continue to this node after showing line
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
     FString NextNodeID;
+
+    // Optional voice-over, portrait and montage, as object paths in JSON
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
+    FDialogueNodeAssets Assets;
 };
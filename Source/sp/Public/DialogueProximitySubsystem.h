@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DialogueProximitySubsystem.generated.h"
+
+class APawn;
+class UBoxComponent;
+class UDialogueTriggerComponent;
+
+/**
+ * Finds players entering and leaving dialogue trigger boxes without physics overlaps.
+ * Registered boxes are binned into a uniform grid; every UpdateInterval seconds each player pawn is
+ * tested against the boxes in the cells it touches only, and the trigger gets the same enter / exit
+ * notifications the overlap events would give. Used by triggers with bUseProximityGrid set.
+ */
+UCLASS(Config=Game)
+class SP_API UDialogueProximitySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UDialogueProximitySubsystem* Get(const UObject* WorldContextObject);
+
+	// Edge length of a grid cell in cm. Around the size of the largest trigger box works well.
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	float CellSize = 1000.f;
+
+	// Seconds between player tests; 0 tests every frame
+	UPROPERTY(Config, EditAnywhere, Category="Dialogue")
+	float UpdateInterval = 0.1f;
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return Volumes.Num() > 0; }
+
+	// Start tracking Box for Trigger. Returns an id for Unregister.
+	int32 Register(UDialogueTriggerComponent* Trigger, UBoxComponent* Box);
+	void Unregister(int32 VolumeId);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FVolume
+	{
+		TWeakObjectPtr<UDialogueTriggerComponent> Trigger;
+		TWeakObjectPtr<UBoxComponent> Box;
+		FDelegateHandle TransformHandle;
+
+		// World transform and unscaled extent of the box when it was last binned
+		FTransform Transform;
+		FVector Extent = FVector::ZeroVector;
+
+		// Cells the box is binned in
+		FIntVector MinCell = FIntVector::ZeroValue;
+		FIntVector MaxCell = FIntVector::ZeroValue;
+
+		bool bDirty = true;
+
+		// Query that last saw this volume, so a volume spanning several cells is tested once
+		uint32 QueryStamp = 0;
+	};
+
+	FIntVector ToCell(const FVector& Location) const;
+	void Bin(int32 VolumeId);
+	void Unbin(int32 VolumeId);
+	void HandleBoxMoved(int32 VolumeId);
+
+	// Test every player pawn and send enter / exit notifications
+	void UpdatePlayers();
+
+	TSparseArray<FVolume> Volumes;
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	// Volumes each player pawn is currently inside, sorted
+	TMap<TWeakObjectPtr<APawn>, TArray<int32>> PawnVolumes;
+
+	float TimeSinceUpdate = 0.f;
+	uint32 NextQueryStamp = 1;
+};
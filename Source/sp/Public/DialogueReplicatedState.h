@@ -0,0 +1,67 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "DialogueState.h"
+#include "DialogueReplicatedState.generated.h"
+
+class UDialogueManager;
+struct FDialogueReplicatedState;
+
+// One attribute of a server-side dialogue state. Sent by name, since registry slots depend on the
+// order each process happened to load its dialogue in.
+USTRUCT()
+struct SP_API FDialogueReplicatedAttribute : public FFastArraySerializerItem
+{
+    GENERATED_BODY()
+
+    FName Attribute;
+    FDialogueValue Value;
+
+    // Name, 3 type bits and the value: a bit for bools, a packed integer for ints
+    bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+    void PostReplicatedAdd(const FDialogueReplicatedState& InArraySerializer);
+    void PostReplicatedChange(const FDialogueReplicatedState& InArraySerializer);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueReplicatedAttribute> : public TStructOpsTypeTraitsBase2<FDialogueReplicatedAttribute>
+{
+    enum { WithNetSerializer = true };
+};
+
+// Attributes of a dialogue state, delta-replicated: only items changed since a client's last
+// acknowledged update are sent.
+//
+// The server calls Update after changing its state; each slot whose value differs from what was
+// last sent gets its item marked dirty. Clients apply received items to their manager's state.
+USTRUCT()
+struct SP_API FDialogueReplicatedState : public FFastArraySerializer
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    TArray<FDialogueReplicatedAttribute> Items;
+
+    // Receives the items on clients; not replicated. Set by the manager in PostInitProperties.
+    UDialogueManager* Owner = nullptr;
+
+    // Server only. Mark every attribute of State that changed since the last call.
+    void Update(const FDialogueState& State);
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+    {
+        return FFastArraySerializer::FastArrayDeltaSerialize<FDialogueReplicatedAttribute, FDialogueReplicatedState>(Items, DeltaParms, *this);
+    }
+
+private:
+    // Registry slot -> index into Items, INDEX_NONE until the slot is first set
+    TArray<int32> ItemBySlot;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDialogueReplicatedState> : public TStructOpsTypeTraitsBase2<FDialogueReplicatedState>
+{
+    enum { WithNetDeltaSerializer = true };
+};
@@ -4,9 +4,15 @@
 #include "Components/SceneComponent.h"
 #include "Components/ActorComponent.h"
 #include "Components/BoxComponent.h"
-#include "DialogueDataLoader.h"
+#include "DialogueGraph.h"
+#include "DialogueGraphSubsystem.h"
 #include "DialogueTriggerComponent.generated.h"
 
+class ACharacter;
+class APawn;
+class APlayerController;
+class UDialogueGraphAsset;
+
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class SP_API UDialogueTriggerComponent : public USceneComponent
 {
@@ -17,24 +23,76 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 
 public:
 	// Collision box, a sub commponent
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue")
 	UBoxComponent* TriggerBox;
+
+	// Detect players through UDialogueProximitySubsystem's grid instead of physics overlaps.
+	// TriggerBox then only provides the shape and has its collision turned off.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Dialogue")
+	bool bUseProximityGrid = false;
+
+	// A player pawn entered / left the trigger (from overlap events or the proximity grid)
+	void HandlePlayerEnter(AActor* OtherActor);
+	void HandlePlayerExit(AActor* OtherActor);
+
+	const FString& GetDialogueFilePath() const { return DialogueFilePath; }
+	const TSoftObjectPtr<UDialogueGraphAsset>& GetDialogueAsset() const { return DialogueAsset; }
+
+	// True once the dialogue graph finished loading
+	bool IsDialogueReady() const { return DialogueGraph.IsValid(); }
 	
 private:
 	// Dialogue config (exposed)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue", meta=(AllowPrivateAccess="true"))
 	FString DialogueFilePath;
 
+	// Imported dialogue graph asset; used instead of DialogueFilePath when set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue", meta=(AllowPrivateAccess="true"))
+	TSoftObjectPtr<UDialogueGraphAsset> DialogueAsset;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Dialogue", meta=(AllowPrivateAccess="true"))
 	FString StartingNodeID;
 
-	// Your dialogue map type (keep same as your project)
-	UPROPERTY()
-	TMap<FString, FDialogueNode> DialogueData;
+	// Shared handle to the loaded dialogue graph; other triggers using the same file hold the same graph
+	FDialogueGraphRef DialogueGraph;
+
+	// Async load of DialogueGraph, cancelled if we go away before it finishes
+	FDialogueLoadHandle GraphLoadHandle;
+
+	// Player who walked in before the graph was ready; dialogue starts for them once it loads
+	TWeakObjectPtr<ACharacter> PendingPlayer;
+
+	// Player and controller the running dialogue was started for; with several players, player 0 may be someone else.
+	// Only one conversation runs at a time: other players entering meanwhile are ignored.
+	TWeakObjectPtr<ACharacter> DialoguePlayer;
+	TWeakObjectPtr<APlayerController> DialogueController;
+
+	// True, with a log, if a conversation with another player is running or about to start
+	bool IsBusyWith(const ACharacter* PlayerChar) const;
+
+	// Registration with UDialogueProximitySubsystem when bUseProximityGrid is set
+	int32 ProximityVolumeId = INDEX_NONE;
+
+	// DialogueFilePath belongs to a chapter of UDialogueDatabaseSubsystem: the graph is only held
+	// while a dialogue runs and is loaded on entry, usually from the already paged-in chapter
+	bool bPagedGraph = false;
+
+	void LoadPagedGraph();
+
+	void HandleGraphLoaded(FDialogueGraphRef Graph);
+
+	// Switch to the rebuilt graph after its file was edited
+	void HandleGraphReloaded(const FString& Path, const FDialogueGraphRef& OldGraph, const FDialogueGraphRef& NewGraph);
+
+	FDelegateHandle GraphReloadedHandle;
+
+	// Lock the player and start the dialogue on their DialogueManager
+	void BeginDialogueFor(ACharacter* PlayerChar);
 
 	// Overlap and end handlers
 	UFUNCTION()
@@ -45,6 +103,12 @@ private:
 	                    bool bFromSweep,
 	                    const FHitResult& SweepResult);
 
+	UFUNCTION()
+	void OnOverlapEnd(UPrimitiveComponent* OverlappedComp,
+	                  AActor* OtherActor,
+	                  UPrimitiveComponent* OtherComp,
+	                  int32 OtherBodyIndex);
+
 	UFUNCTION()
 	void HandleDialogueEnded();
 };
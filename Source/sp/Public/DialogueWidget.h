@@ -5,8 +5,11 @@
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
 #include "DialogueNode.h" // For FDialogueNode, FDialogueChoice
+#include "DialogueManager.h" // For FDialogueStep
 #include "DialogueWidget.generated.h"
 
+class UPanelWidget;
+
 /**
  * 
  */
@@ -24,6 +27,17 @@ public:
 	FText CurrentLine;
 	UPROPERTY(BlueprintReadOnly)
 	TArray<FDialogueChoice> CurrentChoices;
+
+	// Optional panel the choice buttons live in. When it and ChoiceButtonClass are set, ApplyStep keeps
+	// one button per choice alive across steps and only refreshes the ones whose choice changed.
+	// Bound by name from the designer, or handed over with SetChoiceContainer; widgets without one
+	// (such as WBP_Dialogue) keep rebuilding through OnDialogueUpdated_BP.
+	UPROPERTY(BlueprintReadOnly, meta=(BindWidgetOptional))
+	UPanelWidget* ChoiceContainer = nullptr;
+
+	// Button widget created per choice, e.g. WBP_ChoiceButton
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Dialogue")
+	TSubclassOf<UUserWidget> ChoiceButtonClass;
 	
 	// Called to show or hide the widget
 	UFUNCTION(BlueprintCallable, Category="Dialogue")
@@ -33,6 +47,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Dialogue")
 	void UpdateDialogue(const FString& Line, const TArray<FDialogueChoice>& Choices);
 
+	// Use Container for pooled choice buttons, e.g. from Construct when the panel has another name.
+	// Null goes back to rebuilding through OnDialogueUpdated_BP. Buttons pooled so far are dropped.
+	UFUNCTION(BlueprintCallable, Category="Dialogue")
+	void SetChoiceContainer(UPanelWidget* Container);
+
+	// Show a whole dialogue step. Reuses choice buttons when a ChoiceContainer is bound,
+	// otherwise falls back to OnDialogueUpdated_BP like UpdateDialogue.
+	UFUNCTION(BlueprintCallable, Category="Dialogue")
+	void ApplyStep(const FDialogueStep& Step);
+
 	// Called when player selects a choice (index) through a button
 	UFUNCTION(BlueprintCallable, Category="Dialogue")
 	void NotifyChoiceSelected(int32 ChoiceIndex);
@@ -45,4 +69,19 @@ public:
 	// just a hook the Blueprint will implement to rebuild the visible widgets
 	UFUNCTION(BlueprintImplementableEvent, Category="Dialogue")
 	void OnDialogueUpdated_BP();
+
+	// Invoked by ApplyStep when the speaker or line changed (button pool mode)
+	UFUNCTION(BlueprintImplementableEvent, Category="Dialogue")
+	void OnLineUpdated_BP();
+
+	// Invoked by ApplyStep for each pooled button whose choice changed; set its text / enabled state here
+	UFUNCTION(BlueprintImplementableEvent, Category="Dialogue")
+	void OnChoiceButtonUpdated_BP(UUserWidget* Button, int32 ChoiceIndex, const FDialogueChoice& Choice);
+
+private:
+	// Pooled choice buttons, in choice order. Buttons past the current choice count are collapsed.
+	UPROPERTY(Transient)
+	TArray<UUserWidget*> ChoiceButtons;
+
+	static bool IsSameChoice(const FDialogueChoice& A, const FDialogueChoice& B);
 };
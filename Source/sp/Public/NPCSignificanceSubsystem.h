@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NPCSignificanceSubsystem.generated.h"
+
+class AspBaseNPC;
+
+// How much per-frame work an NPC gets, from most to least
+UENUM(BlueprintType)
+enum class ENPCSignificanceTier : uint8
+{
+	Full,       // ticks and animates every frame
+	Reduced,    // ticks and animates at ReducedTickInterval, URO on
+	Minimal,    // no actor tick, animates at MinimalTickInterval only while rendered
+	Dormant     // no actor tick, no animation
+};
+
+/**
+ * Ranks every AspBaseNPC in the world by distance to the nearest player view, whether it was
+ * rendered recently and whether it is in a conversation, then hands out tiers against a global
+ * budget: the MaxFullRateNPCs most significant NPCs run at full rate, the next MaxReducedRateNPCs
+ * at a reduced rate, and the rest are throttled further or put to sleep.
+ */
+UCLASS(Config=Game)
+class SP_API UNPCSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UNPCSignificanceSubsystem* Get(const UObject* WorldContextObject);
+
+	// Seconds between re-ranking
+	UPROPERTY(Config, EditAnywhere, Category="Significance")
+	float UpdateInterval = 0.25f;
+
+	UPROPERTY(Config, EditAnywhere, Category="Significance")
+	int32 MaxFullRateNPCs = 16;
+
+	UPROPERTY(Config, EditAnywhere, Category="Significance")
+	int32 MaxReducedRateNPCs = 64;
+
+	// NPCs further than this from every player never get more than Minimal, in cm
+	UPROPERTY(Config, EditAnywhere, Category="Significance")
+	float MaxSignificantDistance = 5000.f;
+
+	UPROPERTY(Config, EditAnywhere, Category="Significance")
+	float ReducedTickInterval = 0.1f;
+
+	UPROPERTY(Config, EditAnywhere, Category="Significance")
+	float MinimalTickInterval = 0.5f;
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return NPCs.Num() > 0; }
+
+	void Register(AspBaseNPC* NPC);
+	void Unregister(AspBaseNPC* NPC);
+
+	// Re-rank on the next tick instead of waiting for UpdateInterval (e.g. a conversation started)
+	void RequestUpdate() { TimeSinceUpdate = UpdateInterval; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void UpdateSignificance();
+
+	TArray<TWeakObjectPtr<AspBaseNPC>> NPCs;
+
+	float TimeSinceUpdate = 0.f;
+};
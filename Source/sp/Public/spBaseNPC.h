@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "NPCSignificanceSubsystem.h"
 #include "spBaseNPC.generated.h"
 
 UCLASS()
@@ -18,6 +20,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:	
 	// Called every frame
@@ -26,4 +29,29 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	// Set by UNPCSignificanceSubsystem. Switches actor tick and mesh animation rate for the tier;
+	// TickInterval is the actor / animation interval to use for Reduced and Minimal.
+	virtual void SetSignificanceTier(ENPCSignificanceTier Tier, float TickInterval);
+
+	UFUNCTION(BlueprintCallable, Category="Significance")
+	ENPCSignificanceTier GetSignificanceTier() const { return SignificanceTier; }
+
+	// NPCs in a conversation always run at full rate
+	void SetInConversation(bool bInConversation);
+
+	UFUNCTION(BlueprintCallable, Category="Significance")
+	bool IsInConversation() const { return bIsInConversation; }
+
+protected:
+	// Leave ticking and animation rate alone, e.g. for hero NPCs that drive cinematics
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Significance")
+	bool bIgnoreSignificance = false;
+
+private:
+	ENPCSignificanceTier SignificanceTier = ENPCSignificanceTier::Full;
+	float SignificanceTickInterval = 0.f;
+	bool bIsInConversation = false;
+
+	// Mesh setting from the asset / Blueprint, restored at full rate
+	EVisibilityBasedAnimTickOption DefaultAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPose;
 };
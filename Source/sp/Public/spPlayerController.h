@@ -57,10 +57,7 @@ public:
 	void HandleDialogueEnded();
 
 	UFUNCTION()
-	void HandleOnDialogueUpdated(const FString& Speaker, const FString& Line);
-
-	UFUNCTION()
-	void HandleOnChoicesUpdated(const TArray<FDialogueChoice>& Choices);
+	void HandleDialogueStep(const FDialogueStep& Step);
 
 	// helper to reduce repetition
 	void SelectChoiceByIndex(int32 Index);
@@ -68,5 +65,8 @@ public:
 	void UpdateDialogueUI();
 
 protected:
+	// Reused by UpdateDialogueUI
+	FDialogueStep UIStep;
+
 	virtual void BeginPlay() override;
 };
@@ -11,11 +11,20 @@ public class sp : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[]
 		{
 			"Core", "CoreUObject", "Engine", "InputCore",
+			"DialogueCore",
 			"Json", "JsonUtilities",
+			"NetCore",
 			"UMG"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] {  });
+		// Disk sizes of assets still streaming in, for the prefetch budget
+		PrivateDependencyModuleNames.AddRange(new string[] { "AssetRegistry" });
+
+		// Hot reload of dialogue JSON while playing in the editor
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DirectoryWatcher");
+		}
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -10,6 +10,6 @@ public class spEditorTarget : TargetRules
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 
-		ExtraModuleNames.AddRange( new string[] { "sp" } );
+		ExtraModuleNames.AddRange( new string[] { "sp", "spEditor" } );
 	}
 }
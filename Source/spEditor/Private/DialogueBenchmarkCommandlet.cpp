@@ -0,0 +1,366 @@
+#include "DialogueBenchmarkCommandlet.h"
+#include "DialogueConditionCache.h"
+#include "DialogueGraph.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueManager.h"
+#include "DialogueSession.h"
+#include "DialogueStats.h"
+#include "HAL/FileManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	// Allocator calls made by the whole process so far, from the engine's own counters (stats builds
+	// only). Reading them needs no allocator swap, so worker threads are never at risk; the flip side is
+	// that their allocations count too, so keep other work (loading, rendering) out of measured sections.
+	bool GetNumAllocs(uint64& OutNumAllocs)
+	{
+#if UE_STATS
+		OutNumAllocs = FMalloc::TotalMallocCalls.Load() + FMalloc::TotalReallocCalls.Load();
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Highest physical memory the process has used so far. The rise across a section is how far the
+	// section pushed the process past its earlier peak: it reflects transient memory (the file text,
+	// parsed nodes and the builder) rather than what the allocator happens to cache afterwards, but reads
+	// 0 when the section stays under a peak reached before it. Sizes are loaded smallest first so each
+	// load has the best chance of setting a new peak.
+	int64 GetPeakUsedPhysical()
+	{
+		return static_cast<int64>(FPlatformMemory::GetStats().PeakUsedPhysical);
+	}
+
+	struct FMetric
+	{
+		FString Name;
+		double Value = 0.0;
+		FString Unit;
+	};
+
+	// Chain of nodes, each with conditioned lines and three choices (the first always unlocked and leading on)
+	FString GenerateDialogueJson(int32 NumNodes)
+	{
+		FString Json;
+		Json.Reserve(NumNodes * 900);
+		Json += TEXT("{\n");
+		for (int32 Index = 0; Index < NumNodes; ++Index)
+		{
+			const FString Next = Index + 1 < NumNodes ? FString::Printf(TEXT("bench_%d"), Index + 1) : FString();
+			Json += FString::Printf(TEXT(
+				"\"bench_%d\": {\"Speaker\": \"Speaker %d\", \"BaseLine\": \"Line %d of the benchmark dialogue.\","
+				"\"AltLines\": [{\"Condition\": \"trust <= -%d\", \"Text\": \"Alt line %d.\"}],"
+				"\"AppendLines\": [{\"Condition\": \"bench_flag_%d || last_topic == \\\"bench\\\"\", \"Text\": \"Appended %d.\"}],"
+				"\"Choices\": ["
+				"{\"Text\": \"Go on.\", \"AltTexts\": [{\"Condition\": \"trust >= 3\", \"Text\": \"Go on, please.\"}], \"Requirements\": [\"trust >= -100\"],"
+				" \"Effects\": [{\"Attribute\": \"trust\", \"Operation\": \"Add\", \"Value\": \"1\"}, {\"Attribute\": \"last_topic\", \"Operation\": \"Set\", \"Value\": \"bench\"}],"
+				" \"NextNodeID\": \"%s\", \"FailureNodeID\": \"\"},"
+				"{\"Text\": \"Ask about it.\", \"AltTexts\": [], \"Requirements\": [\"skill.observation >= %d\"], \"Effects\": [], \"NextNodeID\": \"%s\", \"FailureNodeID\": \"\"},"
+				"{\"Text\": \"Leave.\", \"AltTexts\": [], \"Requirements\": [], \"Effects\": [{\"Attribute\": \"bench_flag_%d\", \"Operation\": \"Toggle\", \"Value\": \"\"}], \"NextNodeID\": \"\", \"FailureNodeID\": \"\"}"
+				"], \"NextNodeID\": \"\"}%s\n"),
+				Index, Index % 8, Index, 1 + Index % 5, Index, Index % 16, Index,
+				*Next, Index % 4, *Next, Index % 16,
+				Index + 1 < NumNodes ? TEXT(",") : TEXT(""));
+		}
+		Json += TEXT("}\n");
+		return Json;
+	}
+
+	FString GetGeneratedPath(int32 NumNodes)
+	{
+		const FString Path = FPaths::ProjectSavedDir() / TEXT("Benchmarks/Generated") / FString::Printf(TEXT("dialogue_%d.json"), NumNodes);
+		if (!IFileManager::Get().FileExists(*Path))
+		{
+			FFileHelper::SaveStringToFile(GenerateDialogueJson(NumNodes), *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+		}
+		return Path;
+	}
+
+	FDialogueGraphRef BenchmarkLoad(const FString& FullPath, const FString& Label, TArray<FMetric>& Metrics)
+	{
+		uint64 AllocsBefore = 0;
+		const bool bCountAllocs = GetNumAllocs(AllocsBefore);
+		const int64 PeakBefore = GetPeakUsedPhysical();
+
+		const double Start = FPlatformTime::Seconds();
+		FDialogueGraphRef Graph = UDialogueGraphSubsystem::ParseGraphAtPath(FullPath, Label);
+		const double Seconds = FPlatformTime::Seconds() - Start;
+
+		const int64 PeakBytes = GetPeakUsedPhysical() - PeakBefore;
+		uint64 AllocsAfter = 0;
+		GetNumAllocs(AllocsAfter);
+
+		if (!Graph)
+		{
+			UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: failed to load %s"), *FullPath);
+			return nullptr;
+		}
+
+		Metrics.Add({ FString::Printf(TEXT("load_%s_ms"), *Label), Seconds * 1000.0, TEXT("ms") });
+		Metrics.Add({ FString::Printf(TEXT("load_%s_peak_kb"), *Label), PeakBytes / 1024.0, TEXT("KiB") });
+		if (bCountAllocs)
+		{
+			Metrics.Add({ FString::Printf(TEXT("load_%s_allocs"), *Label), static_cast<double>(AllocsAfter - AllocsBefore), TEXT("allocs") });
+		}
+		Metrics.Add({ FString::Printf(TEXT("graph_%s_kb"), *Label), Graph->GetAllocatedSize() / 1024.0, TEXT("KiB") });
+		return Graph;
+	}
+
+	void BenchmarkConditions(const FDialogueGraph& Graph, const FString& Label, TArray<FMetric>& Metrics)
+	{
+		const int32 NumConditions = Graph.Conditions.Num();
+		if (NumConditions == 0) return;
+
+		FDialogueState State;
+		State.Set(FDialogueAttributeRegistry::Get().Find(TEXT("trust")), FDialogueValue::MakeInt(2));
+
+		const int32 Rounds = FMath::Max(1, 2000000 / NumConditions);
+		int32 NumTrue = 0;
+
+		double Start = FPlatformTime::Seconds();
+		for (int32 Round = 0; Round < Rounds; ++Round)
+		{
+			for (int32 Index = 0; Index < NumConditions; ++Index)
+			{
+				NumTrue += Graph.EvaluateCondition(Index, State);
+			}
+		}
+		const double Uncached = FPlatformTime::Seconds() - Start;
+
+		FDialogueConditionCache Cache;
+		Start = FPlatformTime::Seconds();
+		for (int32 Round = 0; Round < Rounds; ++Round)
+		{
+			for (int32 Index = 0; Index < NumConditions; ++Index)
+			{
+				NumTrue += Graph.EvaluateCondition(Index, State, &Cache);
+			}
+		}
+		const double Cached = FPlatformTime::Seconds() - Start;
+
+		const double NumEvaluations = static_cast<double>(Rounds) * NumConditions;
+		Metrics.Add({ FString::Printf(TEXT("condition_%s_ns"), *Label), Uncached * 1e9 / NumEvaluations, TEXT("ns") });
+		Metrics.Add({ FString::Printf(TEXT("condition_cached_%s_ns"), *Label), Cached * 1e9 / NumEvaluations, TEXT("ns") });
+		UE_LOG(LogDialogue, Verbose, TEXT("DialogueBenchmark: %d conditions true"), NumTrue);
+	}
+
+	// Walk the generated chain through a manager, always taking the first choice
+	void BenchmarkTraversal(const FDialogueGraphRef& Graph, const FString& Label, TArray<FMetric>& Metrics)
+	{
+		UDialogueManager* Manager = NewObject<UDialogueManager>(GetTransientPackage());
+		Manager->AddToRoot();
+
+		Manager->StartDialogue(FString(Graph->GetNodeId(0)), Graph);
+
+		int32 NumSteps = 0;
+		uint64 AllocsBefore = 0;
+		const bool bCountAllocs = GetNumAllocs(AllocsBefore);
+
+		const double Start = FPlatformTime::Seconds();
+		while (Manager->GetResolvedChoices().Num() > 0)
+		{
+			const int32 Previous = Manager->GetCurrentNodeIndex();
+			Manager->SelectChoice(0);
+			++NumSteps;
+			if (Manager->GetCurrentNodeIndex() == Previous) break;
+		}
+		const double Seconds = FPlatformTime::Seconds() - Start;
+
+		uint64 AllocsAfter = 0;
+		GetNumAllocs(AllocsAfter);
+
+		Manager->RemoveFromRoot();
+		if (NumSteps == 0) return;
+
+		Metrics.Add({ FString::Printf(TEXT("step_%s_us"), *Label), Seconds * 1e6 / NumSteps, TEXT("us") });
+		if (bCountAllocs)
+		{
+			Metrics.Add({ FString::Printf(TEXT("allocs_per_select_%s"), *Label), static_cast<double>(AllocsAfter - AllocsBefore) / NumSteps, TEXT("allocs") });
+		}
+	}
+
+	// The same walk on a bare FDialogueSession, without the manager's events, prefetch and speculation
+	void BenchmarkSession(const FDialogueGraphRef& Graph, const FString& Label, TArray<FMetric>& Metrics)
+	{
+		FDialogueSession Session;
+		Session.SetGraph(Graph);
+		if (!Session.Start(FString(Graph->GetNodeId(0)))) return;
+
+		int32 NumSteps = 0;
+		const double Start = FPlatformTime::Seconds();
+		while (Session.IsActive() && Session.GetChoices().Num() > 0)
+		{
+			Session.GetLine();
+			const int32 Previous = Session.GetNodeIndex();
+			Session.SelectChoice(0);
+			++NumSteps;
+			if (Session.GetNodeIndex() == Previous) break;
+		}
+		const double Seconds = FPlatformTime::Seconds() - Start;
+		if (NumSteps == 0) return;
+
+		Metrics.Add({ FString::Printf(TEXT("step_session_%s_us"), *Label), Seconds * 1e6 / NumSteps, TEXT("us") });
+	}
+
+	bool CheckBaseline(const FString& BaselinePath, const TArray<FMetric>& Metrics, double Tolerance)
+	{
+		FString BaselineText;
+		TSharedPtr<FJsonObject> Baseline;
+		if (!FFileHelper::LoadFileToString(BaselineText, *BaselinePath)
+			|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineText), Baseline)
+			|| !Baseline.IsValid())
+		{
+			UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: can't read baseline %s"), *BaselinePath);
+			return false;
+		}
+
+		const TSharedPtr<FJsonObject>* BaselineMetrics = nullptr;
+		if (!Baseline->TryGetObjectField(TEXT("metrics"), BaselineMetrics))
+		{
+			UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: baseline %s has no metrics"), *BaselinePath);
+			return false;
+		}
+
+		// A metric that appears or disappears means the runs aren't comparable (a benchmark failed,
+		// or the build measures different things); don't let it pass as "no regression"
+		bool bPassed = true;
+		TSet<FString> Measured;
+		for (const FMetric& Metric : Metrics)
+		{
+			Measured.Add(Metric.Name);
+
+			double Expected = 0.0;
+			if (!(*BaselineMetrics)->TryGetNumberField(Metric.Name, Expected))
+			{
+				UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: %s is not in the baseline"), *Metric.Name);
+				bPassed = false;
+				continue;
+			}
+
+			if (Expected > 0.0 && Metric.Value > Expected * (1.0 + Tolerance))
+			{
+				UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: %s regressed: %.3f %s (baseline %.3f)"), *Metric.Name, Metric.Value, *Metric.Unit, Expected);
+				bPassed = false;
+			}
+		}
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : (*BaselineMetrics)->Values)
+		{
+			if (!Measured.Contains(Field.Key))
+			{
+				UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: %s is in the baseline but wasn't measured"), *Field.Key);
+				bPassed = false;
+			}
+		}
+		return bPassed;
+	}
+}
+
+UDialogueBenchmarkCommandlet::UDialogueBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDialogueBenchmarkCommandlet::Main(const FString& Params)
+{
+	const FString Timestamp = FDateTime::Now().ToString();
+
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("DialogueBenchmark-%s.json"), *Timestamp);
+	FParse::Value(*Params, TEXT("out="), OutPath);
+
+	FString BaselinePath;
+	FParse::Value(*Params, TEXT("baseline="), BaselinePath);
+
+	double Tolerance = 0.2;
+	FParse::Value(*Params, TEXT("tolerance="), Tolerance);
+
+	// Flags of the generated dialogues aren't game attributes, so they aren't in the config
+	FDialogueAttributeRegistry::Get().Declare(TEXT("bench_flag_*"), EDialogueValueType::Bool);
+
+	// The manager logs every step; keep that out of the timings
+	const ELogVerbosity::Type PreviousVerbosity = LogDialogue.GetVerbosity();
+	LogDialogue.SetVerbosity(ELogVerbosity::Error);
+
+	TArray<FMetric> Metrics;
+	bool bAllLoaded = true;
+
+	if (FDialogueGraphRef Luka = BenchmarkLoad(FPaths::ProjectContentDir() / TEXT("Dialogues/luka_session_01.json"), TEXT("luka"), Metrics))
+	{
+		BenchmarkConditions(*Luka, TEXT("luka"), Metrics);
+	}
+	else
+	{
+		bAllLoaded = false;
+	}
+
+	for (const int32 NumNodes : { 10000, 100000 })
+	{
+		const FString Label = FString::Printf(TEXT("%dk"), NumNodes / 1000);
+		if (FDialogueGraphRef Generated = BenchmarkLoad(GetGeneratedPath(NumNodes), Label, Metrics))
+		{
+			BenchmarkConditions(*Generated, Label, Metrics);
+			BenchmarkTraversal(Generated, Label, Metrics);
+			BenchmarkSession(Generated, Label, Metrics);
+		}
+		else
+		{
+			bAllLoaded = false;
+		}
+	}
+
+	LogDialogue.SetVerbosity(PreviousVerbosity);
+
+	// One JSON file per run, usable as a later baseline
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	TSharedRef<FJsonObject> MetricsObject = MakeShared<FJsonObject>();
+	for (const FMetric& Metric : Metrics)
+	{
+		MetricsObject->SetNumberField(Metric.Name, Metric.Value);
+	}
+	Root->SetStringField(TEXT("timestamp"), Timestamp);
+	Root->SetStringField(TEXT("configuration"), LexToString(FApp::GetBuildConfiguration()));
+	Root->SetObjectField(TEXT("metrics"), MetricsObject);
+
+	FString JsonText;
+	FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&JsonText));
+	FFileHelper::SaveStringToFile(JsonText, *OutPath);
+
+	// History across runs
+	const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks/DialogueBenchmark.csv");
+	FString Csv;
+	if (!IFileManager::Get().FileExists(*CsvPath))
+	{
+		Csv += TEXT("Timestamp,Metric,Value,Unit\n");
+	}
+	for (const FMetric& Metric : Metrics)
+	{
+		Csv += FString::Printf(TEXT("%s,%s,%f,%s\n"), *Timestamp, *Metric.Name, Metric.Value, *Metric.Unit);
+		UE_LOG(LogDialogue, Display, TEXT("DialogueBenchmark: %-32s %12.3f %s"), *Metric.Name, Metric.Value, *Metric.Unit);
+	}
+	FFileHelper::SaveStringToFile(Csv, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogDialogue, Display, TEXT("DialogueBenchmark: results written to %s"), *OutPath);
+
+	if (!bAllLoaded)
+	{
+		UE_LOG(LogDialogue, Error, TEXT("DialogueBenchmark: a benchmark dialogue failed to load, results are incomplete"));
+		return 1;
+	}
+	if (!BaselinePath.IsEmpty() && !CheckBaseline(BaselinePath, Metrics, Tolerance))
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,470 @@
+#include "DialogueExplorerCommandlet.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "DialogueDataLoader.h"
+#include "DialogueGraph.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueStats.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	uint32 HashValue(const FDialogueValue& Value)
+	{
+		// Consistent with FDialogueValue::operator==, which only compares the field of the value's type
+		switch (Value.Type)
+		{
+		case EDialogueValueType::Int:
+		case EDialogueValueType::Bool:  return HashCombine(1, GetTypeHash(Value.Int));
+		case EDialogueValueType::Float: return HashCombine(2, GetTypeHash(Value.Float));
+		case EDialogueValueType::Name:  return HashCombine(3, GetTypeHash(Value.Name));
+		default:                        return 0;
+		}
+	}
+
+	// A node reached with some state. Two of these are the same if the node and every attribute
+	// value match; slot versions don't count.
+	struct FExploreState
+	{
+		int32 NodeIndex = INDEX_NONE;
+		FDialogueState State;
+		uint32 Hash = 0;
+
+		FExploreState() = default;
+		FExploreState(int32 InNodeIndex, FDialogueState&& InState)
+			: NodeIndex(InNodeIndex)
+			, State(MoveTemp(InState))
+		{
+			Hash = GetTypeHash(NodeIndex);
+			const TArray<FDialogueValue>& Values = State.GetValues();
+			for (int32 Slot = 0; Slot < NumSetValues(); ++Slot)
+			{
+				Hash = HashCombine(Hash, HashValue(Values[Slot]));
+			}
+		}
+
+		// Values up to the last one that was ever set
+		int32 NumSetValues() const
+		{
+			const TArray<FDialogueValue>& Values = State.GetValues();
+			int32 Num = Values.Num();
+			while (Num > 0 && Values[Num - 1].Type == EDialogueValueType::None) --Num;
+			return Num;
+		}
+
+		bool operator==(const FExploreState& Other) const
+		{
+			if (Hash != Other.Hash || NodeIndex != Other.NodeIndex) return false;
+
+			const int32 Num = NumSetValues();
+			if (Num != Other.NumSetValues()) return false;
+			for (int32 Slot = 0; Slot < Num; ++Slot)
+			{
+				if (State.GetValues()[Slot] != Other.State.GetValues()[Slot]) return false;
+			}
+			return true;
+		}
+
+		friend uint32 GetTypeHash(const FExploreState& Explore) { return Explore.Hash; }
+	};
+
+	struct FAttributeBound
+	{
+		int32 Slot = INDEX_NONE;
+		double Min = 0.0;
+		double Max = 0.0;
+	};
+
+	// What one task found while expanding its share of a level
+	struct FExpandContext
+	{
+		TArray<FExploreState> Next;
+		TBitArray<> NodesReached;
+		TBitArray<> LinesApplied;
+
+		// Node index -> number of states that got stuck there
+		TMap<int32, int32> DeadEnds;
+
+		int64 NumPruned = 0;
+		int64 NumEndings = 0;
+	};
+
+	struct FExplorer
+	{
+		const FDialogueGraph& Graph;
+		TArray<FAttributeBound> Bounds;
+		bool bShowLocked = false;
+
+		explicit FExplorer(const FDialogueGraph& InGraph)
+			: Graph(InGraph)
+		{
+		}
+
+		bool InBounds(const FDialogueState& State) const
+		{
+			for (const FAttributeBound& Bound : Bounds)
+			{
+				const FDialogueValue* Value = State.GetValue(Bound.Slot);
+				if (!Value) continue;
+
+				double Number;
+				if (Value->Type == EDialogueValueType::Int) Number = Value->Int;
+				else if (Value->Type == EDialogueValueType::Float) Number = Value->Float;
+				else continue;
+
+				if (Number < Bound.Min || Number > Bound.Max) return false;
+			}
+			return true;
+		}
+
+		// Mark the first line of Range whose condition passes, like FDialogueGraph::ResolveLine does for alt lines
+		void MarkFirstPassing(const FDialogueRange& Range, const FDialogueState& State, FExpandContext& Context) const
+		{
+			for (int32 Index = Range.First; Index < Range.End(); ++Index)
+			{
+				if (Graph.EvaluateCondition(Graph.Lines[Index].Condition, State))
+				{
+					Context.LinesApplied[Index] = true;
+					return;
+				}
+			}
+		}
+
+		void MarkAllPassing(const FDialogueRange& Range, const FDialogueState& State, FExpandContext& Context) const
+		{
+			for (int32 Index = Range.First; Index < Range.End(); ++Index)
+			{
+				if (Graph.EvaluateCondition(Graph.Lines[Index].Condition, State))
+				{
+					Context.LinesApplied[Index] = true;
+				}
+			}
+		}
+
+		// Same decisions as UDialogueManager::SelectChoice / AdvanceDialogue
+		void Expand(const FExploreState& From, FExpandContext& Context) const
+		{
+			if (Context.NodesReached.Num() == 0)
+			{
+				Context.NodesReached.Init(false, Graph.NumNodes());
+				Context.LinesApplied.Init(false, Graph.Lines.Num());
+			}
+
+			const FDialogueState& State = From.State;
+			const FDialogueGraphNode& Node = Graph.Nodes[From.NodeIndex];
+			Context.NodesReached[From.NodeIndex] = true;
+			MarkFirstPassing(Node.AltLines, State, Context);
+			MarkAllPassing(Node.AppendLines, State, Context);
+
+			if (Node.Choices.Num == 0)
+			{
+				// Links into other files end the walk of this one
+				if (Node.Next < 0)
+				{
+					++Context.NumEndings;
+				}
+				else
+				{
+					Context.Next.Emplace(Node.Next, FDialogueState(State));
+				}
+				return;
+			}
+
+			bool bCanContinue = false;
+			for (int32 ChoiceIndex = Node.Choices.First; ChoiceIndex < Node.Choices.End(); ++ChoiceIndex)
+			{
+				const FDialogueGraphChoice& Choice = Graph.Choices[ChoiceIndex];
+				if (Graph.IsChoiceUnlocked(Choice, State))
+				{
+					bCanContinue = true;
+					MarkFirstPassing(Choice.AltTexts, State, Context);
+					if (Choice.Next < 0)
+					{
+						++Context.NumEndings;
+						continue;
+					}
+
+					FDialogueState After = State;
+					Graph.ApplyEffects(Choice, After);
+					if (!InBounds(After))
+					{
+						++Context.NumPruned;
+						continue;
+					}
+					Context.Next.Emplace(Choice.Next, MoveTemp(After));
+				}
+				else if (bShowLocked)
+				{
+					MarkFirstPassing(Choice.AltTexts, State, Context);
+					if (Choice.Failure >= 0)
+					{
+						bCanContinue = true;
+						Context.Next.Emplace(Choice.Failure, FDialogueState(State));
+					}
+				}
+			}
+
+			if (!bCanContinue)
+			{
+				++Context.DeadEnds.FindOrAdd(From.NodeIndex);
+			}
+		}
+	};
+
+	bool ParseBounds(const FString& Text, TArray<FAttributeBound>& OutBounds)
+	{
+		TArray<FString> Entries;
+		Text.ParseIntoArray(Entries, TEXT(","));
+		for (const FString& Entry : Entries)
+		{
+			TArray<FString> Parts;
+			Entry.ParseIntoArray(Parts, TEXT(":"));
+			if (Parts.Num() != 3 || !Parts[1].IsNumeric() || !Parts[2].IsNumeric())
+			{
+				UE_LOG(LogDialogue, Error, TEXT("DialogueExplorer: bad bound '%s', expected attribute:min:max"), *Entry);
+				return false;
+			}
+
+			FAttributeBound Bound;
+			Bound.Slot = FDialogueAttributeRegistry::Get().Find(FName(*Parts[0]));
+			Bound.Min = FCString::Atod(*Parts[1]);
+			Bound.Max = FCString::Atod(*Parts[2]);
+			if (Bound.Slot == INDEX_NONE)
+			{
+				UE_LOG(LogDialogue, Warning, TEXT("DialogueExplorer: attribute '%s' is never used by the file, ignoring its bound"), *Parts[0]);
+				continue;
+			}
+			OutBounds.Add(Bound);
+		}
+		return true;
+	}
+}
+
+UDialogueExplorerCommandlet::UDialogueExplorerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDialogueExplorerCommandlet::Main(const FString& Params)
+{
+	FString File = TEXT("Dialogues/luka_session_01.json");
+	FParse::Value(*Params, TEXT("file="), File);
+
+	FString StartNodeID = TEXT("start");
+	FParse::Value(*Params, TEXT("start="), StartNodeID);
+
+	FString BoundsText;
+	FParse::Value(*Params, TEXT("bounds="), BoundsText, false);
+
+	int64 MaxStates = 2000000;
+	FParse::Value(*Params, TEXT("maxstates="), MaxStates);
+
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("DialogueExplorer") / FPaths::GetBaseFilename(File) + TEXT(".json");
+	FParse::Value(*Params, TEXT("out="), OutPath);
+
+	const FString FullPath = FPaths::ProjectContentDir() / File;
+	FDialogueGraphRef Graph = UDialogueGraphSubsystem::ParseGraphAtPath(FullPath, File);
+	if (!Graph) return 1;
+
+	const int32 StartIndex = Graph->FindNodeIndex(StartNodeID);
+	if (StartIndex == INDEX_NONE)
+	{
+		UE_LOG(LogDialogue, Error, TEXT("DialogueExplorer: %s has no node '%s'"), *File, *StartNodeID);
+		return 1;
+	}
+
+	// Attributes are registered while the graph builds, so bounds resolve after it
+	FExplorer Explorer(*Graph);
+	Explorer.bShowLocked = FParse::Param(*Params, TEXT("showlocked"));
+	if (!ParseBounds(BoundsText, Explorer.Bounds)) return 1;
+
+	// Links to missing nodes are dropped from the built graph, so check them on the authored data
+	TArray<TSharedPtr<FJsonValue>> Dangling;
+	{
+		TMap<FString, FDialogueNode> Authored;
+		UDialogueDataLoader::ParseDialogueFileAtPath(FullPath, Authored);
+		auto CheckLink = [&](const FString& From, const FString& Target)
+		{
+			// "file:node" links point outside this file and are resolved when followed
+			if (Target.IsEmpty() || Target.Contains(TEXT(":")) || Authored.Contains(Target)) return;
+
+			TSharedRef<FJsonObject> Link = MakeShared<FJsonObject>();
+			Link->SetStringField(TEXT("node"), From);
+			Link->SetStringField(TEXT("target"), Target);
+			Dangling.Add(MakeShared<FJsonValueObject>(Link));
+		};
+		for (const TPair<FString, FDialogueNode>& Pair : Authored)
+		{
+			CheckLink(Pair.Key, Pair.Value.NextNodeID);
+			for (const FDialogueChoice& Choice : Pair.Value.Choices)
+			{
+				CheckLink(Pair.Key, Choice.NextNodeID);
+				CheckLink(Pair.Key, Choice.FailureNodeID);
+			}
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Visited states, sharded by hash so each shard can be filled by its own task
+	const int32 NumShards = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) * 2;
+	TArray<TSet<FExploreState>> Visited;
+	Visited.SetNum(NumShards);
+
+	TArray<FExploreState> Frontier;
+	Frontier.Emplace(StartIndex, FDialogueState());
+	Visited[Frontier[0].Hash % NumShards].Add(Frontier[0]);
+
+	TBitArray<> NodesReached(false, Graph->NumNodes());
+	TBitArray<> LinesApplied(false, Graph->Lines.Num());
+	TMap<int32, int32> DeadEnds;
+	int64 NumStates = 1;
+	int64 NumPruned = 0;
+	int64 NumEndings = 0;
+	int32 Depth = 0;
+	bool bTruncated = false;
+
+	TArray<FExpandContext> Contexts;
+	TArray<TArray<FExploreState>> ShardNext;
+	while (Frontier.Num() > 0)
+	{
+		ParallelForWithTaskContext(TEXT("DialogueExplorer.Expand"), Contexts, Frontier.Num(), 64,
+			[&Explorer, &Frontier](FExpandContext& Context, int32 Index)
+			{
+				Explorer.Expand(Frontier[Index], Context);
+			});
+
+		for (FExpandContext& Context : Contexts)
+		{
+			if (Context.NodesReached.Num() == 0) continue;
+
+			NodesReached.CombineWithBitwiseOR(Context.NodesReached, EBitwiseOperatorFlags::MaintainSize);
+			LinesApplied.CombineWithBitwiseOR(Context.LinesApplied, EBitwiseOperatorFlags::MaintainSize);
+			for (const TPair<int32, int32>& DeadEnd : Context.DeadEnds)
+			{
+				DeadEnds.FindOrAdd(DeadEnd.Key) += DeadEnd.Value;
+			}
+			NumPruned += Context.NumPruned;
+			NumEndings += Context.NumEndings;
+		}
+
+		// Deduplicate: every shard takes the new states that hash to it, so no two tasks touch the same set
+		ShardNext.SetNum(NumShards);
+		ParallelFor(TEXT("DialogueExplorer.Dedupe"), NumShards, 1, [&Visited, &Contexts, &ShardNext, NumShards](int32 Shard)
+		{
+			TArray<FExploreState>& Out = ShardNext[Shard];
+			Out.Reset();
+			for (const FExpandContext& Context : Contexts)
+			{
+				for (const FExploreState& State : Context.Next)
+				{
+					if (State.Hash % NumShards != static_cast<uint32>(Shard)) continue;
+
+					bool bAlreadyVisited = false;
+					Visited[Shard].Add(State, &bAlreadyVisited);
+					if (!bAlreadyVisited) Out.Add(State);
+				}
+			}
+		});
+
+		Frontier.Reset();
+		for (TArray<FExploreState>& Next : ShardNext)
+		{
+			Frontier.Append(MoveTemp(Next));
+		}
+		NumStates += Frontier.Num();
+		++Depth;
+
+		if (NumStates > MaxStates)
+		{
+			bTruncated = true;
+			break;
+		}
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	// Report
+	TArray<TSharedPtr<FJsonValue>> Unreachable;
+	TArray<TSharedPtr<FJsonValue>> NotVisited;
+	TArray<TSharedPtr<FJsonValue>> DeadEndList;
+	TArray<TSharedPtr<FJsonValue>> NeverApplied;
+	for (int32 NodeIndex = 0; NodeIndex < Graph->NumNodes(); ++NodeIndex)
+	{
+		const FString NodeID(Graph->GetNodeId(NodeIndex));
+		if (!NodesReached[NodeIndex])
+		{
+			// A walk cut short by -maxstates can't tell a node is unreachable, only that it got no further
+			(bTruncated ? NotVisited : Unreachable).Add(MakeShared<FJsonValueString>(NodeID));
+			continue;
+		}
+
+		if (const int32* NumStuck = DeadEnds.Find(NodeIndex))
+		{
+			TSharedRef<FJsonObject> DeadEnd = MakeShared<FJsonObject>();
+			DeadEnd->SetStringField(TEXT("node"), NodeID);
+			DeadEnd->SetNumberField(TEXT("states"), *NumStuck);
+			DeadEndList.Add(MakeShared<FJsonValueObject>(DeadEnd));
+		}
+
+		auto CheckLines = [&](const FDialogueRange& Range, const TCHAR* Kind, int32 ChoiceIndex)
+		{
+			for (int32 Index = Range.First; Index < Range.End(); ++Index)
+			{
+				if (LinesApplied[Index]) continue;
+
+				TSharedRef<FJsonObject> Line = MakeShared<FJsonObject>();
+				Line->SetStringField(TEXT("node"), NodeID);
+				Line->SetStringField(TEXT("kind"), Kind);
+				if (ChoiceIndex != INDEX_NONE) Line->SetNumberField(TEXT("choice"), ChoiceIndex);
+				Line->SetNumberField(TEXT("index"), Index - Range.First);
+				Line->SetStringField(TEXT("text"), FString(Graph->GetString(Graph->Lines[Index].Text)));
+				NeverApplied.Add(MakeShared<FJsonValueObject>(Line));
+			}
+		};
+		const FDialogueGraphNode& Node = Graph->Nodes[NodeIndex];
+		CheckLines(Node.AltLines, TEXT("alt_line"), INDEX_NONE);
+		CheckLines(Node.AppendLines, TEXT("append_line"), INDEX_NONE);
+		for (int32 ChoiceIndex = 0; ChoiceIndex < Node.Choices.Num; ++ChoiceIndex)
+		{
+			CheckLines(Graph->Choices[Node.Choices.First + ChoiceIndex].AltTexts, TEXT("alt_text"), ChoiceIndex);
+		}
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("file"), File);
+	Root->SetStringField(TEXT("start"), StartNodeID);
+	Root->SetNumberField(TEXT("states"), static_cast<double>(NumStates));
+	Root->SetNumberField(TEXT("depth"), Depth);
+	Root->SetNumberField(TEXT("pruned"), static_cast<double>(NumPruned));
+	Root->SetNumberField(TEXT("endings"), static_cast<double>(NumEndings));
+	Root->SetBoolField(TEXT("truncated"), bTruncated);
+	Root->SetNumberField(TEXT("seconds"), Seconds);
+	Root->SetArrayField(TEXT("unreachable"), Unreachable);
+	Root->SetArrayField(TEXT("not_visited"), NotVisited);
+	Root->SetArrayField(TEXT("dangling"), Dangling);
+	Root->SetArrayField(TEXT("dead_ends"), DeadEndList);
+	Root->SetArrayField(TEXT("never_applied"), NeverApplied);
+
+	FString JsonText;
+	FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&JsonText));
+	FFileHelper::SaveStringToFile(JsonText, *OutPath);
+
+	UE_LOG(LogDialogue, Display, TEXT("DialogueExplorer: %s: %lld states to depth %d in %.2f s%s (%lld pruned, %lld endings)"),
+		*File, NumStates, Depth, Seconds, bTruncated ? TEXT(", truncated at -maxstates") : TEXT(""), NumPruned, NumEndings);
+	UE_LOG(LogDialogue, Display, TEXT("DialogueExplorer: %d unreachable, %d dangling links, %d dead ends, %d lines never applied"),
+		Unreachable.Num(), Dangling.Num(), DeadEndList.Num(), NeverApplied.Num());
+	if (NotVisited.Num() > 0)
+	{
+		UE_LOG(LogDialogue, Warning, TEXT("DialogueExplorer: %d nodes not visited (truncated); raise -maxstates or tighten -bounds to check them"), NotVisited.Num());
+	}
+	UE_LOG(LogDialogue, Display, TEXT("DialogueExplorer: report written to %s"), *OutPath);
+
+	return Unreachable.Num() > 0 || Dangling.Num() > 0 || DeadEndList.Num() > 0 ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+#include "DialogueGraphFactory.h"
+#include "DialogueDataLoader.h"
+#include "DialogueGraphAsset.h"
+#include "EditorFramework/AssetImportData.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UDialogueGraphFactory::UDialogueGraphFactory()
+{
+	SupportedClass = UDialogueGraphAsset::StaticClass();
+	Formats.Add(TEXT("json;Dialogue JSON"));
+	bCreateNew = false;
+	bEditorImport = true;
+	bText = false;
+}
+
+bool UDialogueGraphFactory::FactoryCanImport(const FString& Filename)
+{
+	if (!FPaths::GetExtension(Filename).Equals(TEXT("json"), ESearchCase::IgnoreCase))
+	{
+		return false;
+	}
+
+	// Other JSON files (data tables, curves...) are left to their own factories
+	FString Contents;
+	return FFileHelper::LoadFileToString(Contents, *Filename)
+		&& Contents.Contains(TEXT("\"BaseLine\""))
+		&& Contents.Contains(TEXT("\"Speaker\""));
+}
+
+UObject* UDialogueGraphFactory::FactoryCreateFile(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags,
+	const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled)
+{
+	TMap<FString, FDialogueNode> ParsedNodes;
+	if (!UDialogueDataLoader::ParseDialogueFileAtPath(Filename, ParsedNodes))
+	{
+		Warn->Logf(ELogVerbosity::Error, TEXT("Failed to import dialogue from %s"), *Filename);
+		return nullptr;
+	}
+
+	UDialogueGraphAsset* Asset = NewObject<UDialogueGraphAsset>(InParent, InClass, InName, Flags);
+	Asset->SetNodes(MoveTemp(ParsedNodes));
+	Asset->AssetImportData->Update(Filename);
+	return Asset;
+}
+
+bool UDialogueGraphFactory::CanReimport(UObject* Obj, TArray<FString>& OutFilenames)
+{
+	const UDialogueGraphAsset* Asset = Cast<UDialogueGraphAsset>(Obj);
+	if (!Asset || !Asset->AssetImportData) return false;
+
+	Asset->AssetImportData->ExtractFilenames(OutFilenames);
+	return true;
+}
+
+void UDialogueGraphFactory::SetReimportPaths(UObject* Obj, const TArray<FString>& NewReimportPaths)
+{
+	UDialogueGraphAsset* Asset = Cast<UDialogueGraphAsset>(Obj);
+	if (Asset && Asset->AssetImportData && NewReimportPaths.Num() == 1)
+	{
+		Asset->AssetImportData->UpdateFilenameOnly(NewReimportPaths[0]);
+	}
+}
+
+EReimportResult::Type UDialogueGraphFactory::Reimport(UObject* Obj)
+{
+	UDialogueGraphAsset* Asset = Cast<UDialogueGraphAsset>(Obj);
+	if (!Asset || !Asset->AssetImportData) return EReimportResult::Failed;
+
+	const FString Filename = Asset->AssetImportData->GetFirstFilename();
+	if (Filename.IsEmpty() || !FPaths::FileExists(Filename)) return EReimportResult::Failed;
+
+	TMap<FString, FDialogueNode> ParsedNodes;
+	if (!UDialogueDataLoader::ParseDialogueFileAtPath(Filename, ParsedNodes))
+	{
+		return EReimportResult::Failed;
+	}
+
+	Asset->Modify();
+	Asset->SetNodes(MoveTemp(ParsedNodes));
+	Asset->AssetImportData->Update(Filename);
+	Asset->MarkPackageDirty();
+	return EReimportResult::Succeeded;
+}
+
+int32 UDialogueGraphFactory::GetPriority() const
+{
+	return ImportPriority;
+}
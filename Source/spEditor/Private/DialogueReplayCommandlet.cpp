@@ -0,0 +1,237 @@
+#include "DialogueReplayCommandlet.h"
+#include "DialogueGraph.h"
+#include "DialogueGraphAsset.h"
+#include "DialogueGraphSubsystem.h"
+#include "DialogueManager.h"
+#include "DialogueRecording.h"
+#include "DialogueStats.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	struct FReplayResult
+	{
+		// Step that diverged, INDEX_NONE if every step matched
+		int32 FailedStep = INDEX_NONE;
+		FString Reason;
+	};
+
+	FDialogueGraphRef LoadRecordedGraph(const FString& GraphPath)
+	{
+		// Asset graphs report their object path, file graphs their path under Content
+		if (GraphPath.StartsWith(TEXT("/")))
+		{
+			const UDialogueGraphAsset* Asset = LoadObject<UDialogueGraphAsset>(nullptr, *GraphPath);
+			return Asset ? Asset->BuildGraph() : nullptr;
+		}
+		return UDialogueGraphSubsystem::ParseGraphAtPath(FPaths::ProjectContentDir() / GraphPath, GraphPath);
+	}
+
+	FString DescribeNode(const UDialogueManager& Manager, int32 NodeIndex)
+	{
+		if (NodeIndex == INDEX_NONE) return TEXT("<ended>");
+		const FDialogueGraphRef& Graph = Manager.GetActiveGraph();
+		return Graph && Graph->GetNode(NodeIndex)
+			? FString(Graph->GetNodeId(NodeIndex))
+			: FString::Printf(TEXT("#%d"), NodeIndex);
+	}
+
+	// Feed Recording's inputs to Manager, checking the outcome of each
+	FReplayResult Replay(const FDialogueRecording& Recording, const FDialogueGraphRef& Graph, UDialogueManager& Manager)
+	{
+		FReplayResult Result;
+		Manager.bShowLockedChoices = Recording.bShowLockedChoices;
+		Manager.SetState(Recording.MakeInitialState());
+
+		for (int32 StepIndex = 0; StepIndex < Recording.Steps.Num(); ++StepIndex)
+		{
+			const FDialogueRecordedStep& Step = Recording.Steps[StepIndex];
+			switch (Step.Input)
+			{
+			case EDialogueRecordedInput::Start:        Manager.StartDialogue(Recording.StartNodeID, Graph); break;
+			case EDialogueRecordedInput::SelectChoice: Manager.SelectChoice(Step.ChoiceIndex); break;
+			case EDialogueRecordedInput::Advance:      Manager.AdvanceDialogue(); break;
+			}
+
+			const bool bActive = Manager.IsDialogueActive();
+			const int32 NodeIndex = bActive ? Manager.GetCurrentNodeIndex() : INDEX_NONE;
+			if (NodeIndex != Step.NodeIndex)
+			{
+				Result.Reason = FString::Printf(TEXT("at node %s, recorded %s"), *DescribeNode(Manager, NodeIndex), *DescribeNode(Manager, Step.NodeIndex));
+			}
+			else if (FDialogueRecording::HashLine(bActive ? Manager.GetCurrentLine() : FString()) != Step.LineHash)
+			{
+				Result.Reason = FString::Printf(TEXT("line of %s differs: \"%s\""), *DescribeNode(Manager, NodeIndex), *Manager.GetCurrentLine());
+			}
+			else if (FDialogueRecording::HashState(Manager.GetState()) != Step.StateHash)
+			{
+				Result.Reason = FString::Printf(TEXT("state differs after %s"), *DescribeNode(Manager, NodeIndex));
+			}
+
+			if (!Result.Reason.IsEmpty())
+			{
+				Result.FailedStep = StepIndex;
+				break;
+			}
+		}
+		return Result;
+	}
+}
+
+UDialogueReplayCommandlet::UDialogueReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDialogueReplayCommandlet::Main(const FString& Params)
+{
+	FString RecordingPath = FPaths::ProjectSavedDir() / TEXT("DialogueRecordings");
+	FParse::Value(*Params, TEXT("recording="), RecordingPath);
+
+	int32 Repeat = 1;
+	FParse::Value(*Params, TEXT("repeat="), Repeat);
+	Repeat = FMath::Max(Repeat, 1);
+
+	const bool bIgnoreHash = FParse::Param(*Params, TEXT("ignorehash"));
+
+	FString OutPath = FPaths::ProjectSavedDir() / TEXT("DialogueReplay") / TEXT("replay.json");
+	FParse::Value(*Params, TEXT("out="), OutPath);
+
+	TArray<FString> Files;
+	if (IFileManager::Get().DirectoryExists(*RecordingPath))
+	{
+		IFileManager::Get().FindFiles(Files, *(RecordingPath / TEXT("*.dlgrec")), true, false);
+		Files.Sort();
+		for (FString& File : Files)
+		{
+			File = RecordingPath / File;
+		}
+	}
+	else
+	{
+		Files.Add(RecordingPath);
+	}
+
+	struct FEntry
+	{
+		FString File;
+		FDialogueRecording Recording;
+		FDialogueGraphRef Graph;
+		FReplayResult Result;
+	};
+	TArray<FEntry> Entries;
+	TMap<FString, FDialogueGraphRef> Graphs;
+	int32 NumFailed = 0;
+
+	// Load everything up front so the timed replay only runs the dialogue
+	for (const FString& File : Files)
+	{
+		FEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.File = File;
+		if (!Entry.Recording.LoadFromFile(File))
+		{
+			Entry.Result.Reason = TEXT("not a dialogue recording");
+			continue;
+		}
+
+		FDialogueGraphRef& Graph = Graphs.FindOrAdd(Entry.Recording.GraphPath);
+		if (!Graph)
+		{
+			Graph = LoadRecordedGraph(Entry.Recording.GraphPath);
+		}
+		if (!Graph)
+		{
+			Entry.Result.Reason = FString::Printf(TEXT("can't load %s"), *Entry.Recording.GraphPath);
+		}
+		else if (Graph->GetContentHash() != Entry.Recording.GraphHash && !bIgnoreHash)
+		{
+			Entry.Result.Reason = FString::Printf(TEXT("%s changed since it was recorded"), *Entry.Recording.GraphPath);
+		}
+		else
+		{
+			Entry.Graph = Graph;
+		}
+	}
+
+	// No world, UI, speculation or media: only the work a step itself does
+	UDialogueManager* Manager = NewObject<UDialogueManager>(GetTransientPackage());
+	Manager->AddToRoot();
+	Manager->bSpeculateSuccessors = false;
+	Manager->PrefetchHops = 0;
+	Manager->bRecordDialogues = false;
+
+	const ELogVerbosity::Type PreviousVerbosity = LogDialogue.GetVerbosity();
+	LogDialogue.SetVerbosity(ELogVerbosity::Error);
+
+	int64 NumSteps = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Round = 0; Round < Repeat; ++Round)
+	{
+		for (FEntry& Entry : Entries)
+		{
+			if (!Entry.Graph) continue;
+
+			Entry.Result = Replay(Entry.Recording, Entry.Graph, *Manager);
+			NumSteps += Entry.Result.FailedStep == INDEX_NONE ? Entry.Recording.Steps.Num() : Entry.Result.FailedStep + 1;
+
+			// A diverged recording diverges the same way every round
+			if (Entry.Result.FailedStep != INDEX_NONE)
+			{
+				Entry.Graph.Reset();
+			}
+		}
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	LogDialogue.SetVerbosity(PreviousVerbosity);
+	Manager->RemoveFromRoot();
+
+	TArray<TSharedPtr<FJsonValue>> Results;
+	for (const FEntry& Entry : Entries)
+	{
+		const bool bPassed = Entry.Result.Reason.IsEmpty();
+		NumFailed += bPassed ? 0 : 1;
+
+		TSharedRef<FJsonObject> Item = MakeShared<FJsonObject>();
+		Item->SetStringField(TEXT("recording"), FPaths::GetCleanFilename(Entry.File));
+		Item->SetStringField(TEXT("graph"), Entry.Recording.GraphPath);
+		Item->SetNumberField(TEXT("steps"), Entry.Recording.Steps.Num());
+		Item->SetBoolField(TEXT("passed"), bPassed);
+		if (!bPassed)
+		{
+			Item->SetNumberField(TEXT("failed_step"), Entry.Result.FailedStep);
+			Item->SetStringField(TEXT("reason"), Entry.Result.Reason);
+			UE_LOG(LogDialogue, Error, TEXT("DialogueReplay: %s, step %d: %s"),
+				*FPaths::GetCleanFilename(Entry.File), Entry.Result.FailedStep, *Entry.Result.Reason);
+		}
+		Results.Add(MakeShared<FJsonValueObject>(Item));
+	}
+
+	const double StepsPerSecond = Seconds > 0.0 ? NumSteps / Seconds : 0.0;
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("recordings"), Entries.Num());
+	Root->SetNumberField(TEXT("failed"), NumFailed);
+	Root->SetNumberField(TEXT("repeat"), Repeat);
+	Root->SetNumberField(TEXT("steps"), static_cast<double>(NumSteps));
+	Root->SetNumberField(TEXT("seconds"), Seconds);
+	Root->SetNumberField(TEXT("steps_per_second"), StepsPerSecond);
+	Root->SetArrayField(TEXT("results"), Results);
+
+	FString JsonText;
+	FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&JsonText));
+	FFileHelper::SaveStringToFile(JsonText, *OutPath);
+
+	UE_LOG(LogDialogue, Display, TEXT("DialogueReplay: %d recordings, %d failed; %lld steps in %.3f s (%.0f steps/s)"),
+		Entries.Num(), NumFailed, NumSteps, Seconds, StepsPerSecond);
+	UE_LOG(LogDialogue, Display, TEXT("DialogueReplay: report written to %s"), *OutPath);
+
+	return NumFailed > 0 ? 1 : 0;
+}
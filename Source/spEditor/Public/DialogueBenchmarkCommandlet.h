@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the dialogue runtime.
+ *
+ *   UnrealEditor-Cmd sp.uproject -run=DialogueBenchmark -nullrhi [-out=Path.json] [-baseline=Path.json] [-tolerance=0.2]
+ *
+ * Measures condition evaluation, graph load time and peak memory (luka_session_01.json and generated
+ * 10k / 100k node graphs), traversal cost per step and allocations per SelectChoice.
+ * Every metric is "lower is better". Results are written as JSON (one file per run) and appended to
+ * Saved/Benchmarks/DialogueBenchmark.csv. With -baseline, the run fails (exit code 1) if any metric
+ * is worse than the baseline by more than the tolerance.
+ */
+UCLASS()
+class SPEDITOR_API UDialogueBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
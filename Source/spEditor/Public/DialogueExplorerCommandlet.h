@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueExplorerCommandlet.generated.h"
+
+/**
+ * Exhaustive QA walk over a dialogue file.
+ *
+ *   UnrealEditor-Cmd sp.uproject -run=DialogueExplorer -nullrhi [-file=Dialogues/luka_session_01.json] [-start=start]
+ *       [-bounds=trust:-3:3,skill.observation:0:2] [-showlocked] [-maxstates=2000000] [-out=Path.json]
+ *
+ * Breadth-first search over (node, state) pairs from the start node with an empty state, choosing every
+ * available choice and applying its effects exactly like UDialogueManager does. Equal states on the
+ * same node are explored once. States with a numeric attribute outside its -bounds are pruned.
+ * Each level is expanded in parallel on all cores.
+ *
+ * Reports unreachable nodes, links to missing nodes, dead ends (a node reached with choices but none
+ * the player can take) and alt lines, append lines and alt texts that never apply on any reachable
+ * state. Writes the report as JSON (default Saved/DialogueExplorer/<file>.json). Exits with 1 if a node
+ * is unreachable, a link dangles or a dead end was found; lines that never apply are only reported.
+ */
+UCLASS()
+class SPEDITOR_API UDialogueExplorerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueExplorerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Factories/Factory.h"
+#include "EditorReimportHandler.h"
+#include "DialogueGraphFactory.generated.h"
+
+/**
+ * Imports a dialogue JSON file (same format as Content/Dialogues) as a UDialogueGraphAsset,
+ * and reimports it when the source file changes.
+ */
+UCLASS()
+class SPEDITOR_API UDialogueGraphFactory : public UFactory, public FReimportHandler
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueGraphFactory();
+
+	// UFactory
+	virtual bool FactoryCanImport(const FString& Filename) override;
+	virtual UObject* FactoryCreateFile(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags,
+		const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled) override;
+
+	// FReimportHandler
+	virtual bool CanReimport(UObject* Obj, TArray<FString>& OutFilenames) override;
+	virtual void SetReimportPaths(UObject* Obj, const TArray<FString>& NewReimportPaths) override;
+	virtual EReimportResult::Type Reimport(UObject* Obj) override;
+	virtual int32 GetPriority() const override;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueReplayCommandlet.generated.h"
+
+/**
+ * Headless replay of recorded dialogue sessions (UDialogueManager::bRecordDialogues).
+ *
+ *   UnrealEditor-Cmd sp.uproject -run=DialogueReplay -nullrhi [-recording=<file or directory>] [-repeat=1]
+ *       [-ignorehash] [-out=Path.json]
+ *
+ * Feeds each recording's inputs through a UDialogueManager without a world or UI, as fast as possible,
+ * and checks the node, resolved line and state after every step against the recording. A directory
+ * (default Saved/DialogueRecordings) replays every .dlgrec in it, so kept recordings work as a
+ * regression corpus. -repeat runs the corpus several times to measure steps per second.
+ *
+ * Writes a JSON report (default Saved/DialogueReplay/replay.json). Exits with 1 if any recording
+ * diverged, or was made against a different version of its dialogue file (unless -ignorehash).
+ */
+UCLASS()
+class SPEDITOR_API UDialogueReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};